@@ -0,0 +1,105 @@
+/*
+ * Collection growth benchmark.
+ * Builds containers with 10 to 1M children by parsing, cloning and
+ * iterating, and reports the time spent per child. With the linear
+ * collection growth, the per-child figures must stay roughly flat.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "ncnf.h"
+#include "ncnf_int.h"
+
+static double
+now() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static char *
+make_config(int children) {
+	char *buf, *p;
+	int i;
+
+	buf = malloc(64 + children * 32);
+	if(buf == NULL)
+		return NULL;
+
+	p = buf + sprintf(buf, "entity \"bench\" {\n");
+	for(i = 0; i < children; i++)
+		p += sprintf(p, "\tattr-%d \"%d\";\n", i, i);
+	strcpy(p, "}\n");
+
+	return buf;
+}
+
+int
+main(int ac, char **av) {
+	int max_children = 1000000;
+	int children;
+
+	if(ac > 1)
+		max_children = atoi(av[1]);
+
+	printf("%10s %14s %14s %14s\n", "children",
+		"parse ns/ch", "clone ns/ch", "iter ns/ch");
+
+	for(children = 10; children <= max_children; children *= 10) {
+		struct ncnf_obj_s *root, *ent, *clone;
+		ncnf_obj *iter;
+		double t0, t_parse, t_clone, t_iter;
+		char *text;
+
+		text = make_config(children);
+		if(text == NULL) {
+			perror("malloc");
+			return 1;
+		}
+
+		t0 = now();
+		root = ncnf_Read(text, NCNF_ST_TEXT
+			| NCNF_FL_NODYN | NCNF_FL_NOEMB | NCNF_FL_RELNS);
+		t_parse = now() - t0;
+		free(text);
+		if(root == NULL) {
+			perror("ncnf_Read");
+			return 1;
+		}
+
+		ent = ncnf_get_obj(root, "entity", "bench", NCNF_FIRST_OBJECT);
+		if(ent == NULL) {
+			perror("ncnf_get_obj");
+			return 1;
+		}
+
+		t0 = now();
+		clone = _ncnf_obj_clone(NULL, ent);
+		t_clone = now() - t0;
+		if(clone == NULL) {
+			perror("_ncnf_obj_clone");
+			return 1;
+		}
+
+		t0 = now();
+		iter = ncnf_get_obj(ent, NULL, NULL, NCNF_ITER_ATTRIBUTES);
+		t_iter = now() - t0;
+		if(iter == NULL) {
+			perror("ncnf_get_obj");
+			return 1;
+		}
+
+		printf("%10d %14.1f %14.1f %14.1f\n", children,
+			t_parse * 1e9 / children,
+			t_clone * 1e9 / children,
+			t_iter * 1e9 / children);
+
+		ncnf_destroy(iter);
+		_ncnf_obj_destroy(clone);
+		ncnf_destroy(root);
+	}
+
+	return 0;
+}
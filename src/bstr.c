@@ -31,10 +31,17 @@
  * Windows "Basic String" type, bstr_t.
  */
 
+#ifdef	HAVE_CONFIG_H
+#include "config.h"
+#endif	/* HAVE_CONFIG_H */
+
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <assert.h>
+#ifdef	HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif	/* HAVE_LIBPTHREAD */
 #include "bstr.h"
 
 /*
@@ -46,6 +53,7 @@ typedef struct bstr_shadow_s {
 		struct {
 			int refs;	/* Reference counter */
 			int len;	/* String length (always positive) */
+			bstr_allocator_t *alloc; /* NULL for malloc(3)'ed */
 		} life;
 		struct {
 			bstr_t next;
@@ -54,6 +62,7 @@ typedef struct bstr_shadow_s {
 	} bstr_shadow_union;
 #define	b_refs	bstr_shadow_union.life.refs
 #define	b_len	bstr_shadow_union.life.len
+#define	b_alloc	bstr_shadow_union.life.alloc
 #define	b_next	bstr_shadow_union.death.next
 #define	b_chain	bstr_shadow_union.death.chain_size
 } bstr_shadow_t;
@@ -68,9 +77,15 @@ typedef struct bstr_shadow_s {
 #define	BSTR_FREE_STORAGE_SIZE	256
 #define	BSTR_MAX_CHAIN_SIZE	256
 
-static bstr_t _bstr_free_storage[BSTR_FREE_STORAGE_SIZE];
+/*
+ * The cache of freed strings is kept per thread,
+ * so the strings may be created and freed concurrently.
+ * It is flushed when the thread exits, see _bstr_cache_register().
+ */
+static __thread bstr_t _bstr_free_storage[BSTR_FREE_STORAGE_SIZE];
 static bstr_t _bstr_get(int len);
 static int mem_required(int strlen_ex_null);
+static void _bstr_cache_register(void);
 
 /*
  * calc the mem required of a bstr
@@ -106,12 +121,73 @@ str2bstr(const char *optStr, int optLen) {
 
 	SHADOW(bs)->b_refs = 1;
 	SHADOW(bs)->b_len = optLen;
+	SHADOW(bs)->b_alloc = NULL;
+	if(optStr) memcpy(bs, optStr, optLen);
+	bs[optLen] = '\0';
+
+	return bs;
+}
+
+/*
+ * Create a new basic string inside the memory obtained from
+ * the custom allocator.
+ */
+bstr_t
+str2bstr_a(bstr_allocator_t *alloc, const char *optStr, int optLen) {
+	char *mem;
+	bstr_t bs;
+
+	if(alloc == NULL)
+		return str2bstr(optStr, optLen);
+
+	if(!optStr && optLen < 0) {
+		errno = EINVAL;
+		return (bstr_t)0;
+	}
+
+	if(optLen < 0)
+		optLen = strlen(optStr);
+
+	mem = alloc->alloc(alloc, mem_required(optLen));
+	if(mem == NULL)
+		return NULL;
+
+	bs = (bstr_t)(mem + sizeof(bstr_shadow_t));
+	SHADOW(bs)->b_refs = 1;
+	SHADOW(bs)->b_len = optLen;
+	SHADOW(bs)->b_alloc = alloc;
 	if(optStr) memcpy(bs, optStr, optLen);
 	bs[optLen] = '\0';
 
 	return bs;
 }
 
+/*
+ * Create a new basic string around the existing memory.
+ */
+bstr_t
+bstr_place(bstr_allocator_t *alloc, void *mem, int len) {
+	bstr_t bs;
+
+	if(mem == NULL || alloc == NULL || len < 0) {
+		errno = EINVAL;
+		return (bstr_t)0;
+	}
+
+	bs = (bstr_t)((char *)mem + sizeof(bstr_shadow_t));
+	assert(bs[len] == '\0');
+	SHADOW(bs)->b_refs = 1;
+	SHADOW(bs)->b_len = len;
+	SHADOW(bs)->b_alloc = alloc;
+
+	return bs;
+}
+
+int
+bstr_header_size(void) {
+	return sizeof(bstr_shadow_t);
+}
+
 /*
  * Get a pointer to string, incrementing it's reference counter.
  */
@@ -174,6 +250,13 @@ bstr_free_impl(bstr_t bs, int clear_me) {
 		memset(bs, 0, SHADOW(bs)->b_len);
 
 	mem_size = mem_required(SHADOW(bs)->b_len);
+
+	if(SHADOW(bs)->b_alloc) {
+		/* Hand the memory back to where it came from */
+		SHADOW(bs)->b_alloc->release(SHADOW(bs)->b_alloc,
+			SHADOW(bs), mem_size);
+		return;
+	}
  	len = mem_size >> ROUND_BITS;
 
 	/*
@@ -195,6 +278,7 @@ bstr_free_impl(bstr_t bs, int clear_me) {
 		}
 		SHADOW(bs)->b_next = _bstr_free_storage[len];
 	} else {
+		_bstr_cache_register();
 		SHADOW(bs)->b_next = 0;
 		SHADOW(bs)->b_chain = 1;
 	}
@@ -219,6 +303,12 @@ bstr_len(bstr_t bs) {
 	return bs ? SHADOW(bs)->b_len : 0;
 }
 
+/* Get the custom allocator */
+bstr_allocator_t *
+bstr_allocator(bstr_t bs) {
+	return bs ? SHADOW(bs)->b_alloc : NULL;
+}
+
 /* Get the reference count */
 int
 bstr_refs(bstr_t bs) {
@@ -259,6 +349,43 @@ _bstr_get(int len) {
 	}
 }
 
+#ifdef	HAVE_LIBPTHREAD
+static pthread_key_t _bstr_cache_key;
+static pthread_once_t _bstr_cache_once = PTHREAD_ONCE_INIT;
+static int _bstr_cache_key_created;
+static __thread int _bstr_cache_registered;
+
+static void
+_bstr_cache_destructor(void *arg) {
+	(void)arg;
+	bstr_flush_cache();
+	_bstr_cache_registered = 0;
+}
+
+static void
+_bstr_cache_key_create(void) {
+	if(pthread_key_create(&_bstr_cache_key, _bstr_cache_destructor) == 0)
+		_bstr_cache_key_created = 1;
+}
+#endif	/* HAVE_LIBPTHREAD */
+
+/*
+ * Have the cache of the calling thread flushed when the thread exits,
+ * so the threads which come and go do not leak the cached strings.
+ */
+static void
+_bstr_cache_register(void) {
+#ifdef	HAVE_LIBPTHREAD
+	if(_bstr_cache_registered)
+		return;
+	_bstr_cache_registered = 1;
+
+	if(pthread_once(&_bstr_cache_once, _bstr_cache_key_create) == 0
+	&& _bstr_cache_key_created)
+		(void)pthread_setspecific(_bstr_cache_key, (void *)1);
+#endif	/* HAVE_LIBPTHREAD */
+}
+
 void
 bstr_flush_cache() {
 	bstr_t bs;
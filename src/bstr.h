@@ -59,6 +59,36 @@ typedef	char *	bstr_t;
  */
 bstr_t	str2bstr(const char *optStr, int optLen);
 
+/*
+ * Custom memory source for basic strings.
+ * The string memory is obtained through alloc() and, once the reference
+ * counter drops to zero, handed back through release() instead of free(3).
+ */
+typedef struct bstr_allocator_s {
+	void *(*alloc)(struct bstr_allocator_s *, int size);
+	void (*release)(struct bstr_allocator_s *, void *mem, int size);
+} bstr_allocator_t;
+
+/*
+ * Same as str2bstr(), but takes the memory from the given allocator.
+ * If allocator is NULL, the function is equivalent to str2bstr().
+ */
+bstr_t	str2bstr_a(bstr_allocator_t *, const char *optStr, int optLen);
+
+/*
+ * Turn the memory at (mem) into a basic string without copying.
+ * The string of (len) characters, followed by '\0', must already be
+ * located at (mem + bstr_header_size()). The memory is handed back
+ * through the allocator's release() once the string is freed.
+ * Initializes the reference counter to ONE.
+ */
+bstr_t	bstr_place(bstr_allocator_t *, void *mem, int len);
+
+/*
+ * Number of bytes bstr_place() needs in front of the string.
+ */
+int	bstr_header_size(void);
+
 /*
  * Increment reference counter of the given basic string and return
  * the pointer to it (return pointer == pointer provided).
@@ -98,7 +128,14 @@ int	bstr_len(bstr_t);
 int	bstr_refs(bstr_t);
 
 /*
- * Flush the cache of freed memory.
+ * Get the allocator the string was created with, or NULL
+ * if the string lives in malloc(3)'ed memory.
+ */
+bstr_allocator_t *bstr_allocator(bstr_t);
+
+/*
+ * Flush the cache of freed memory of the calling thread.
+ * The cache is also flushed when the thread exits.
  */
 void bstr_flush_cache(void);
 
@@ -0,0 +1,96 @@
+#undef	NDEBUG
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <assert.h>
+
+#include "ncnf.h"
+
+#define	NREADS	8
+
+static char *configs[] = { "ncnf_test.conf", "ncnf_test.conf2" };
+static int callbacks;
+
+static void
+read_done(ncnf_async *as, void *key) {
+	assert(ncnf_async_done(as) == 1);
+	assert(key == (void *)configs);
+	__atomic_add_fetch(&callbacks, 1, __ATOMIC_RELAXED);
+}
+
+int
+main(int ac, char **av) {
+	unsigned long long fingerprints[2];
+	struct pollfd pfd[NREADS];
+	ncnf_async *as[NREADS];
+	ncnf_obj *baseline;
+	ncnf_obj *root;
+	int pending;
+	int i;
+
+	if(ac > 1) configs[0] = av[1];
+	if(ac > 2) configs[1] = av[2];
+
+	for(i = 0; i < 2; i++) {
+		root = ncnf_read(configs[i]);
+		assert(root);
+		fingerprints[i] = ncnf_obj_fingerprint(root);
+		ncnf_destroy(root);
+	}
+
+	baseline = ncnf_read(configs[0]);
+	assert(baseline);
+
+	/* Several reads in flight at once */
+	for(i = 0; i < NREADS; i++) {
+		as[i] = ncnf_read_async(configs[i & 1], NCNF_ST_FILENAME,
+			(i & 2) ? baseline : NULL, read_done, configs);
+		if(as[i] == NULL && errno == ENOSYS) {
+			printf("Built without threads\n");
+			ncnf_destroy(baseline);
+			return 0;
+		}
+		assert(as[i]);
+		pfd[i].fd = ncnf_async_fd(as[i]);
+		pfd[i].events = POLLIN;
+		assert(pfd[i].fd != -1);
+	}
+
+	/* Meanwhile, the baseline may be read here */
+	assert(ncnf_obj_fingerprint(baseline) == fingerprints[0]);
+	assert(ncnf_get_obj(baseline, "service", "http", NCNF_FIRST_OBJECT));
+
+	for(pending = NREADS; pending;) {
+		assert(poll(pfd, NREADS, -1) > 0);
+		for(i = 0; i < NREADS; i++) {
+			if(pfd[i].fd == -1 || !(pfd[i].revents & POLLIN))
+				continue;
+			assert(ncnf_async_done(as[i]) == 1);
+			root = ncnf_async_finish(as[i]);
+			assert(root);
+			assert(ncnf_obj_fingerprint(root)
+				== fingerprints[i & 1]);
+			ncnf_destroy(root);
+			pfd[i].fd = -1;
+			pending--;
+		}
+	}
+	assert(callbacks == NREADS);
+
+	/* The errors are reported by ncnf_async_finish() */
+	as[0] = ncnf_read_async("nonexistent.conf", NCNF_ST_FILENAME,
+		NULL, NULL, NULL);
+	assert(as[0]);
+	assert(ncnf_async_finish(as[0]) == NULL);
+	assert(errno == ENOENT);
+
+	/* No external validation and no shared pools */
+	assert(ncnf_read_async(configs[0],
+		NCNF_ST_FILENAME | NCNF_FL_ASYNCVAL, NULL, NULL, NULL) == NULL);
+	assert(errno == EINVAL);
+
+	ncnf_destroy(baseline);
+
+	return 0;
+}
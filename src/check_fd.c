@@ -0,0 +1,94 @@
+#undef	NDEBUG
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <assert.h>
+#include <sys/wait.h>
+
+#include "ncnf.h"
+
+/*
+ * Feed the file into the pipe in small pieces.
+ */
+static void
+feed(const char *filename, int wfd) {
+	char buf[61];
+	ssize_t n;
+	int fd;
+
+	fd = open(filename, O_RDONLY);
+	if(fd == -1) _exit(1);
+
+	while((n = read(fd, buf, sizeof(buf))) > 0) {
+		if(write(wfd, buf, n) != n)
+			_exit(1);
+	}
+
+	_exit(n == 0 ? 0 : 1);
+}
+
+static void
+check_tree(ncnf_obj *root) {
+	char *value;
+
+	assert(root);
+	value = ncnf_get_attr(root, "simple");
+	assert(value && strcmp(value, "attribute") == 0);
+	ncnf_destroy(root);
+}
+
+int
+main(int ac, char **av) {
+	char *config = "ncnf_test.conf";
+	char fdstr[16];
+	int pfd[2];
+	pid_t pid;
+	int status;
+	int fd;
+
+	if(ac > 1) config = av[1];
+
+	/*
+	 * Pipe.
+	 */
+	assert(pipe(pfd) == 0);
+	pid = fork();
+	assert(pid != -1);
+	if(pid == 0) {
+		close(pfd[0]);
+		feed(config, pfd[1]);
+	}
+	close(pfd[1]);
+
+	snprintf(fdstr, sizeof(fdstr), "%d", pfd[0]);
+	check_tree(ncnf_Read(fdstr, NCNF_ST_FD));
+
+	assert(waitpid(pid, &status, 0) == pid);
+	assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+	/* The descriptor belongs to the caller */
+	assert(fcntl(pfd[0], F_GETFL) != -1);
+	close(pfd[0]);
+
+	/*
+	 * Regular file.
+	 */
+	fd = open(config, O_RDONLY);
+	assert(fd != -1);
+	snprintf(fdstr, sizeof(fdstr), "%d", fd);
+	check_tree(ncnf_Read(fdstr, NCNF_ST_FD));
+	close(fd);
+
+	/*
+	 * Bad arguments.
+	 */
+	errno = 0;
+	assert(ncnf_Read("x", NCNF_ST_FD) == NULL && errno == EINVAL);
+	errno = 0;
+	assert(ncnf_Read(fdstr, NCNF_ST_FD) == NULL && errno == EBADF);
+
+	return 0;
+}
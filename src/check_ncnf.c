@@ -308,6 +308,15 @@ main(int ac, char **av) {
 	ncnf_destroy(root);
 	ncnf_destroy(new_root);
 
+	/* Both configurations have been checked against the policies */
+	{
+		struct ncnf_policy_stats ps[1];
+		assert(ncnf_policy_stats(ps, 1) >= 1);
+		assert(ps[0].number == 1);
+		assert(ps[0].runs >= 2);
+		assert(ps[0].failures == 0);
+	}
+
 	return 0;
 }
 
@@ -0,0 +1,176 @@
+#undef	NDEBUG
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <errno.h>
+
+#include "ncnf.h"
+#include "ncnf_ql.h"
+
+#define	QA	"nloc \"*\" { _select-children \"one\"; }"
+#define	QB	"ploc \"a-ploc\" { box \"*\" { iface \"*\" {"	\
+		" ip-addr \"1.2.3.4\"; _select-children \"one\"; } } }"
+
+static ncnf_query_t *
+compile(const char *text) {
+	char errbuf[256];
+	size_t errlen = sizeof(errbuf);
+	ncnf_query_t *nq;
+	ncnf_obj *ncql;
+
+	ncql = ncnf_Read(text, NCNF_ST_TEXT | NCNF_FL_NOEMB | NCNF_FL_RELNS);
+	assert(ncql);
+	nq = ncnf_compile_query(ncql, errbuf, &errlen);
+	ncnf_destroy(ncql);
+	if(nq == NULL) {
+		printf("%s\n", errbuf);
+		assert(nq);
+	}
+
+	return nq;
+}
+
+static ncnf_qresult_t *
+copy(ncnf_qresult_t *res) {
+	ncnf_qresult_t *cp = ncnf_qresult_new();
+	assert(cp);
+	assert(ncnf_qresult_union(cp, res) == 0);
+	return cp;
+}
+
+int
+main(int ac, char **av) {
+	ncnf_obj *root;
+	ncnf_obj *nloc, *box, *iface;
+	ncnf_obj *iter, *obj;
+	ncnf_query_t *qa, *qb;
+	ncnf_query_set_t *qs;
+	ncnf_qresult_t *ra, *rb, *r;
+	ncnf_qresult_t *rs[3];
+	struct ncnf_query_stats stats;
+	int na, nb, ni;
+	int count;
+	int i;
+
+	printf("%s\n", av[0]);
+
+	root = ncnf_read("ncnf_test.conf");
+	assert(root);
+
+	nloc = ncnf_get_obj(root, "nloc", "a-nloc0", NCNF_FIRST_OBJECT);
+	box = ncnf_get_obj(root, "box", "localhost", NCNF_FIRST_OBJECT);
+	iface = ncnf_get_obj(root, "ploc", "a-ploc", NCNF_FIRST_OBJECT);
+	iface = ncnf_get_obj(iface, "box", "b1-a-ploc", NCNF_FIRST_OBJECT);
+	iface = ncnf_get_obj(iface, "iface", "eth0", NCNF_FIRST_OBJECT);
+	assert(nloc && box && iface);
+
+	qa = compile(QA);
+	qb = compile(QB);
+
+	ra = ncnf_qresult_new();
+	rb = ncnf_qresult_new();
+	assert(ra && rb);
+	assert(ncnf_qresult_count(ra) == 0);
+	assert(ncnf_qresult_iter(ra) == NULL && errno == ESRCH);
+
+	assert(ncnf_exec_query_ex(root, qa, ra, 0) == 0);
+	assert(ncnf_exec_query_ex(root, qb, rb, 0) == 0);
+	na = ncnf_qresult_count(ra);
+	nb = ncnf_qresult_count(rb);
+	printf("qa: %d, qb: %d\n", na, nb);
+	assert(na > 0 && nb > 0);
+
+	/* The paths to the root are there */
+	assert(ncnf_qresult_contains(ra, root) == 1);
+	assert(ncnf_qresult_contains(ra, nloc) == 1);
+	assert(ncnf_qresult_contains(ra, box) == 0);
+	assert(ncnf_qresult_contains(rb, root) == 1);
+	assert(ncnf_qresult_contains(rb, nloc) == 0);
+	assert(ncnf_qresult_contains(rb, iface) == 1);
+
+	/* Repeated execution does not add anything */
+	assert(ncnf_exec_query_ex(root, qa, ra, 0) == 0);
+	assert(ncnf_qresult_count(ra) == na);
+
+	/* Combinations */
+	r = copy(ra);
+	assert(ncnf_qresult_intersect(r, rb) == 0);
+	ni = ncnf_qresult_count(r);
+	assert(ni >= 1 && ni < na && ni < nb);
+	assert(ncnf_qresult_contains(r, root) == 1);
+	assert(ncnf_qresult_contains(r, nloc) == 0);
+	ncnf_qresult_free(r);
+
+	r = copy(ra);
+	assert(ncnf_qresult_subtract(r, rb) == 0);
+	assert(ncnf_qresult_count(r) == na - ni);
+	assert(ncnf_qresult_contains(r, root) == 0);
+	assert(ncnf_qresult_contains(r, nloc) == 1);
+	ncnf_qresult_free(r);
+
+	r = copy(ra);
+	assert(ncnf_qresult_union(r, rb) == 0);
+	assert(ncnf_qresult_count(r) == na + nb - ni);
+
+	iter = ncnf_qresult_iter(r);
+	assert(iter);
+	for(count = 0; (obj = ncnf_iter_next(iter)); count++)
+		assert(ncnf_qresult_contains(r, obj) == 1);
+	assert(count == na + nb - ni);
+	ncnf_destroy(iter);
+
+	ncnf_qresult_dump(stdout, root, r, NULL, 0, 4);
+
+	ncnf_qresult_clear(r);
+	assert(ncnf_qresult_count(r) == 0);
+	assert(ncnf_qresult_contains(r, root) == 0);
+	ncnf_qresult_free(r);
+
+	/* The marks are neither used nor touched */
+	ncnf_clear_query(root);
+	assert(ncnf_obj_marked(nloc) == 0);
+	assert(ncnf_exec_query(root, qa, 0) == 0);
+	assert(ncnf_obj_marked(nloc) == 1);
+	assert(ncnf_obj_marked(box) == 0);
+	ncnf_qresult_clear(ra);
+	assert(ncnf_exec_query_ex(root, qa, ra, 0) == 0);
+	assert(ncnf_qresult_count(ra) == na);
+	ncnf_clear_query(root);
+	assert(ncnf_obj_marked(nloc) == 0);
+
+	/* Same results from a single walk */
+	qs = ncnf_query_set_new();
+	assert(qs);
+	assert(ncnf_query_set_add(qs, compile(QA)) == 0);
+	assert(ncnf_query_set_add(qs, compile(QB)) == 1);
+	assert(ncnf_query_set_add(qs, compile(QA)) == 2);
+	for(i = 0; i < 3; i++) {
+		rs[i] = ncnf_qresult_new();
+		assert(rs[i]);
+	}
+	assert(ncnf_exec_query_set(root, qs, rs, 0) == 0);
+	assert(ncnf_qresult_count(rs[0]) == na);
+	assert(ncnf_qresult_count(rs[1]) == nb);
+	assert(ncnf_qresult_count(rs[2]) == na);
+	r = copy(rs[1]);
+	assert(ncnf_qresult_subtract(r, rb) == 0);
+	assert(ncnf_qresult_count(r) == 0);
+	ncnf_qresult_free(r);
+	r = copy(rs[0]);
+	assert(ncnf_qresult_intersect(r, ra) == 0);
+	assert(ncnf_qresult_count(r) == na);
+	ncnf_qresult_free(r);
+	ncnf_query_set_stats(qs, &stats);
+	assert(stats.visited > 0);
+	for(i = 0; i < 3; i++)
+		ncnf_qresult_free(rs[i]);
+	ncnf_query_set_free(qs);
+
+	ncnf_qresult_free(ra);
+	ncnf_qresult_free(rb);
+	ncnf_delete_query(qa);
+	ncnf_delete_query(qb);
+	ncnf_destroy(root);
+
+	return 0;
+}
@@ -1,14 +1,174 @@
 #undef	NDEBUG
 #include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include <assert.h>
 
 #include "ncnf.h"
 #include "ncnf_app.h"
+#include "ncnf_int.h"
+
+#define	RELOAD_CONF	"check_reload.conf"
+#define	RELOAD_VR	"check_reload.vr"
+#define	RELOAD_LOOPS	200
+
+/*
+ * Reload the tree back and forth through the staged diff.
+ */
+static void
+stage_reload(ncnf_obj *root, char **configs, int loops) {
+	int i;
+
+	for(i = 0; i < loops; i++) {
+		ncnf_obj *new_root = ncnf_read(configs[(i + 1) & 1]);
+		ncnf_diff_stage *st;
+
+		assert(new_root);
+		st = ncnf_diff_prepare(root, new_root);
+		assert(st);
+		ncnf_destroy(new_root);
+		assert(ncnf_diff_commit(st, NULL) == 0);
+	}
+}
+
+/*
+ * The entries hidden from the search are never matched, be the
+ * collection joined through the hash or searched entry by entry.
+ */
+static void
+hidden_entry_diff(int width) {
+	ncnf_obj *old_root, *new_root;
+	ncnf_changeset *cs;
+	char text[1024];
+	char *p = text;
+	int i;
+
+	for(i = 0; i < width; i++)
+		p += sprintf(p, "a%d \"%d\";\n", i, i);
+	old_root = ncnf_Read(text, NCNF_ST_TEXT);
+	assert(old_root);
+	sprintf(p, "extra \"x\";\n");
+	new_root = ncnf_Read(text, NCNF_ST_TEXT);
+	assert(new_root);
+
+	new_root->m_collection[COLLECTION_ATTRIBUTES]
+		.entry[0].ignore_in_search = 1;
+	assert(ncnf_diff_ex(old_root, new_root, &cs) == 0);
+	/* The old entry is deleted and the hidden one added in its place */
+	assert(cs->modified == 1);
+	assert(cs->deleted == 0);
+	assert(cs->added == 1);
+	ncnf_changeset_free(cs);
+
+	ncnf_destroy(new_root);
+	ncnf_destroy(old_root);
+}
+
+static void
+write_file(const char *filename, const char *contents) {
+	FILE *fp = fopen(filename, "w");
+	assert(fp);
+	assert(fputs(contents, fp) >= 0);
+	assert(fclose(fp) == 0);
+}
+
+static void
+write_servers(const char *filename, const char *port) {
+	char text[256];
+	snprintf(text, sizeof(text),
+		"_validator-rules \"" RELOAD_VR "\";\n"
+		"server \"s1\" { port \"80\"; }\n"
+		"server \"s2\" { port \"%s\"; }\n", port);
+	write_file(filename, text);
+}
+
+/* Whether the port of the server was checked by the validator */
+static int
+port_validated(ncnf_obj *root, const char *server) {
+	ncnf_obj *obj = ncnf_get_obj(root, "server", server,
+		NCNF_FIRST_OBJECT);
+	assert(obj);
+	obj = ncnf_get_obj(obj, "port", NULL, NCNF_FIRST_ATTRIBUTE);
+	assert(obj);
+	return obj->mark != 0;
+}
+
+/*
+ * Only the changed subtrees are validated against the baseline,
+ * and the baseline is only trusted with the very same rules file.
+ */
+static void
+baseline_checks() {
+	const char *dirs[] = { "check_reload.a", "check_reload.b" };
+	ncnf_obj *base, *root;
+	char conf[2][64];
+	char vr[2][64];
+	int i;
+
+	write_file(RELOAD_VR,
+		"entity ROOT\n"
+		"\toptional single attribute _validator-rules\n"
+		"\toptional multiple entity server\n"
+		"entity server\n"
+		"\tmandatory single attribute port range 1:65535\n");
+
+	write_servers(RELOAD_CONF, "81");
+	base = ncnf_read(RELOAD_CONF);
+	assert(base);
+	assert(port_validated(base, "s1"));
+
+	write_servers(RELOAD_CONF, "82");
+	root = ncnf_Read(RELOAD_CONF, NCNF_ST_FILENAME | NCNF_FL_BASELINE, base);
+	assert(root);
+	assert(!port_validated(root, "s1"));
+	assert(port_validated(root, "s2"));
+	ncnf_destroy(root);
+
+	write_servers(RELOAD_CONF, "99999");
+	assert(ncnf_Read(RELOAD_CONF,
+		NCNF_ST_FILENAME | NCNF_FL_BASELINE, base) == NULL);
+	ncnf_destroy(base);
+
+	/* Same configuration, same rules file name, different rules */
+	for(i = 0; i < 2; i++) {
+		snprintf(conf[i], sizeof(conf[i]), "%s/" RELOAD_CONF, dirs[i]);
+		snprintf(vr[i], sizeof(vr[i]), "%s/" RELOAD_VR, dirs[i]);
+		assert(mkdir(dirs[i], 0755) == 0);
+		write_servers(conf[i], "81");
+		write_file(vr[i],
+			"entity ROOT\n"
+			"\toptional single attribute _validator-rules\n"
+			"\toptional multiple entity server\n"
+			"entity server\n");
+	}
+	write_file(vr[1],
+		"entity ROOT\n"
+		"\toptional single attribute _validator-rules\n"
+		"\toptional multiple entity server\n"
+		"entity server\n"
+		"\tmandatory single attribute port range 1:10\n");
+
+	base = ncnf_read(conf[0]);
+	assert(base);
+	assert(ncnf_Read(conf[1],
+		NCNF_ST_FILENAME | NCNF_FL_BASELINE, base) == NULL);
+	ncnf_destroy(base);
+
+	for(i = 0; i < 2; i++) {
+		unlink(conf[i]);
+		unlink(vr[i]);
+		rmdir(dirs[i]);
+	}
+	unlink(RELOAD_CONF);
+	unlink(RELOAD_VR);
+}
 
 int
 main(int ac, char **av) {
 	ncnf_obj *root;
 	ncnf_obj *new_root;
+	ncnf_changeset *cs;
+	int modified = -1;
 	char *configs[] = { "ncnf_test.conf", "ncnf_test.conf2" };
 	int i;
 
@@ -21,6 +181,16 @@ main(int ac, char **av) {
 		return 1;
 	}
 
+	/* Fingerprints only depend on the configuration contents */
+	new_root = ncnf_read(configs[0]);
+	assert(new_root);
+	assert(ncnf_obj_fingerprint(root) == ncnf_obj_fingerprint(new_root));
+	ncnf_destroy(new_root);
+	new_root = ncnf_read(configs[1]);
+	assert(new_root);
+	assert(ncnf_obj_fingerprint(root) != ncnf_obj_fingerprint(new_root));
+	ncnf_destroy(new_root);
+
 	for(i = 0; i < 10; i++) {
 
 		new_root = ncnf_read(configs[(i + 1) & 1]);
@@ -29,15 +199,88 @@ main(int ac, char **av) {
 			return 1;
 		}
 	
-		if(ncnf_diff(root, new_root)) {
+		if(ncnf_diff_ex(root, new_root, &cs)) {
 			perror("Failure to diff two configuration trees");
 			return 1;
 		}
 
+		/* Both directions pair the same attributes and references */
+		assert(cs->count);
+		assert(cs->count == cs->added + cs->modified + cs->deleted);
+		assert(cs->change[0].kind == NCNF_CHANGE_DELETE);
+		assert(cs->change[cs->count - 1].kind != NCNF_CHANGE_DELETE);
+		assert(modified == -1 || modified == cs->modified);
+		modified = cs->modified;
+		ncnf_changeset_free(cs);
+
+		/* The old tree must now look exactly like the new one */
+		assert(ncnf_obj_fingerprint(root));
+		assert(ncnf_obj_fingerprint(root)
+			== ncnf_obj_fingerprint(new_root));
+
 		ncnf_destroy(new_root);
 	}
 
+	/* The replaced objects' memory is reused by the staged reloads */
+	{
+		size_t size;
+
+		stage_reload(root, configs, 4);
+		size = _ncnf_mr_size(root->mr);
+		assert(size);
+		stage_reload(root, configs, RELOAD_LOOPS);
+		assert(_ncnf_mr_size(root->mr) == size);
+	}
+
+	/* Narrow collections are searched, the wide ones are joined */
+	hidden_entry_diff(2);
+	hidden_entry_diff(32);
+
+	/* Nothing has changed since the last diff */
+	new_root = ncnf_read(configs[0]);
+	assert(new_root);
+	assert(ncnf_diff_ex(root, new_root, &cs) == 0);
+	assert(cs->count == 0);
+	ncnf_changeset_free(cs);
+	ncnf_destroy(new_root);
+
+	/* Validation against the baseline yields the same trees */
+	for(i = 0; i < 2; i++) {
+		ncnf_obj *full = ncnf_read(configs[i]);
+		assert(full);
+		new_root = ncnf_Read(configs[i],
+			NCNF_ST_FILENAME | NCNF_FL_BASELINE, root);
+		assert(new_root);
+		assert(ncnf_obj_fingerprint(new_root)
+			== ncnf_obj_fingerprint(full));
+		ncnf_destroy(new_root);
+		ncnf_destroy(full);
+	}
+
 	ncnf_destroy(root);
 
+	/* The cached rules are dropped once the file changes */
+	write_file(RELOAD_CONF,
+		"_validator-rules \"" RELOAD_VR "\";\n"
+		"port \"80\";\n");
+	write_file(RELOAD_VR,
+		"entity ROOT\n"
+		"\toptional single attribute _validator-rules\n"
+		"\tmandatory single attribute port range 1:65535\n");
+	for(i = 0; i < 2; i++) {
+		root = ncnf_read(RELOAD_CONF);
+		assert(root);
+		ncnf_destroy(root);
+	}
+	write_file(RELOAD_VR,
+		"entity ROOT\n"
+		"\toptional single attribute _validator-rules\n"
+		"\tmandatory single attribute port range 1:10\n");
+	assert(ncnf_read(RELOAD_CONF) == NULL);
+	unlink(RELOAD_CONF);
+	unlink(RELOAD_VR);
+
+	baseline_checks();
+
 	return 0;
 }
@@ -0,0 +1,67 @@
+#undef	NDEBUG
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <assert.h>
+
+#include "ncnf.h"
+
+#define	SNAPSHOT	"check_snap.ncnfc"
+
+int
+main(int ac, char **av) {
+	char *configs[] = { "ncnf_test.conf", "ncnf_test.conf2" };
+	int modes[] = { 0, NCNF_FL_NOREGION, NCNF_FL_HEAPSTR };
+	ncnf_obj *root;
+	ncnf_obj *snap;
+	ncnf_obj *other;
+	FILE *fp;
+	int i;
+
+	if(ac > 1) configs[0] = av[1];
+	if(ac > 2) configs[1] = av[2];
+
+	for(i = 0; i < sizeof(modes)/sizeof(modes[0]); i++) {
+		root = ncnf_Read(configs[0], NCNF_ST_FILENAME | modes[i]);
+		assert(root);
+		assert(ncnf_snapshot(root, SNAPSHOT) == 0);
+
+		snap = ncnf_Read(SNAPSHOT, NCNF_ST_SNAPSHOT | modes[i]);
+		assert(snap);
+		assert(strcmp(ncnf_get_attr(snap, "simple"), "attribute") == 0);
+
+		/* Trees of different origin are freely mixed */
+		assert(ncnf_diff(snap, root) == 0);
+		ncnf_destroy(root);
+
+		other = ncnf_Read(configs[1], NCNF_ST_FILENAME | modes[i]);
+		assert(other);
+		assert(ncnf_diff(snap, other) == 0);
+		ncnf_destroy(other);
+
+		ncnf_destroy(snap);
+	}
+
+	/*
+	 * Not a snapshot.
+	 */
+	errno = 0;
+	assert(ncnf_Read(configs[0], NCNF_ST_SNAPSHOT) == NULL);
+	assert(errno == EINVAL);
+
+	/*
+	 * Truncated snapshot.
+	 */
+	fp = fopen(SNAPSHOT, "r+");
+	assert(fp);
+	assert(ftruncate(fileno(fp), 100) == 0);
+	fclose(fp);
+	errno = 0;
+	assert(ncnf_Read(SNAPSHOT, NCNF_ST_SNAPSHOT) == NULL);
+	assert(errno == EINVAL);
+
+	unlink(SNAPSHOT);
+
+	return 0;
+}
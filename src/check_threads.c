@@ -0,0 +1,215 @@
+#undef	NDEBUG
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "ncnf.h"
+
+#define	NTHREADS	8
+#define	NREADS		50
+
+static char *configs[] = { "ncnf_test.conf", "ncnf_test.conf2" };
+
+static void *
+reader(void *arg) {
+	int n = (int)(long)arg;
+	int i;
+
+	for(i = 0; i < NREADS; i++) {
+		ncnf_obj *root;
+
+		root = ncnf_Read(configs[(n + i) & 1], NCNF_ST_FILENAME);
+		if(root == NULL) {
+			perror("Failed to read configuration file");
+			return (void *)1;
+		}
+
+		ncnf_destroy(root);
+	}
+
+	return NULL;
+}
+
+static ncnf_obj *old_root;
+static ncnf_obj *ref_root;
+
+static void *
+preparer(void *arg) {
+	(void)arg;
+	return ncnf_diff_prepare(old_root, ref_root);
+}
+
+/*
+ * Prepare the diff in the background while reading the old tree.
+ */
+static void
+background_diff() {
+	unsigned long long fp;
+	ncnf_diff_stage *st;
+	ncnf_changeset *cs;
+	pthread_t th;
+	int ret;
+	int i;
+
+	old_root = ncnf_read(configs[0]);
+	ref_root = ncnf_read(configs[1]);
+	assert(old_root && ref_root);
+	fp = ncnf_obj_fingerprint(old_root);
+
+	ret = pthread_create(&th, NULL, preparer, NULL);
+	assert(ret == 0);
+	for(i = 0; i < NREADS; i++) {
+		ncnf_obj *obj = ncnf_get_obj(old_root, "service", "http",
+			NCNF_FIRST_OBJECT);
+		assert(obj && ncnf_get_attr(obj, "port"));
+	}
+	pthread_join(th, (void **)&st);
+	assert(st);
+
+	/* The old tree is not touched until the commit */
+	assert(ncnf_obj_fingerprint(old_root) == fp);
+	ncnf_destroy(ref_root);
+
+	assert(ncnf_diff_commit(st, &cs) == 0);
+	assert(cs->count);
+	ncnf_changeset_free(cs);
+
+	ref_root = ncnf_read(configs[1]);
+	assert(ref_root);
+	assert(ncnf_obj_fingerprint(old_root)
+		== ncnf_obj_fingerprint(ref_root));
+
+	/* Discarded stage leaves the tree alone */
+	st = ncnf_diff_prepare(old_root, ref_root);
+	assert(st);
+	ncnf_diff_abort(st);
+	ncnf_destroy(ref_root);
+
+	/* Stale stage is refused */
+	ref_root = ncnf_read(configs[0]);
+	assert(ref_root);
+	st = ncnf_diff_prepare(old_root, ref_root);
+	assert(st);
+	assert(ncnf_diff(old_root, ref_root) == 0);
+	assert(ncnf_diff_commit(st, NULL) == -1);
+	assert(ncnf_obj_fingerprint(old_root) == fp);
+
+	ncnf_destroy(ref_root);
+	ncnf_destroy(old_root);
+}
+
+static ncnf_obj *shared_root;
+
+static void *
+looker(void *arg) {
+	char name[16];
+	int i;
+
+	(void)arg;
+
+	for(i = 0; i < NREADS * 10; i++) {
+		ncnf_obj *obj;
+		snprintf(name, sizeof(name), "n%d", i % 64);
+		obj = ncnf_get_obj(shared_root, "wide", name,
+			NCNF_FIRST_OBJECT);
+		if(obj == NULL || ncnf_get_attr(obj, "port") == NULL)
+			return (void *)1;
+	}
+
+	return NULL;
+}
+
+/*
+ * Chain the attributes of the objects no other thread chains.
+ */
+static void *
+chainer(void *arg) {
+	char name[16];
+	int i;
+
+	for(i = 0; i < NREADS * 10; i++) {
+		ncnf_obj *obj, *chain;
+		int ports = 0;
+
+		snprintf(name, sizeof(name), "n%d",
+			(int)(long)arg + NTHREADS * (i % (64 / NTHREADS)));
+		obj = ncnf_get_obj(shared_root, "wide", name,
+			NCNF_FIRST_OBJECT);
+		if(obj == NULL)
+			return (void *)1;
+		chain = ncnf_get_obj(obj, "port", NULL,
+			NCNF_CHAIN_ATTRIBUTES);
+		while(ncnf_iter_next(chain))
+			ports++;
+		if(ports != 2)
+			return (void *)1;
+	}
+
+	return NULL;
+}
+
+/*
+ * Look up the wide collections of the same tree from several threads:
+ * the lookups must not modify the tree, and the chain lookups must
+ * only touch the objects they chain.
+ */
+static int
+shared_lookups() {
+	pthread_t th[NTHREADS];
+	char text[64 * 64];
+	char *p = text;
+	int failed = 0;
+	int i;
+
+	for(i = 0; i < 64; i++)
+		p += sprintf(p, "wide \"n%d\" { port \"%d\"; port \"%d\"; }\n",
+			i, i, 1000 + i);
+	shared_root = ncnf_Read(text, NCNF_ST_TEXT);
+	assert(shared_root);
+
+	for(i = 0; i < NTHREADS; i++) {
+		int ret = pthread_create(&th[i], NULL,
+			(i & 1) ? chainer : looker, (void *)(long)(i / 2));
+		assert(ret == 0);
+	}
+
+	for(i = 0; i < NTHREADS; i++) {
+		void *ret;
+		pthread_join(th[i], &ret);
+		if(ret) failed++;
+	}
+
+	ncnf_destroy(shared_root);
+
+	return failed;
+}
+
+int
+main(int ac, char **av) {
+	pthread_t th[NTHREADS];
+	int failed = 0;
+	int i;
+
+	if(ac > 1) configs[0] = av[1];
+	if(ac > 2) configs[1] = av[2];
+
+	for(i = 0; i < NTHREADS; i++) {
+		int ret = pthread_create(&th[i], NULL, reader, (void *)(long)i);
+		assert(ret == 0);
+	}
+
+	for(i = 0; i < NTHREADS; i++) {
+		void *ret;
+		pthread_join(th[i], &ret);
+		if(ret) failed++;
+	}
+
+	if(!failed)
+		failed = shared_lookups();
+
+	if(!failed)
+		background_diff();
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,76 @@
+#undef	NDEBUG
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+
+#include "ncnf.h"
+
+#define	READ_POOLED(file, pool)	\
+	ncnf_Read(file, NCNF_ST_FILENAME | NCNF_FL_TOKPOOL, pool)
+
+int
+main(int ac, char **av) {
+	char *configs[] = { "ncnf_test.conf", "ncnf_test.conf2" };
+	struct ncnf_token_pool_stats st1, st2;
+	ncnf_token_pool *pool;
+	ncnf_obj *root1;
+	ncnf_obj *root2;
+
+	if(ac > 1) configs[0] = av[1];
+	if(ac > 2) configs[1] = av[2];
+
+	/*
+	 * Shared across reads.
+	 */
+	pool = ncnf_token_pool_new(0);
+	assert(pool);
+
+	root1 = READ_POOLED(configs[0], pool);
+	assert(root1);
+	ncnf_token_pool_stats(pool, &st1);
+	assert(st1.misses > 0 && st1.hits > 0);
+	assert(st1.entries == st1.misses && st1.bytes > 0);
+
+	/* Nothing new is seen the second time */
+	root2 = READ_POOLED(configs[0], pool);
+	assert(root2);
+	ncnf_token_pool_stats(pool, &st2);
+	assert(st2.misses == st1.misses && st2.hits > st1.hits);
+	assert(ncnf_get_attr(root1, "simple") == ncnf_get_attr(root2, "simple"));
+
+	assert(ncnf_diff(root1, root2) == 0);
+	ncnf_destroy(root2);
+	ncnf_destroy(root1);
+
+	/* Nobody but the pool refers to the tokens anymore */
+	assert(ncnf_token_pool_evict(pool) == st2.entries);
+	ncnf_token_pool_stats(pool, &st2);
+	assert(st2.entries == 0 && st2.bytes == 0);
+	assert(st2.evictions == st1.entries);
+	ncnf_token_pool_destroy(pool);
+
+	/*
+	 * Bounded: reload drops the tokens of the destroyed tree.
+	 */
+	pool = ncnf_token_pool_new(1);
+	assert(pool);
+	root1 = READ_POOLED(configs[0], pool);
+	assert(root1);
+	assert(strcmp(ncnf_get_attr(root1, "simple"), "attribute") == 0);
+	ncnf_token_pool_stats(pool, &st1);
+	ncnf_destroy(root1);
+
+	root2 = READ_POOLED(configs[1], pool);
+	assert(root2);
+	ncnf_token_pool_stats(pool, &st2);
+	assert(st2.evictions > st1.evictions);
+	assert(strcmp(ncnf_get_attr(root2, "simple"), "attribute") == 0);
+	ncnf_destroy(root2);
+	ncnf_token_pool_destroy(pool);
+
+	errno = 0;
+	assert(READ_POOLED(configs[0], NULL) == NULL && errno == EINVAL);
+
+	return 0;
+}
@@ -0,0 +1,114 @@
+#undef	NDEBUG
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "ncnf.h"
+
+#define	NTHREADS	4
+#define	NPUBLISH	20
+
+static char *configs[] = { "ncnf_test.conf", "ncnf_test.conf2" };
+static unsigned long long fingerprints[2];
+static ncnf_vroot *vr;
+static int done;
+
+static void *
+reader(void *arg) {
+	int pins = 0;
+	int r;
+
+	(void)arg;
+
+	r = ncnf_vroot_reader(vr);
+	assert(r != -1);
+
+	while(!__atomic_load_n(&done, __ATOMIC_ACQUIRE) || pins == 0) {
+		unsigned long long fp;
+		ncnf_obj *root;
+		ncnf_obj *obj;
+
+		root = ncnf_vroot_pin(vr, r);
+		if(root == NULL) {
+			ncnf_vroot_unpin(vr, r);
+			continue;
+		}
+
+		/* Every version is seen whole */
+		fp = ncnf_obj_fingerprint(root);
+		assert(fp == fingerprints[0] || fp == fingerprints[1]);
+		obj = ncnf_get_obj(root, "service", "http",
+			NCNF_FIRST_OBJECT);
+		assert(obj);
+		assert(ncnf_get_attr(obj, "port"));
+
+		ncnf_vroot_unpin(vr, r);
+		pins++;
+	}
+
+	ncnf_vroot_reader_done(vr, r);
+
+	return NULL;
+}
+
+int
+main(int ac, char **av) {
+	pthread_t th[NTHREADS];
+	ncnf_changeset *cs;
+	ncnf_obj *root;
+	int i;
+
+	if(ac > 1) configs[0] = av[1];
+	if(ac > 2) configs[1] = av[2];
+
+	for(i = 0; i < 2; i++) {
+		root = ncnf_read(configs[i]);
+		assert(root);
+		fingerprints[i] = ncnf_obj_fingerprint(root);
+		ncnf_destroy(root);
+	}
+
+	vr = ncnf_vroot_new(NTHREADS);
+	assert(vr);
+
+	for(i = 0; i < NTHREADS; i++) {
+		int ret = pthread_create(&th[i], NULL, reader, NULL);
+		assert(ret == 0);
+	}
+
+	for(i = 0; i < NPUBLISH; i++) {
+		root = ncnf_read(configs[i & 1]);
+		assert(root);
+
+		assert(ncnf_vroot_publish(vr, root, &cs) == 0);
+		if(i == 0) {
+			/* Everything is new */
+			assert(cs->count && cs->count == cs->added);
+		} else {
+			assert(cs->count);
+			assert(cs->count
+				== cs->added + cs->modified + cs->deleted);
+			assert(cs->change[0].kind == NCNF_CHANGE_DELETE);
+		}
+		ncnf_changeset_free(cs);
+	}
+
+	/* Same configuration again */
+	root = ncnf_read(configs[(NPUBLISH - 1) & 1]);
+	assert(root);
+	assert(ncnf_vroot_publish(vr, root, &cs) == 0);
+	assert(cs->count == 0);
+	ncnf_changeset_free(cs);
+
+	__atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+	for(i = 0; i < NTHREADS; i++)
+		pthread_join(th[i], NULL);
+
+	/* Nobody holds the replaced versions anymore */
+	assert(ncnf_vroot_reclaim(vr) == 0);
+
+	ncnf_vroot_destroy(vr);
+
+	return 0;
+}
@@ -11,18 +11,25 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/types.h>
+#include <stdint.h>
+#include <stddef.h>
 #include <sys/time.h>
+#include <time.h>
 #include <sys/resource.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/wait.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <sysexits.h>
 #include <unistd.h>
 #include <stdarg.h>
 #include <string.h>
+#include <ctype.h>
 #include <signal.h>
+#include <limits.h>
+#include <poll.h>
 #include <fcntl.h>
 #include <pwd.h>
 #include <grp.h>
@@ -29,26 +29,24 @@
 
 #include "ncnf.h"
 #include "ncnf_app.h"
-
-#undef	SUPPORT_NCQL
-#ifdef	HAVE_LIBSTRFUNC
-#define	SUPPORT_NCQL
-#endif	/* HAVE_LIBSTRFUNC */
-
-#ifdef	SUPPORT_NCQL
-/*
- * NCQL is only supported when libstrfunc was around when building NCNF.
- */
 #include "ncnf_ql.h"
-#endif	/* SUPPORT_NCQL */
 
 void usage(const char *);
+static ncnf_query_set_t *compile_queries(ncnf_sf_svect *query_files,
+	int explain);
+static const char *query_output_name(const char *qfile, int *len);
+static int check_query_outputs(ncnf_sf_svect *query_files);
+static int save_query_results(const char *dir, ncnf_sf_svect *query_files,
+	ncnf_qresult_t **results, ncnf_obj *start_obj,
+	const char *flatten_type, int verbose, int indent);
 
 int
 main(int ac, char **av) {
 	ncnf_obj *root = NULL;
 	ncnf_obj *start_obj;
 	char *start_path = NULL;/* -S controls that */
+	char *snapshot_file = 0;/* -c controls that */
+	int snapshot_input = 0;	/* -b enables that */
 	int validate = 1;	/* -V disables that */
 	int verbose = 0;	/* -v enables that */
 	int indent = 4;		/* -i controls that */
@@ -57,16 +55,38 @@ main(int ac, char **av) {
 	int reload_times = 0;	/* -r controls that */
 	int silent = 0;		/* -s enables that */
 	char *flatten_type = 0;	/* -t controls that */
+	int policy_stats = 0;	/* -T enables that */
+	int explain_queries = 0;	/* -E enables that */
 	ncnf_sf_svect *query_files = 0;	/* -Q controls that */
+	char *query_output_dir = 0;	/* -O controls that */
+	ncnf_query_set_t *query_set = 0;
+	ncnf_qresult_t **query_results = 0;
+	ncnf_qresult_t *query_result = 0;
 	int rld;
 	int ch;
 
-	while((ch = getopt(ac, av,
-#ifdef	SUPPORT_NCQL
-		"Q:"
-#endif	/* SUPPORT_NCQL */
-		"P:S:i:mo:pr:st:Vv")) != -1)
+	while((ch = getopt(ac, av, "EO:P:Q:S:Tbc:i:mo:pr:st:Vv")) != -1)
 	switch(ch) {
+	case 'b':
+		snapshot_input = 1;
+		break;
+	case 'c':
+		if(snapshot_file) {
+			fprintf(stderr, "-c used twice\n");
+			usage(av[0]);
+		}
+		snapshot_file = optarg;
+		break;
+	case 'E':
+		explain_queries = 1;
+		break;
+	case 'O':
+		if(query_output_dir) {
+			fprintf(stderr, "-O used twice\n");
+			usage(av[0]);
+		}
+		query_output_dir = optarg;
+		break;
 	case 'Q':
 		if(!query_files) query_files = ncnf_sf_sinit();
 		ncnf_sf_sadd(query_files, optarg);
@@ -104,6 +124,9 @@ main(int ac, char **av) {
 	case 's':
 		silent = 1;
 		break;
+	case 'T':
+		policy_stats = 1;
+		break;
 	case 't':
 		flatten_type = optarg;
 		/* Fall through */
@@ -125,6 +148,14 @@ main(int ac, char **av) {
 		usage(av[-optind]);
 	}
 
+	if(query_output_dir && !query_files) {
+		fprintf(stderr, "-O requires -Q\n");
+		usage(av[-optind]);
+	}
+
+	if(query_output_dir && check_query_outputs(query_files))
+		usage(av[-optind]);
+
 	if(ac <= 0 || ac > (reload_times + 1)) {
 		if(ac > 0)
 			fprintf(stderr,
@@ -133,9 +164,31 @@ main(int ac, char **av) {
 		usage(av[-optind]);
 	}
 
+	/*
+	 * All the -Q queries are evaluated together, in a single walk.
+	 */
+	if(query_files) {
+		int i;
+		query_set = compile_queries(query_files, explain_queries);
+		if(!query_set)
+			return 1;
+		query_results = calloc(query_files->count,
+			sizeof(query_results[0]));
+		query_result = ncnf_qresult_new();
+		for(i = 0; query_results && i < query_files->count; i++) {
+			query_results[i] = ncnf_qresult_new();
+			if(!query_results[i]) break;
+		}
+		if(!query_result || !query_results || i < query_files->count) {
+			perror("-Q");
+			return 1;
+		}
+	}
+
 	for(rld = 0; rld <= reload_times; rld++) {
 		/* Read the ncnf file, optionally disabling validation */
-		ncnf_obj *new_root = ncnf_Read(av[rld % ac], NCNF_ST_FILENAME
+		ncnf_obj *new_root = ncnf_Read(av[rld % ac],
+			(snapshot_input ? NCNF_ST_SNAPSHOT : NCNF_ST_FILENAME)
 			| (validate ? 0 : (NCNF_FL_NODYN | NCNF_FL_NOEMB)));
 		if(new_root == NULL) {
 			perror("Failed to read configuration file");
@@ -155,44 +208,30 @@ main(int ac, char **av) {
 			root = new_root;
 		}
 
-#ifdef	SUPPORT_NCQL
 		/* -Q in operation */
-		if(query_files) {
+		if(query_set) {
 			int i;
-			ncnf_clear_query(root ? root : new_root);
-			for(i = 0; i < query_files->count; i++) {
-				char errbuf[256];
-				size_t errlen = sizeof(errbuf);
-				ncnf_query_t *nq;
-
-				ncnf_obj *ncql = ncnf_Read(
-					query_files->list[i],
-					NCNF_ST_FILENAME
-					/* Never use embedded validation */
-					| NCNF_FL_NOEMB
-					/* Relaxed namespace rules */
-					| NCNF_FL_RELNS);
-				if(!ncql) {
-					fprintf(stderr,
-					"-Q %s: Failed to read file: %s\n",
-						query_files->list[i],
-						strerror(errno));
-					return 1;
-				}
-
-				nq = ncnf_compile_query(ncql, errbuf, &errlen);
-				ncnf_destroy(ncql);
-				if(!nq) {
-					fprintf(stderr, "-Q %s: %s\n",
-						query_files->list[i],
-						errbuf);
-					return 1;
-				}
-				ncnf_exec_query(root ? root : new_root, nq, 0);
-				ncnf_delete_query(nq);
+			for(i = 0; i < query_files->count; i++)
+				ncnf_qresult_clear(query_results[i]);
+			if(ncnf_exec_query_set(root ? root : new_root,
+					query_set, query_results, 0)) {
+				fprintf(stderr, "-Q: %s\n", strerror(errno));
+				return 1;
+			}
+			if(explain_queries) {
+				struct ncnf_query_stats qs;
+				ncnf_query_set_stats(query_set, &qs);
+				fprintf(stderr, "-Q: %d quer%s: %lu visited, "
+					"%lu lookups, "
+					"%lu regex evaluations, "
+					"%lu cached\n",
+					(int)query_files->count,
+					query_files->count == 1 ? "y" : "ies",
+					qs.visited, qs.lookups,
+					qs.regex_evals,
+					qs.regex_cached);
 			}
 		}
-#endif	/* SUPPORT_NCQL */
 
 		if(profile_mode) {
 			int sleep_time = 10;
@@ -230,6 +269,23 @@ main(int ac, char **av) {
 		start_obj = root;
 	}
 
+	/*
+	 * Compile the resolved and validated tree.
+	 */
+	if(snapshot_file && ncnf_snapshot(root, snapshot_file)) {
+		fprintf(stderr, "Cannot save %s: %s\n",
+			snapshot_file, strerror(errno));
+		exit(EX_CANTCREAT);
+	}
+
+	/*
+	 * Save the results of every query in its own file.
+	 */
+	if(query_output_dir && save_query_results(query_output_dir,
+			query_files, query_results, start_obj,
+			flatten_type, verbose, indent))
+		exit(EX_CANTCREAT);
+
 	/*
 	 * Print config nicely.
 	 */
@@ -243,12 +299,47 @@ main(int ac, char **av) {
 				exit(EX_OSERR);
 			}
 		}
-		ncnf_dump(ofile, start_obj, flatten_type,
-			query_files ? 1 : 0, verbose, indent);
+		if(query_result) {
+			int i;
+			for(i = 0; i < query_files->count; i++) {
+				if(ncnf_qresult_union(query_result,
+						query_results[i])) {
+					perror("-Q");
+					exit(EX_OSERR);
+				}
+			}
+			ncnf_qresult_dump(ofile, start_obj, query_result,
+				flatten_type, verbose, indent);
+		} else {
+			ncnf_dump(ofile, start_obj, flatten_type,
+				0, verbose, indent);
+		}
 	}
 
+	if(query_set) {
+		int i;
+		for(i = 0; i < query_files->count; i++)
+			ncnf_qresult_free(query_results[i]);
+		free(query_results);
+		ncnf_qresult_free(query_result);
+		ncnf_query_set_free(query_set);
+		ncnf_sf_sfree(query_files);
+	}
 	ncnf_destroy(root);
 
+	if(policy_stats) {
+		struct ncnf_policy_stats ps[32];
+		int n;
+		int i;
+
+		n = ncnf_policy_stats(ps, sizeof(ps) / sizeof(ps[0]));
+		for(i = 0; i < n && i < (int)(sizeof(ps) / sizeof(ps[0])); i++)
+			fprintf(stderr, "Policy %d: %lu runs, %lu failures, "
+				"%llu us: %s\n",
+				ps[i].number, ps[i].runs, ps[i].failures,
+				ps[i].usec, ps[i].description);
+	}
+
 	fprintf(stderr, "%s: %s\n", *av, validate ? "Validated" : "Parsed");
 
 	return 0;
@@ -259,21 +350,175 @@ void
 usage(const char *av0) {
 	fprintf(stderr,
 	"Configuration file validator (c) 2002, 03, 04, 2005 Netli, Inc.\n"
-	"Usage: %s [-impQrsStvV] <ncnf_config_file> ...\n"
+	"Usage: %s [-bcEimOpQrsStTvV] <ncnf_config_file> ...\n"
 	"Options:\n"
+	"  -b               Input files are compiled snapshots (see -c)\n"
+	"  -c <file.ncnfc>  Save the compiled snapshot of the configuration\n"
+	"  -E               Explain the NCQL queries (-Q) and print statistics\n"
 	"  -i <indent>      Use indentation spaces\n"
 	"  -o <ofile.ncnf>  Specify output file instead of default stdout\n"
+	"  -O <directory>   Save the results of every -Q query as <query>.ncnf\n"
 	"  -p               Profile mode (sleep() & exit())\n"
-#ifdef	SUPPORT_NCQL
 	"  -Q <file.ncql>   Perform NCQL query using specified query file\n"
-#endif	/* SUPPORT_NCQL */
 	"  -r <num>         Reload <num> times\n"
 	"  -s               Suppress file contents print-out (cmp. -v)\n"
 	"  -S <subtree>     Specify @sysid or /path of the subtree to dump\n"
 	"  -t <type>        \"Flatten\" the type. Put \"-\" for all types\n"
+	"  -T               Print the embedded policies statistics\n"
 	"  -v               Turn on verbose contents print-out mode (cmp. -s)\n"
 	"  -V               Disable validation\n"
 	, av0);
 	exit(EX_USAGE);
 }
 
+/*
+ * Read and compile the -Q query files.
+ */
+static ncnf_query_set_t *
+compile_queries(ncnf_sf_svect *query_files, int explain) {
+	ncnf_query_set_t *query_set;
+	int i;
+
+	query_set = ncnf_query_set_new();
+	if(!query_set) {
+		perror("-Q");
+		return NULL;
+	}
+
+	for(i = 0; i < query_files->count; i++) {
+		char errbuf[256];
+		size_t errlen = sizeof(errbuf);
+		ncnf_query_t *nq;
+
+		ncnf_obj *ncql = ncnf_Read(
+			query_files->list[i],
+			NCNF_ST_FILENAME
+			/* Never use embedded validation */
+			| NCNF_FL_NOEMB
+			/* Relaxed namespace rules */
+			| NCNF_FL_RELNS);
+		if(!ncql) {
+			fprintf(stderr,
+			"-Q %s: Failed to read file: %s\n",
+				query_files->list[i],
+				strerror(errno));
+			break;
+		}
+
+		nq = ncnf_compile_query(ncql, errbuf, &errlen);
+		ncnf_destroy(ncql);
+		if(!nq) {
+			fprintf(stderr, "-Q %s: %s\n",
+				query_files->list[i],
+				errbuf);
+			break;
+		}
+		if(explain) {
+			fprintf(stderr, "-Q %s:\n", query_files->list[i]);
+			ncnf_explain_query(nq, stderr);
+		}
+		if(ncnf_query_set_add(query_set, nq) == -1) {
+			ncnf_delete_query(nq);
+			perror("-Q");
+			break;
+		}
+	}
+
+	if(i < query_files->count) {
+		ncnf_query_set_free(query_set);
+		return NULL;
+	}
+
+	return query_set;
+}
+
+/*
+ * The name the query results are saved under: the query file name
+ * without the directory and the .ncql suffix.
+ */
+static const char *
+query_output_name(const char *qfile, int *len) {
+	const char *base = strrchr(qfile, '/');
+
+	base = base ? base + 1 : qfile;
+	*len = strlen(base);
+	if(*len > 5 && strcmp(base + *len - 5, ".ncql") == 0)
+		*len -= 5;
+
+	return base;
+}
+
+/*
+ * Make sure no two queries would be saved into the same file.
+ */
+static int
+check_query_outputs(ncnf_sf_svect *query_files) {
+	int i, j;
+
+	for(i = 0; i < query_files->count; i++) {
+		const char *name;
+		int len;
+
+		name = query_output_name(query_files->list[i], &len);
+		for(j = 0; j < i; j++) {
+			const char *other;
+			int olen;
+
+			other = query_output_name(query_files->list[j], &olen);
+			if(len == olen && memcmp(name, other, len) == 0) {
+				fprintf(stderr,
+				"-O: %s and %s would both be saved as %.*s.ncnf\n",
+					query_files->list[j],
+					query_files->list[i],
+					len, name);
+				return -1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Save the results of every query into <dir>/<query>.ncnf,
+ * see query_output_name().
+ */
+static int
+save_query_results(const char *dir, ncnf_sf_svect *query_files,
+		ncnf_qresult_t **results, ncnf_obj *start_obj,
+		const char *flatten_type, int verbose, int indent) {
+	int i;
+
+	for(i = 0; i < query_files->count; i++) {
+		const char *base;
+		int baselen;
+		char *fname;
+		FILE *f;
+
+		base = query_output_name(query_files->list[i], &baselen);
+
+		fname = malloc(strlen(dir) + baselen + sizeof("/.ncnf"));
+		if(!fname) {
+			perror("-O");
+			return -1;
+		}
+		sprintf(fname, "%s/%.*s.ncnf", dir, baselen, base);
+
+		f = fopen(fname, "w");
+		if(f) {
+			ncnf_qresult_dump(f, start_obj, results[i],
+				flatten_type, verbose, indent);
+			if(fclose(f))
+				f = NULL;
+		}
+		if(!f) {
+			fprintf(stderr, "Cannot save %s: %s\n",
+				fname, strerror(errno));
+			free(fname);
+			return -1;
+		}
+		free(fname);
+	}
+
+	return 0;
+}
@@ -33,6 +33,10 @@
 #include "headers.h"
 #include "ncnf_int.h"
 #include "ncnf_cr.h"
+#include "ncnf_snap.h"
+#include "ncnf_tpool.h"
+#include "ncnf_vroot.h"
+#include "ncnf_async.h"
 #include "ncnf_vr.h"
 #include "ncnf_policy.h"
 #include "ncnf.h"
@@ -110,23 +114,63 @@ ncnf_Read(const char *data, enum ncnf_source_type stype, ...) {
 	int async_validation		= (stype & NCNF_FL_ASYNCVAL);
 	int relaxed_ns			= (stype & NCNF_FL_RELNS);
 	int strip_with_ncql		= (stype & NCNF_FL_EXTNCQL);
+	enum ncnf_mr_flags mr_flags	= NMR_ENABLED | NMR_STRINGS;
 	char *ncql_qfile = 0;
 	char *ncql_proc = 0;
 	char *ncql_conf = 0;
+	struct ncnf_token_pool *pool = 0;
+	struct ncnf_obj_s *baseline = 0;
 	va_list ap;
 	int ret;
 
-	/* Get rid of NCNF_FL stuff from the source type indicator */
-	stype &= ~(NCNF_FL_NODYN | NCNF_FL_NOEMB
-		| NCNF_FL_ASYNCVAL | NCNF_FL_RELNS | NCNF_FL_EXTNCQL);
-
 	/* BGZ#1988 */
+	va_start(ap, stype);
 	if(strip_with_ncql) {
-		va_start(ap, stype);
 		ncql_qfile = va_arg(ap, char *);
 		ncql_proc = va_arg(ap, char *);
 		ncql_conf = va_arg(ap, char *);
-		va_end(ap);
+	}
+	if(stype & NCNF_FL_TOKPOOL) {
+		pool = va_arg(ap, struct ncnf_token_pool *);
+		if(pool == NULL) {
+			va_end(ap);
+			errno = EINVAL;
+			return NULL;
+		}
+	}
+	if(stype & NCNF_FL_BASELINE) {
+		baseline = va_arg(ap, struct ncnf_obj_s *);
+		if(baseline && baseline->obj_class != NOBJ_ROOT) {
+			va_end(ap);
+			errno = EINVAL;
+			return NULL;
+		}
+	}
+	va_end(ap);
+
+	if(stype & NCNF_FL_NOREGION)
+		mr_flags = NMR_DISABLED;
+	else if(stype & (NCNF_FL_HEAPSTR | NCNF_FL_TOKPOOL))
+		mr_flags = NMR_ENABLED;	/* Pooled strings outlive the tree */
+
+	/* Get rid of NCNF_FL stuff from the source type indicator */
+	stype &= ~(NCNF_FL_NODYN | NCNF_FL_NOEMB
+		| NCNF_FL_ASYNCVAL | NCNF_FL_RELNS | NCNF_FL_EXTNCQL
+		| NCNF_FL_NOREGION | NCNF_FL_HEAPSTR | NCNF_FL_TOKPOOL
+		| NCNF_FL_BASELINE);
+
+	/*
+	 * Snapshots are resolved and validated at compile time.
+	 */
+	if(stype == NCNF_ST_SNAPSHOT) {
+		if(_ncnf_snap_read(data, &root, mr_flags))
+			return NULL;
+		/* Fingerprints and lookup indexes, see below */
+		if(_ncnf_vroot_prepare(root)) {
+			ncnf_destroy((ncnf_obj *)root);
+			return NULL;
+		}
+		return (ncnf_obj *)root;
 	}
 
 	/*
@@ -172,7 +216,7 @@ ncnf_Read(const char *data, enum ncnf_source_type stype, ...) {
 		if(ncql_conf && _asyncval.state == AVS_SUCCEEDED) {
 			/* Read in the processed file */
 			ret = _ncnf_cr_read(ncql_conf, NCNF_ST_FILENAME,
-					&root, relaxed_ns);
+					&root, relaxed_ns, mr_flags, pool);
 			if(ret == 0) {
 				no_dynamic_validation = NCNF_FL_NODYN;
 				no_embedded_validation = NCNF_FL_NOEMB;
@@ -185,7 +229,8 @@ ncnf_Read(const char *data, enum ncnf_source_type stype, ...) {
 			/* Fall back into the full configuration file reading */
 		}
 
-		ret = _ncnf_cr_read(data, stype, &root, relaxed_ns);
+		ret = _ncnf_cr_read(data, stype, &root, relaxed_ns, mr_flags,
+			pool);
 		if(ret != 0)
 			return NULL;
 	} while(0);
@@ -208,6 +253,7 @@ ncnf_Read(const char *data, enum ncnf_source_type stype, ...) {
 	 * Dynamic validation against .vr (validator rules) file.
 	 */
 	while(!no_dynamic_validation) {
+		struct ncnf_obj_s *vr_baseline = baseline;
 		char *filename;
 		struct vr_config *vc;
 
@@ -215,7 +261,9 @@ ncnf_Read(const char *data, enum ncnf_source_type stype, ...) {
 			"_validator-rules");
 		if(filename == NULL) {
 			break;
-		} else if(*filename != '/'
+		}
+
+		if(*filename != '/'
 			&& stype == NCNF_ST_FILENAME
 			&& strchr(data, '/')) {
 			char *newfname;
@@ -236,7 +284,7 @@ ncnf_Read(const char *data, enum ncnf_source_type stype, ...) {
 			filename = newfname;
 		}
 
-		vc = ncnf_vr_read(filename);
+		vc = ncnf_vr_get(filename);
 		if(vc == NULL) {
 			if(errno == ENOENT) {
 				_ncnf_debug_print(0,
@@ -251,13 +299,22 @@ ncnf_Read(const char *data, enum ncnf_source_type stype, ...) {
 			return NULL;
 		}
 
-		ret = ncnf_validate(root, vc);
+		/*
+		 * The baseline is only trusted if it was validated
+		 * against the very same rules: the same file, unchanged.
+		 */
+		if(vr_baseline && vr_baseline->m_rules != vc->id)
+			vr_baseline = NULL;
+
+		ret = ncnf_validate_since(root, vc, vr_baseline);
+		if(ret == 0)
+			root->m_rules = vc->id;
 		ncnf_vr_destroy(vc);
 		vc = NULL;
 		if(ret != 0) {
 			_ncnf_debug_print(1,
 				"%s validation against %s failed",
-				stype==NCNF_ST_TEXT?"NCNF data":data,
+				stype==NCNF_ST_FILENAME?data:"NCNF data",
 				filename);
 			ncnf_destroy((ncnf_obj *)root);
 			return NULL;
@@ -281,8 +338,12 @@ ncnf_Read(const char *data, enum ncnf_source_type stype, ...) {
 			 * Only invoke embedded validator if
 			 * there is a "_validator-embedded"
 			 * attribute defined to a non-zero value.
+			 * The baseline must have been checked as well.
 			 */
-			if(ncnf_policy(root)) {
+			if(baseline && (ncnf_get_attr_int((ncnf_obj *)baseline,
+					"_validator-embedded", &yes) || !yes))
+				baseline = NULL;
+			if(ncnf_policy(root, baseline)) {
 				_ncnf_debug_print(1,
 					"Failed to check the configuration "
 					"against the hardcoded policy");
@@ -292,9 +353,87 @@ ncnf_Read(const char *data, enum ncnf_source_type stype, ...) {
 		}
 	}
 
+	/*
+	 * Fingerprint the subtrees for the faster diffs, and make sure
+	 * every wide collection has its lookup index and every object
+	 * has its cold part, so the tree may be read by several threads
+	 * at once.
+	 */
+	if(_ncnf_vroot_prepare(root)) {
+		ncnf_destroy((ncnf_obj *)root);
+		return NULL;
+	}
+
 	return (ncnf_obj *)root;
 }
 
+int
+ncnf_snapshot(ncnf_obj *root, const char *snapshot_filename) {
+	return _ncnf_snap_write((struct ncnf_obj_s *)root, snapshot_filename);
+}
+
+ncnf_async *
+ncnf_read_async(const char *source, enum ncnf_source_type stype,
+		ncnf_obj *baseline, void (*callback)(ncnf_async *, void *key),
+		void *key) {
+	return _ncnf_async_start(source, stype, (struct ncnf_obj_s *)baseline,
+		callback, key);
+}
+
+int
+ncnf_async_fd(ncnf_async *as) {
+	if(as == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	return _ncnf_async_fd(as);
+}
+
+int
+ncnf_async_done(ncnf_async *as) {
+	if(as == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	return _ncnf_async_done(as);
+}
+
+ncnf_obj *
+ncnf_async_finish(ncnf_async *as) {
+	if(as == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+	return (ncnf_obj *)_ncnf_async_finish(as);
+}
+
+ncnf_token_pool *
+ncnf_token_pool_new(size_t max_bytes) {
+	/* Shared strings live on the heap */
+	return _ncnf_tpool_new(NULL, max_bytes);
+}
+
+int
+ncnf_token_pool_evict(ncnf_token_pool *pool) {
+	if(pool == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	return _ncnf_tpool_evict(pool);
+}
+
+void
+ncnf_token_pool_stats(ncnf_token_pool *pool,
+		struct ncnf_token_pool_stats *stats) {
+	if(pool && stats)
+		_ncnf_tpool_stats(pool, stats);
+}
+
+void
+ncnf_token_pool_destroy(ncnf_token_pool *pool) {
+	_ncnf_tpool_destroy(pool);
+}
+
 ncnf_obj *
 ncnf_obj_parent(ncnf_obj *objp) {
 	struct ncnf_obj_s *obj = objp;
@@ -316,7 +455,12 @@ ncnf_destroy(ncnf_obj *obj_p) {
 	if(obj == NULL)
 		return;
 
-	_ncnf_notify_everyone(obj, NCNF_OBJ_DESTROY);
+	/*
+	 * Nobody could have attached a notificator to the tree
+	 * if its memory region never saw one.
+	 */
+	if(_ncnf_mr_owner(obj->mr) != obj || _ncnf_mr_notified(obj->mr))
+		_ncnf_notify_everyone(obj, NCNF_OBJ_DESTROY);
 	_ncnf_obj_destroy(obj);
 }
 
@@ -338,6 +482,20 @@ ncnf_get_obj(ncnf_obj *root,
 		opt_type, opt_name, style, _NGF_NOFLAGS);
 }
 
+ncnf_obj *
+ncnf_get_obj_atom(ncnf_obj *root,
+	ncnf_atom_t opt_type, const char *opt_name,
+		enum ncnf_get_style style) {
+
+	if(root == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return (ncnf_obj *)_ncnf_get_obj((struct ncnf_obj_s *)root,
+		(const char *)opt_type, opt_name, style, _NGF_TYPE_ATOM);
+}
+
 ncnf_obj *
 ncnf_obj_real(ncnf_obj *ref_obj_p) {
 	struct ncnf_obj_s *ref_obj = ref_obj_p;
@@ -487,6 +645,39 @@ ncnf_obj_type(ncnf_obj *objp) {
 	return obj->type;
 }
 
+ncnf_atom_t
+ncnf_obj_type_atom(ncnf_obj *objp) {
+	struct ncnf_obj_s *obj = objp;
+
+	if(obj == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	if(obj->type_atom == NULL)
+		errno = 0;	/* No error */
+
+	return obj->type_atom;
+}
+
+ncnf_atom_t
+ncnf_atom(const char *type) {
+	if(type == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+	return _ncnf_atom(type, -1);
+}
+
+const char *
+ncnf_atom_name(ncnf_atom_t atom) {
+	if(atom == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+	return atom->name;
+}
+
 char *
 ncnf_obj_name(ncnf_obj *objp) {
 	struct ncnf_obj_s *obj = objp;
@@ -653,6 +844,7 @@ ncnf_get_attr_ipport(ncnf_obj *obj, const char *type, struct in_addr *rip, unsig
 int
 ncnf_udata_attach(ncnf_obj *objp, void *user_data) {
 	struct ncnf_obj_s *obj = (struct ncnf_obj_s *)objp;
+	struct ncnf_obj_cold_s *cold;
 	void *old_data;
 
 	if(obj == NULL) {
@@ -660,31 +852,38 @@ ncnf_udata_attach(ncnf_obj *objp, void *user_data) {
 		return -1;
 	}
 
+	if(obj->cold == NULL && user_data == NULL)
+		return 0;	/* Nothing was attached */
+
+	cold = _ncnf_obj_cold(obj);
+	if(cold == NULL)
+		return -1;
+
 	/*
 	 * Notify the notificator that the data gone, if there was some data.
  	 */
 
-	if(obj->user_data && obj->notify) {
-		if(obj->notify(objp,
+	if(cold->user_data && cold->notify) {
+		if(cold->notify(objp,
 			NCNF_UDATA_DETACH,
-				obj->notify_key) == -1) {
+				cold->notify_key) == -1) {
 			errno = EPERM;
 			return -1;
 		}
 	}
 
-	old_data = obj->user_data;
-	obj->user_data = user_data;
+	old_data = cold->user_data;
+	cold->user_data = user_data;
 
 	/*
 	 * Notify the notificator that the new data is attached. 
  	 */
 
-	if(user_data && obj->notify) {
-		if(obj->notify(objp,
+	if(user_data && cold->notify) {
+		if(cold->notify(objp,
 			NCNF_UDATA_ATTACH,
-				obj->notify_key) == -1) {
-			obj->user_data = old_data;
+				cold->notify_key) == -1) {
+			cold->user_data = old_data;
 			errno = EPERM;
 			return -1;
 		}
@@ -698,6 +897,7 @@ ncnf_notificator_attach(ncnf_obj *objp,
 	int (*notify)(ncnf_obj *obj, enum ncnf_notify_event, void *key),
 		void *key) {
 	struct ncnf_obj_s *obj = (struct ncnf_obj_s *)objp;
+	struct ncnf_obj_cold_s *cold;
 	int (*old_notify)(ncnf_obj *, enum ncnf_notify_event, void *);
 	void *old_notify_key;
 
@@ -706,29 +906,38 @@ ncnf_notificator_attach(ncnf_obj *objp,
 		return -1;
 	}
 
-	old_notify = obj->notify;
-	old_notify_key = obj->notify_key;
-	obj->notify = NULL;
+	if(obj->cold == NULL && notify == NULL)
+		return 0;	/* Nothing was attached */
+
+	cold = _ncnf_obj_cold(obj);
+	if(cold == NULL)
+		return -1;
+
+	old_notify = cold->notify;
+	old_notify_key = cold->notify_key;
+	cold->notify = NULL;
 
 	if(old_notify) {
 		/* Report detach to the previous notificator */
 		if(old_notify(objp, NCNF_NOTIF_DETACH, old_notify_key) == -1) {
 			/* DETACH denied */
-			obj->notify = old_notify;
-			obj->notify_key = old_notify_key;
+			cold->notify = old_notify;
+			cold->notify_key = old_notify_key;
 			errno = EPERM;
 			return -1;
 		}
 	}
 
-	obj->notify = notify;
-	obj->notify_key = key;
+	cold->notify = notify;
+	cold->notify_key = key;
+	if(notify)
+		_ncnf_mr_set_notified(obj->mr);
 
 	/* Report attach to the new notificator */
-	if(obj->notify) {
+	if(cold->notify) {
 		if(notify(objp, NCNF_NOTIF_ATTACH, key) == -1) {
-			obj->notify = NULL;
-			obj->notify_key = NULL;
+			cold->notify = NULL;
+			cold->notify_key = NULL;
 			errno = EPERM;
 			return -1;
 		}
@@ -755,7 +964,8 @@ ncnf_lazy_notificator(ncnf_obj *objp, char *watchfor,
 void *
 ncnf_udata_get(const ncnf_obj *objp) {
 	if(objp) {
-		return ((const struct ncnf_obj_s *)objp)->user_data;
+		return _NOBJ_COLD((const struct ncnf_obj_s *)objp,
+			user_data, NULL);
 	} else {
 		errno = EINVAL;
 		return NULL;
@@ -775,7 +985,132 @@ ncnf_diff(ncnf_obj *old_treep, ncnf_obj *new_treep) {
 		return -1;
 	}
 
-	return _ncnf_diff(old_tree, new_tree);
+	return _ncnf_diff(old_tree, new_tree, NULL);
+}
+
+int
+ncnf_diff_ex(ncnf_obj *old_treep, ncnf_obj *new_treep,
+		ncnf_changeset **changes) {
+	struct ncnf_obj_s *old_tree = (struct ncnf_obj_s *)old_treep;
+	struct ncnf_obj_s *new_tree = (struct ncnf_obj_s *)new_treep;
+
+	if(old_tree == NULL || new_tree == NULL || changes == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return _ncnf_diff(old_tree, new_tree, changes);
+}
+
+void
+ncnf_changeset_free(ncnf_changeset *cs) {
+	if(cs)
+		_ncnf_changeset_free(cs);
+}
+
+ncnf_diff_stage *
+ncnf_diff_prepare(ncnf_obj *old_treep, ncnf_obj *new_treep) {
+	struct ncnf_obj_s *old_tree = (struct ncnf_obj_s *)old_treep;
+	struct ncnf_obj_s *new_tree = (struct ncnf_obj_s *)new_treep;
+
+	if(old_tree == NULL || new_tree == NULL
+	|| old_tree->obj_class != NOBJ_ROOT
+	|| new_tree->obj_class != NOBJ_ROOT) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return _ncnf_diff_prepare(old_tree, new_tree, 0);
+}
+
+int
+ncnf_diff_commit(ncnf_diff_stage *st, ncnf_changeset **changes) {
+	if(st == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return _ncnf_diff_commit(st, changes);
+}
+
+void
+ncnf_diff_abort(ncnf_diff_stage *st) {
+	if(st)
+		_ncnf_diff_abort(st);
+}
+
+unsigned long long
+ncnf_obj_fingerprint(ncnf_obj *objp) {
+	struct ncnf_obj_s *obj = (struct ncnf_obj_s *)objp;
+
+	if(obj == NULL || obj->obj_class == NOBJ_ITERATOR) {
+		errno = EINVAL;
+		return 0;
+	}
+
+	return _ncnf_fingerprint(obj);
+}
+
+ncnf_vroot *
+ncnf_vroot_new(int max_readers) {
+	return _ncnf_vroot_new(max_readers);
+}
+
+int
+ncnf_vroot_publish(ncnf_vroot *vr, ncnf_obj *rootp, ncnf_changeset **changes) {
+	struct ncnf_obj_s *root = (struct ncnf_obj_s *)rootp;
+
+	if(vr == NULL || root == NULL || root->obj_class != NOBJ_ROOT) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return _ncnf_vroot_publish(vr, root, changes);
+}
+
+int
+ncnf_vroot_reader(ncnf_vroot *vr) {
+	if(vr == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	return _ncnf_vroot_reader(vr);
+}
+
+void
+ncnf_vroot_reader_done(ncnf_vroot *vr, int reader) {
+	if(vr && reader >= 0)
+		_ncnf_vroot_reader_done(vr, reader);
+}
+
+ncnf_obj *
+ncnf_vroot_pin(ncnf_vroot *vr, int reader) {
+	return (ncnf_obj *)_ncnf_vroot_pin(vr, reader);
+}
+
+void
+ncnf_vroot_unpin(ncnf_vroot *vr, int reader) {
+	_ncnf_vroot_unpin(vr, reader);
+}
+
+int
+ncnf_vroot_reclaim(ncnf_vroot *vr) {
+	if(vr == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	return _ncnf_vroot_reclaim(vr);
+}
+
+void
+ncnf_vroot_destroy(ncnf_vroot *vr) {
+	_ncnf_vroot_destroy(vr);
+}
+
+static int
+_ncnf_dump_marked(struct ncnf_obj_s *obj, void *key) {
+	(void)key;
+	return obj->mark;
 }
 
 /*
@@ -789,7 +1124,7 @@ ncnf_dump(FILE *f, ncnf_obj *obj, const char *flatten_type, int marked_only, int
 	if(f == NULL)
 		f = stdout;
 	_ncnf_obj_dump_recursive(f, (struct  ncnf_obj_s *)obj,
-		flatten_type, marked_only,
+		flatten_type, marked_only ? _ncnf_dump_marked : NULL, NULL,
 		verbose, 0, indent, 0, &recursive_size);
 	if(verbose)
 		fprintf(f, "# TOTAL RSIZE=%d\n", recursive_size);
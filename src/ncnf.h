@@ -31,20 +31,110 @@ ncnf_obj *ncnf_read(const char *_config_filename);
  * 
  * The caller of the function is the owner of this objects tree
  * and should destroy eventually the object tree with ncnf_destroy().
+ *
+ * With NCNF_ST_FD, the data is read from the given descriptor
+ * (a pipe, socket, regular file, etc) until EOF, in chunks,
+ * without buffering the whole input. The descriptor is not closed.
+ *
+ * With NCNF_FL_TOKPOOL, the (ncnf_token_pool *) argument follows
+ * (after the NCNF_FL_EXTNCQL ones, if any), see ncnf_token_pool_new().
+ *
+ * With NCNF_FL_BASELINE, the (ncnf_obj *) argument follows (after all
+ * of the above): the root of the configuration read and validated
+ * before, usually the one about to be updated with ncnf_diff(), or NULL.
+ * The subtrees which are the same as in the baseline are not validated
+ * again, so only the objects added or changed since, and their parents,
+ * are checked. The baseline must have been validated against the same
+ * rules: it is not trusted unless it was read by this process with the
+ * same "_validator-rules" file (after resolving the name relative to the
+ * configuration), unchanged since, or if its "_validator-embedded"
+ * setting is different.
  */
 enum ncnf_source_type {
 	NCNF_ST_FILENAME = 0,	/* Filename is passed */
 	NCNF_ST_TEXT     = 1,	/* Text file is passed */
-	// BGZ#1976: NCNF_ST_FD = 2, /* FD number in decimal ASCIIZ format */
+	NCNF_ST_FD       = 2,	/* FD number in decimal ASCIIZ format */
+	NCNF_ST_SNAPSHOT = 3,	/* Compiled snapshot file, see ncnf_snapshot() */
 	/* Flags could be applied also */
 	NCNF_FL_NODYN    = 32,	/* Disable dynamic (.vr) validation */
 	NCNF_FL_NOEMB    = 64,	/* Disable embedded policies validation */
 	NCNF_FL_ASYNCVAL = 128,	/* Enable asynchronous validation */
 	NCNF_FL_RELNS    = 256, /* Relaxed namespace (no duplicate checking) */
 	NCNF_FL_EXTNCQL  = 512, /* BGZ#1988: -Q, -E and -G arguments */
+	NCNF_FL_NOREGION = 1024, /* Allocate objects one by one, not in bulk */
+	NCNF_FL_HEAPSTR  = 2048, /* Keep strings outside of the tree region */
+	NCNF_FL_TOKPOOL  = 4096, /* Intern tokens in the application's pool */
+	NCNF_FL_BASELINE = 8192, /* Trust the previous validation */
 };
 ncnf_obj *ncnf_Read(const char *source, enum ncnf_source_type, ...);
 
+/*
+ * Read and validate the configuration on a worker thread, unlike
+ * NCNF_FL_ASYNCVAL, which runs an external validator process.
+ * There is no process-wide state: any number of reads may be in flight.
+ * The source type and flags are those of ncnf_Read(), except for
+ * NCNF_FL_ASYNCVAL, NCNF_FL_EXTNCQL, NCNF_FL_TOKPOOL and
+ * NCNF_FL_BASELINE (the baseline is passed directly instead, or NULL).
+ * The baseline must not be modified or destroyed until the read is over,
+ * though other threads may read it meanwhile.
+ *
+ * Once the read is over, the descriptor returned by ncnf_async_fd()
+ * becomes readable (suitable for poll()), ncnf_async_done() returns 1,
+ * and the callback, if any, is invoked on the worker thread.
+ * ncnf_async_finish() waits for the read to finish, disposes of the
+ * handle and returns the result of ncnf_Read() (NULL, errno is set).
+ * It must be called for every handle, but not from the callback.
+ *
+ * Returns NULL (ENOSYS) if the library is built without threads.
+ */
+typedef struct ncnf_async ncnf_async;
+ncnf_async *ncnf_read_async(const char *source, enum ncnf_source_type,
+	ncnf_obj *baseline, void (*callback)(ncnf_async *, void *key),
+	void *key);
+int ncnf_async_fd(ncnf_async *);
+int ncnf_async_done(ncnf_async *);
+ncnf_obj *ncnf_async_finish(ncnf_async *);
+
+/*
+ * Token intern pool.
+ * Identical tokens of the configuration file are interned, so the tree
+ * keeps a single copy of every type name and value. By default, the
+ * pool is private to a single ncnf_Read(). The pool created by the
+ * application may be passed to the consecutive reads (NCNF_FL_TOKPOOL),
+ * so the trees of the subsequent reloads share the unchanged strings.
+ * Such strings outlive any single tree, thus NCNF_FL_HEAPSTR is implied.
+ * The strings referenced only by the pool itself are evicted either
+ * explicitly, or once a read is over and the pool has grown above
+ * max_bytes (0 means no limit).
+ * The pool and the trees read with it must not be used by several
+ * threads at once.
+ */
+typedef struct ncnf_token_pool ncnf_token_pool;
+struct ncnf_token_pool_stats {
+	unsigned long hits;	/* Tokens found in the pool */
+	unsigned long misses;	/* Tokens added to the pool */
+	unsigned long evictions;	/* Tokens evicted from the pool */
+	size_t entries;		/* Tokens held by the pool */
+	size_t bytes;		/* Memory held by these tokens */
+};
+ncnf_token_pool *ncnf_token_pool_new(size_t max_bytes);
+int ncnf_token_pool_evict(ncnf_token_pool *);	/* Number of evicted */
+void ncnf_token_pool_stats(ncnf_token_pool *, struct ncnf_token_pool_stats *);
+void ncnf_token_pool_destroy(ncnf_token_pool *);
+
+/*
+ * Save the configuration tree, as returned by ncnf_Read(), into the
+ * compiled snapshot file. The tree is saved as it is: fully resolved
+ * and already validated. Reading the snapshot back with NCNF_ST_SNAPSHOT
+ * maps the file into memory and involves no parsing, no reference
+ * resolution and no validation, so NCNF_FL_NODYN and NCNF_FL_NOEMB
+ * are implied. The snapshot is only portable between the hosts of the
+ * same architecture.
+ * The file is replaced atomically.
+ * Returns 0 if all OK, -1 if error (errno is set).
+ */
+int ncnf_snapshot(ncnf_obj *root, const char *snapshot_filename);
+
 
 /*
  * Number of styles used to fetch an object or object chain.
@@ -80,6 +170,28 @@ ncnf_obj *ncnf_get_obj(ncnf_obj *obj,
 	const char *opt_type, const char *opt_name,
 	enum ncnf_get_style);
 
+/*
+ * Type name atoms.
+ * Every type name is interned once per process, and objects are matched
+ * against the type by comparing the atoms. The callers doing the same
+ * lookups over and over may resolve the type names into atoms up front,
+ * and skip the string handling altogether.
+ * ncnf_atom() returns the atom for the given type name, creating it if
+ * necessary, or NULL if memory is exhausted. Atoms are never destroyed.
+ * ncnf_obj_type_atom() returns NULL if the object has no type.
+ */
+typedef const struct ncnf_atom_s *ncnf_atom_t;
+ncnf_atom_t ncnf_atom(const char *type);
+const char *ncnf_atom_name(ncnf_atom_t);
+ncnf_atom_t ncnf_obj_type_atom(ncnf_obj *obj);
+
+/*
+ * Same as ncnf_get_obj(), but the type is given by its atom.
+ */
+ncnf_obj *ncnf_get_obj_atom(ncnf_obj *obj,
+	ncnf_atom_t opt_type, const char *opt_name,
+	enum ncnf_get_style);
+
 /*
  * Return object type or name (value) for most objects.
  * Return NULL if it is the configuration root or an iterator.
@@ -251,6 +363,147 @@ void *ncnf_udata_get(const ncnf_obj *obj);
  */
 int ncnf_diff(ncnf_obj *old_root, ncnf_obj *reference_root);
 
+/*
+ * Same as ncnf_diff(), but also describe what has been changed.
+ * The records come in the order they may be applied to a copy of
+ * the old configuration: all deletions first, then additions and
+ * modifications (every object precedes its contents), then the
+ * references, which may point to the objects added before.
+ * An added object is followed by the records for everything within it;
+ * a deleted one implies everything within it is deleted as well.
+ * A changed attribute is reported as a modification if its parent has
+ * lost and gained a single attribute of this type, and as a deletion
+ * and an addition otherwise.
+ *
+ * The path consists of the "type:name" components of the enclosing
+ * objects, separated by '/', followed by the "type:name" of the object
+ * itself (or just "type" for attributes). The values are names for
+ * objects, values for attributes, and "type:name" targets for references.
+ *
+ * The change set is allocated even if nothing has changed and should be
+ * disposed with ncnf_changeset_free(). Upon error, the function returns -1,
+ * the old tree is left intact and *changes is not touched.
+ */
+enum ncnf_change_kind {
+	NCNF_CHANGE_ADD		= 0,	/* old_value is NULL */
+	NCNF_CHANGE_MODIFY	= 1,
+	NCNF_CHANGE_DELETE	= 2,	/* new_value is NULL */
+};
+struct ncnf_change {
+	enum ncnf_change_kind kind;
+	char *path;
+	char *old_value;
+	char *new_value;
+};
+typedef struct ncnf_changeset {
+	struct ncnf_change *change;	/* Records, in the order to apply */
+	int count;			/* Number of records */
+	int added;
+	int modified;
+	int deleted;
+} ncnf_changeset;
+int ncnf_diff_ex(ncnf_obj *old_root, ncnf_obj *reference_root,
+	ncnf_changeset **changes);
+void ncnf_changeset_free(ncnf_changeset *);
+
+/*
+ * Same as ncnf_diff_ex(), split in two, so the lengthy comparison
+ * may be done by a worker thread while the owner thread keeps using
+ * the old configuration.
+ *
+ * ncnf_diff_prepare() compares the trees and makes the copies of
+ * the added objects, without modifying the old tree. It may run
+ * concurrently with the reads of the old tree and attaching the
+ * notificators to it, but the old tree must not be diffed, modified
+ * or destroyed until the stage is committed or aborted. The reference
+ * tree may be destroyed as soon as the function returns.
+ * Returns NULL (errno = ENOMEM) on failure, or ESTALE if the old tree's
+ * fingerprint is not computed (see ncnf_obj_fingerprint()).
+ *
+ * ncnf_diff_commit() should be called by the owner thread. It copies
+ * the added objects into the old tree's memory, applies the staged
+ * changes to the old tree and invokes notificators, exactly as ncnf_diff()
+ * would. The change set is returned if changes is not NULL. Fails with
+ * -1/ESTALE if the old tree has been changed since the stage was prepared,
+ * or -1/ENOMEM; the old tree is left intact upon error.
+ * ncnf_diff_abort() simply discards the stage. Both functions dispose
+ * of the stage, even upon error.
+ */
+typedef struct ncnf_diff_stage ncnf_diff_stage;
+ncnf_diff_stage *ncnf_diff_prepare(ncnf_obj *old_root,
+	ncnf_obj *reference_root);
+int ncnf_diff_commit(ncnf_diff_stage *, ncnf_changeset **changes);
+void ncnf_diff_abort(ncnf_diff_stage *);
+
+/*
+ * Structural fingerprint of the object and everything below it.
+ * Two subtrees with equal fingerprints are (almost certainly) identical
+ * as far as ncnf_diff() is concerned, so the caller may cheaply check
+ * whether some part of the configuration has changed after the reload.
+ * The fingerprints are computed when the configuration is read and
+ * do not depend on the order of the entries.
+ * Returns 0 (errno = EINVAL) for NULL or an iterator.
+ */
+unsigned long long ncnf_obj_fingerprint(ncnf_obj *obj);
+
+/*
+ * Versioned root, for the configuration shared by several threads.
+ * Instead of ncnf_diff()'ing the live tree, the application reads
+ * the new configuration and publishes it as the new version. The reader
+ * threads pin the current version for the time they use it, with no
+ * locking and no waiting. The replaced versions are destroyed once
+ * no reader holds them anymore, by the subsequent publications or
+ * by ncnf_vroot_reclaim().
+ *
+ * The published trees are owned by the versioned root and must not be
+ * modified: no ncnf_diff(), notificators or user data. The readers may
+ * use any lookups, but the NCNF_CHAIN_* ones link the found objects
+ * together: no two readers may chain the same objects at once.
+ *
+ * ncnf_vroot_publish() takes the tree, as returned by ncnf_Read(),
+ * and optionally describes its differences from the previous version
+ * (see ncnf_diff_ex(); the previous version is not modified, and is
+ * considered empty on the first publication). Returns -1 (errno is set)
+ * if the tree could not be published, the tree stays with the caller.
+ * Publications must not be done by several threads at once.
+ *
+ * Every reader thread takes its own slot with ncnf_vroot_reader()
+ * (-1/ENOSPC if max_readers slots are taken) and passes it to
+ * ncnf_vroot_pin(), which returns the current version or NULL if
+ * nothing is published yet. The version stays valid until
+ * ncnf_vroot_unpin(). Pins do not nest.
+ */
+typedef struct ncnf_vroot ncnf_vroot;
+ncnf_vroot *ncnf_vroot_new(int max_readers);
+int ncnf_vroot_publish(ncnf_vroot *, ncnf_obj *root, ncnf_changeset **changes);
+int ncnf_vroot_reader(ncnf_vroot *);
+void ncnf_vroot_reader_done(ncnf_vroot *, int reader);
+ncnf_obj *ncnf_vroot_pin(ncnf_vroot *, int reader);
+void ncnf_vroot_unpin(ncnf_vroot *, int reader);
+int ncnf_vroot_reclaim(ncnf_vroot *);	/* Number of versions still held */
+void ncnf_vroot_destroy(ncnf_vroot *);	/* With all the versions */
+
+/*
+ * Embedded policies statistics, accumulated over all the checks
+ * ("_validator-embedded") in the process.
+ * Fills in up to max entries, returns the number of policies.
+ */
+struct ncnf_policy_stats {
+	int number;		/* As in "_validator-policy-N-disable" */
+	const char *description;
+	unsigned long runs;	/* Times checked */
+	unsigned long failures;	/* Violations found */
+	unsigned long long usec;	/* Time spent checking */
+};
+int ncnf_policy_stats(struct ncnf_policy_stats *, int max);
+
+/*
+ * The rules ("_validator-rules" files) are kept by the process once read,
+ * and read again only when the file changes.
+ * Release all the rules kept, e.g. after switching to another file.
+ */
+void ncnf_vr_cache_flush(void);
+
 /***********
 * Disposal *
 ***********/
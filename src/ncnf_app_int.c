@@ -89,10 +89,11 @@ __na_pidfile_update(ncnf_obj *process, pid_t update_pid) {
 		struct ncnf_obj_s *pfo_int = pfo;
 		int pfd;
 
-		if(pfo_int->notify != __na_pidfile_notificator)
+		if(_NOBJ_COLD(pfo_int, notify, NULL)
+				!= __na_pidfile_notificator)
 			/* Incorrectly initialized object, or not ours */
 			continue;
-		pfd = ((int)pfo_int->notify_key) - 1;
+		pfd = ((int)pfo_int->cold->notify_key) - 1;
 		if(pfd <= 0)
 			/* Not bound to specific FD */
 			continue;
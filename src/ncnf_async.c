@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2001, 2002, 2003, 2004, 2005  Netli, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * $Id$
+ */
+/*
+ * Reading and validation on a worker thread.
+ */
+#include "headers.h"
+#include "ncnf_int.h"
+#include "ncnf_vroot.h"
+#include "ncnf_async.h"
+
+#ifdef	HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif	/* HAVE_LIBPTHREAD */
+
+struct ncnf_async {
+	char *source;
+	enum ncnf_source_type stype;
+	struct ncnf_obj_s *baseline;
+	void (*callback)(struct ncnf_async *, void *key);
+	void *key;
+
+	struct ncnf_obj_s *root;	/* Valid once done */
+	int error;			/* errno, if root is NULL */
+	int done;
+	int fd[2];			/* Written to once done */
+#ifdef	HAVE_LIBPTHREAD
+	pthread_t thread;
+#endif	/* HAVE_LIBPTHREAD */
+};
+
+static void
+_ncnf_async_free(struct ncnf_async *as) {
+	if(as->fd[0] != -1) close(as->fd[0]);
+	if(as->fd[1] != -1) close(as->fd[1]);
+	free(as->source);
+	free(as);
+}
+
+#ifdef	HAVE_LIBPTHREAD
+
+static void *
+_ncnf_async_worker(void *arg) {
+	struct ncnf_async *as = arg;
+	struct ncnf_obj_s *root;
+	ssize_t wrote;
+
+	root = (struct ncnf_obj_s *)ncnf_Read(as->source,
+		as->stype | NCNF_FL_BASELINE, as->baseline);
+	as->error = root ? 0 : errno;
+	as->root = root;
+	__atomic_store_n(&as->done, 1, __ATOMIC_RELEASE);
+
+	do {
+		wrote = write(as->fd[1], "", 1);
+	} while(wrote == -1 && errno == EINTR);
+
+	if(as->callback)
+		as->callback(as, as->key);
+
+	return NULL;
+}
+
+struct ncnf_async *
+_ncnf_async_start(const char *source, enum ncnf_source_type stype,
+		struct ncnf_obj_s *baseline,
+		void (*callback)(struct ncnf_async *, void *key), void *key) {
+	struct ncnf_async *as;
+	sigset_t set, oset;
+	int ret;
+
+	if(source == NULL
+	|| (stype & (NCNF_FL_ASYNCVAL | NCNF_FL_EXTNCQL
+			| NCNF_FL_TOKPOOL | NCNF_FL_BASELINE))
+	|| (baseline && baseline->obj_class != NOBJ_ROOT)) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	/*
+	 * The worker reads the baseline, and so may the other threads.
+	 */
+	if(baseline && _ncnf_vroot_prepare(baseline))
+		return NULL;
+
+	as = calloc(1, sizeof(*as));
+	if(as == NULL)
+		return NULL;
+	as->fd[0] = as->fd[1] = -1;
+
+	as->source = strdup(source);
+	if(as->source == NULL || pipe(as->fd)) {
+		_ncnf_async_free(as);
+		return NULL;
+	}
+	(void)fcntl(as->fd[0], F_SETFD, FD_CLOEXEC);
+	(void)fcntl(as->fd[1], F_SETFD, FD_CLOEXEC);
+
+	as->stype = stype;
+	as->baseline = baseline;
+	as->callback = callback;
+	as->key = key;
+
+	/*
+	 * The signals are left to the application's threads.
+	 */
+	sigfillset(&set);
+	pthread_sigmask(SIG_SETMASK, &set, &oset);
+	ret = pthread_create(&as->thread, NULL, _ncnf_async_worker, as);
+	pthread_sigmask(SIG_SETMASK, &oset, NULL);
+	if(ret) {
+		_ncnf_async_free(as);
+		errno = ret;
+		return NULL;
+	}
+
+	return as;
+}
+
+struct ncnf_obj_s *
+_ncnf_async_finish(struct ncnf_async *as) {
+	struct ncnf_obj_s *root;
+	int error;
+
+	pthread_join(as->thread, NULL);
+
+	root = as->root;
+	error = as->error;
+	_ncnf_async_free(as);
+
+	if(root == NULL)
+		errno = error;
+	return root;
+}
+
+#else	/* !HAVE_LIBPTHREAD */
+
+struct ncnf_async *
+_ncnf_async_start(const char *source, enum ncnf_source_type stype,
+		struct ncnf_obj_s *baseline,
+		void (*callback)(struct ncnf_async *, void *key), void *key) {
+	(void)source;
+	(void)stype;
+	(void)baseline;
+	(void)callback;
+	(void)key;
+	errno = ENOSYS;
+	return NULL;
+}
+
+struct ncnf_obj_s *
+_ncnf_async_finish(struct ncnf_async *as) {
+	_ncnf_async_free(as);
+	errno = ENOSYS;
+	return NULL;
+}
+
+#endif	/* HAVE_LIBPTHREAD */
+
+int
+_ncnf_async_fd(struct ncnf_async *as) {
+	return as->fd[0];
+}
+
+int
+_ncnf_async_done(struct ncnf_async *as) {
+	return __atomic_load_n(&as->done, __ATOMIC_ACQUIRE);
+}
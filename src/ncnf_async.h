@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2001, 2002, 2003, 2004, 2005  Netli, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * $Id$
+ */
+/*
+ * Reading and validation on a worker thread.
+ */
+#ifndef	__NCNF_ASYNC_H__
+#define	__NCNF_ASYNC_H__
+
+struct ncnf_async *_ncnf_async_start(const char *source,
+	enum ncnf_source_type stype, struct ncnf_obj_s *baseline,
+	void (*callback)(struct ncnf_async *, void *key), void *key);
+
+/*
+ * The descriptor becomes readable once the read is over.
+ */
+int _ncnf_async_fd(struct ncnf_async *);
+int _ncnf_async_done(struct ncnf_async *);
+
+/*
+ * Wait for the read to finish, free the handle and return the tree.
+ */
+struct ncnf_obj_s *_ncnf_async_finish(struct ncnf_async *);
+
+#endif	/* __NCNF_ASYNC_H__ */
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2001, 2002, 2003, 2004, 2005  Netli, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * $Id$
+ */
+/*
+ * Type name atoms.
+ *
+ * The table has a fixed number of buckets: the number of distinct type
+ * names is small. Atoms are never removed, so the chains are extended
+ * with the atomic compare-and-swap on the bucket head, and the lookups
+ * need no locking at all.
+ */
+#include "headers.h"
+#include "ncnf_int.h"
+
+#define	ATOM_BUCKETS	1024	/* Power of two */
+
+static struct ncnf_atom_s *_atoms[ATOM_BUCKETS];
+
+static unsigned int
+_ncnf_atom_hash(const char *name, int len) {
+	unsigned int h = 5381;
+	const unsigned char *p = (const unsigned char *)name;
+	const unsigned char *end = p + len;
+
+	for(; p < end; p++)
+		h = (h * 31) + tolower(*p);
+
+	return h;
+}
+
+/*
+ * Look the bucket through, starting at the given chain element.
+ */
+static struct ncnf_atom_s *
+_ncnf_atom_scan(struct ncnf_atom_s *a, const char *name, int len, int nocase) {
+	for(; a; a = a->next) {
+		if(a->len != len)
+			continue;
+		if(nocase) {
+			if(strncasecmp(a->name, name, len) == 0)
+				return a->fold;
+		} else {
+			if(memcmp(a->name, name, len) == 0)
+				return a;
+		}
+	}
+	return NULL;
+}
+
+ncnf_atom_t
+_ncnf_atom(const char *name, int len) {
+	struct ncnf_atom_s **bucket;
+	struct ncnf_atom_s *head;
+	struct ncnf_atom_s *a;
+	struct ncnf_atom_s *fold = NULL;
+	struct ncnf_atom_s *other;
+	unsigned int hash;
+	int i;
+
+	if(len < 0)
+		len = strlen(name);
+
+	hash = _ncnf_atom_hash(name, len);
+	bucket = &_atoms[hash & (ATOM_BUCKETS - 1)];
+
+	head = __atomic_load_n(bucket, __ATOMIC_ACQUIRE);
+	a = _ncnf_atom_scan(head, name, len, 0);
+	if(a) return a;
+
+	/* Case variants refer to the lower case atom */
+	for(i = 0; i < len; i++) {
+		if(isupper(((const unsigned char *)name)[i])) {
+			char *lower = malloc(len + 1);
+			if(lower == NULL)
+				return NULL;
+			for(i = 0; i < len; i++)
+				lower[i] = tolower(((const unsigned char *)name)[i]);
+			lower[len] = '\0';
+			fold = (struct ncnf_atom_s *)_ncnf_atom(lower, len);
+			free(lower);
+			if(fold == NULL)
+				return NULL;
+			break;
+		}
+	}
+
+	a = malloc(sizeof(*a) + len);
+	if(a == NULL)
+		return NULL;
+	memcpy(a->name, name, len);
+	a->name[len] = '\0';
+	a->len = len;
+	a->hash = hash;
+	a->fold = fold ? fold : a;
+
+	/*
+	 * Publish the atom, unless the same name
+	 * has been added by another thread meanwhile.
+	 */
+	for(;;) {
+		a->next = head;
+		if(__atomic_compare_exchange_n(bucket, &head, a, 0,
+				__ATOMIC_RELEASE, __ATOMIC_ACQUIRE))
+			return a;
+		/* The new head is loaded into (head) */
+		other = _ncnf_atom_scan(head, name, len, 0);
+		if(other) {
+			/* Lost the race */
+			free(a);
+			return other;
+		}
+	}
+}
+
+ncnf_atom_t
+_ncnf_atom_find(const char *name, int nocase) {
+	int len = strlen(name);
+	struct ncnf_atom_s *head;
+
+	head = __atomic_load_n(
+		&_atoms[_ncnf_atom_hash(name, len) & (ATOM_BUCKETS - 1)],
+		__ATOMIC_ACQUIRE);
+
+	return _ncnf_atom_scan(head, name, len, nocase);
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2001, 2002, 2003, 2004, 2005  Netli, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * $Id$
+ */
+/*
+ * Type name atoms.
+ *
+ * Every distinct type name is interned once per process. Objects carry
+ * the atom of their type, so type matching is a pointer comparison.
+ * Each atom also refers to the atom of its lower case variant, which
+ * makes the case-insensitive matching a pointer comparison as well.
+ * Atoms are never destroyed.
+ */
+#ifndef	__NCNF_ATOM_H__
+#define	__NCNF_ATOM_H__
+
+struct ncnf_atom_s {
+	struct ncnf_atom_s *next;	/* Hash chain */
+	struct ncnf_atom_s *fold;	/* Lower case variant, maybe itself */
+	unsigned int hash;		/* Case-insensitive hash */
+	int len;
+	char name[1];
+};
+
+/*
+ * Get the atom for the given type name, creating it if necessary.
+ * Safe to be called from several threads at once.
+ * Returns NULL if memory is exhausted.
+ */
+ncnf_atom_t _ncnf_atom(const char *name, int len);
+
+/*
+ * Find the existing atom, without creating it.
+ * With (nocase), the lower case variant is returned.
+ * Returns NULL if no such type name has ever been seen,
+ * which means no object may be of that type.
+ */
+ncnf_atom_t _ncnf_atom_find(const char *name, int nocase);
+
+#endif	/* __NCNF_ATOM_H__ */
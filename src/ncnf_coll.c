@@ -31,6 +31,191 @@
 #include "headers.h"
 #include "ncnf_int.h"
 
+/*
+ * Minimal number of entries allocated for a non-empty collection.
+ */
+#define	COLL_MIN_SIZE	4
+
+/*
+ * Collections with this many entries are searched using the index.
+ */
+#define	COLL_INDEX_THRESHOLD	16
+
+enum coll_index_key {
+	CIK_TYPE,	/* Lookup by type only */
+	CIK_NAME,	/* Lookup by value only */
+	CIK_BOTH,	/* Lookup by type and value */
+	CIK_MAX
+};
+
+/*
+ * The lookup index maps case-insensitive hashes of the type, value,
+ * or both, to the chains of entry positions. Chains are kept in the
+ * collection order, so the search yields results in the same order
+ * as the plain scan. Since the chains may contain collisions and
+ * case variants, the candidates are filtered as usual.
+ */
+struct coll_index {
+	void *mr;		/* Memory region of the index itself */
+	size_t mem_size;	/* Size of the whole index memory block */
+	unsigned int indexed;	/* Entries [0..indexed) are in the index */
+	unsigned int capacity;	/* Maximum number of entries in next[] */
+	unsigned int buckets;	/* Power of two */
+	int *head[CIK_MAX];
+	int *tail[CIK_MAX];
+	int *next[CIK_MAX];
+};
+
+static unsigned int
+_ncnf_coll_hash(const char *str, unsigned int h) {
+	if(str) {
+		for(; *str; str++)
+			h = (h * 31) + tolower(*(const unsigned char *)str);
+	}
+	return h;
+}
+
+static void
+_ncnf_coll_key_hashes(const char *type, const char *name,
+		unsigned int h[CIK_MAX]) {
+	h[CIK_TYPE] = _ncnf_coll_hash(type, 5381);
+	h[CIK_NAME] = _ncnf_coll_hash(name, 5381);
+	h[CIK_BOTH] = _ncnf_coll_hash(name, h[CIK_TYPE] * 33 + 1);
+}
+
+void
+_ncnf_coll_unindex(collection_t *coll) {
+	struct coll_index *ci = coll->index;
+
+	if(ci) {
+		coll->index = NULL;
+		_ncnf_mr_free(ci->mr, ci, ci->mem_size);
+	}
+}
+
+/*
+ * Bring the lookup index up to date with the collection,
+ * creating it if the collection became wide enough.
+ * Returns NULL if the collection should be scanned sequentially.
+ */
+static struct coll_index *
+_ncnf_coll_index(void *mr, collection_t *coll) {
+	struct coll_index *ci = coll->index;
+
+	if(ci && (ci->indexed > coll->entries
+		|| ci->capacity < coll->entries)) {
+		/* Shrunk behind our back, or outgrown */
+		_ncnf_coll_unindex(coll);
+		ci = NULL;
+	}
+
+	if(ci == NULL) {
+		unsigned int capacity;
+		size_t mem_size;
+		int *p;
+		int k;
+
+		if(coll->entries < COLL_INDEX_THRESHOLD)
+			return NULL;
+
+		for(capacity = 2 * COLL_INDEX_THRESHOLD;
+			capacity < 2 * coll->entries; capacity <<= 1);
+
+		mem_size = sizeof(*ci)
+			+ 3 * CIK_MAX * capacity * sizeof(int);
+		ci = _ncnf_mr_alloc(mr, mem_size);
+		if(ci == NULL)
+			return NULL;	/* Fall back to the plain scan */
+
+		ci->mr = mr;
+		ci->mem_size = mem_size;
+		ci->capacity = capacity;
+		ci->buckets = capacity;
+		p = (int *)(ci + 1);
+		for(k = 0; k < CIK_MAX; k++) {
+			ci->head[k] = p; p += capacity;
+			ci->tail[k] = p; p += capacity;
+			ci->next[k] = p; p += capacity;
+			memset(ci->head[k], 0xff, capacity * sizeof(int));
+		}
+
+		coll->index = ci;
+	}
+
+	/* Index the newly appended entries */
+	for(; ci->indexed < coll->entries; ci->indexed++) {
+		struct ncnf_obj_s *obj = coll->entry[ci->indexed].object;
+		unsigned int h[CIK_MAX];
+		int k;
+
+		_ncnf_coll_key_hashes(obj->type, obj->value, h);
+
+		for(k = 0; k < CIK_MAX; k++) {
+			unsigned int b = h[k] & (ci->buckets - 1);
+			ci->next[k][ci->indexed] = -1;
+			if(ci->head[k][b] == -1)
+				ci->head[k][b] = ci->indexed;
+			else
+				ci->next[k][ci->tail[k][b]] = ci->indexed;
+			ci->tail[k][b] = ci->indexed;
+		}
+	}
+
+	return ci;
+}
+
+/*
+ * The lookup index, if it covers the whole collection.
+ * The lookups never build it, so they do not modify the collection.
+ */
+static struct coll_index *
+_ncnf_coll_current_index(collection_t *coll) {
+	struct coll_index *ci = coll->index;
+
+	if(ci && ci->indexed == coll->entries)
+		return ci;
+
+	return NULL;
+}
+
+int
+_ncnf_coll_prepare(void *mr, collection_t *coll) {
+	if(coll->entries < COLL_INDEX_THRESHOLD)
+		return 0;	/* Scanned sequentially anyway */
+	return _ncnf_coll_index(mr, coll) ? 0 : -1;
+}
+
+/*
+ * Reallocate the collection storage to hold exactly new_size entries.
+ */
+static int
+_ncnf_coll_resize(void *mr, collection_t *coll, unsigned int new_size) {
+	void *p;
+
+	assert(new_size >= coll->entries);
+
+	if(new_size == coll->size)
+		return 0;
+
+	if(new_size == 0) {
+		_ncnf_mr_free(mr, coll->entry,
+			coll->size * sizeof(collection_entry));
+		coll->entry = NULL;
+		coll->size = 0;
+		return 0;
+	}
+
+	p = _ncnf_mr_realloc(mr, coll->entry,
+		coll->size * sizeof(collection_entry),
+		new_size * sizeof(collection_entry));
+	if(p == NULL)
+		return -1;
+	coll->entry = p;
+	coll->size = new_size;
+
+	return 0;
+}
+
 /*
  * Adjust storage size of the collection.
  */
@@ -41,19 +226,18 @@ _ncnf_coll_adjust_size(void *mr, collection_t *coll, int new_count) {
 
 		/*
 		 * Allocate and clear a few more entries.
+		 * The storage grows geometrically, so the series of
+		 * insertions takes linear time overall.
 		 */
 		if(new_count > coll->size) {
-			void *p;
-			size_t new_size = mr
-				? (coll->size + ((new_count + 3) & ~3))
-				: new_count;
-
-			p = realloc(coll->entry,
-				new_size * sizeof(collection_entry));
-			if(p == NULL)
+			unsigned int new_size = coll->size
+				? coll->size : COLL_MIN_SIZE;
+
+			while(new_size < new_count)
+				new_size <<= 1;
+
+			if(_ncnf_coll_resize(mr, coll, new_size))
 				return -1;
-			coll->entry = p;
-			coll->size = new_size;
 		}
 
 		memset(&coll->entry[coll->entries],
@@ -63,6 +247,9 @@ _ncnf_coll_adjust_size(void *mr, collection_t *coll, int new_count) {
 
 	} else {
 
+		if(new_count < coll->entries || new_count == 0)
+			_ncnf_coll_unindex(coll);
+
 		/*
 		 * Destroy all inserted objects.
 		 */
@@ -77,18 +264,38 @@ _ncnf_coll_adjust_size(void *mr, collection_t *coll, int new_count) {
 			_ncnf_obj_destroy(obj);
 		}
 
-		if(new_count == 0) {
-			if(coll->entry) {
-				free(coll->entry);
-				coll->entry = NULL;
-				coll->size = 0;
-			}
-		}
+		if(new_count == 0)
+			_ncnf_coll_resize(mr, coll, 0);
+		else
+			(void)_ncnf_coll_prepare(mr, coll);
 	}
 
 	return 0;
 }
 
+/*
+ * Make sure the collection can hold the given number of entries
+ * without further reallocations.
+ */
+int
+_ncnf_coll_reserve(void *mr, collection_t *coll, int count) {
+
+	if(count <= coll->size)
+		return 0;
+
+	return _ncnf_coll_resize(mr, coll, count);
+}
+
+/*
+ * Release the storage not occupied by entries.
+ */
+void
+_ncnf_coll_shrink(void *mr, collection_t *coll) {
+
+	if(coll->size > coll->entries)
+		(void)_ncnf_coll_resize(mr, coll, coll->entries);
+}
+
 
 /*
  * Insert new object into collection.
@@ -98,11 +305,11 @@ _ncnf_coll_insert(void *mr, collection_t *coll, struct ncnf_obj_s *obj, enum mer
 
 	/* Check for duplicates */
 	if(merge_flags & MERGE_DUPCHECK) {
-		if(_ncnf_coll_get(coll,
-			CG_TYPE_NOCASE | CG_NAME_NOCASE,
+		if(_ncnf_coll_get(mr, coll,
+			CG_TYPE_NOCASE | CG_NAME_NOCASE | CG_TYPE_ATOM,
 			(obj->obj_class == NOBJ_ATTRIBUTE
 			  || obj->obj_class == NOBJ_LAZY_NOTIF)
-			? obj->type
+			? (const char *)obj->type_atom
 			: NULL,
 				obj->value, NULL)) {
 			errno = EEXIST;
@@ -126,6 +333,9 @@ _ncnf_coll_insert(void *mr, collection_t *coll, struct ncnf_obj_s *obj, enum mer
 
 	coll->entry[coll->entries++].object = obj;
 
+	/* Keep the lookup index up to date, the scan is the fallback */
+	(void)_ncnf_coll_prepare(mr, coll);
+
 	return 0;
 }
 
@@ -141,11 +351,11 @@ _ncnf_coll_join(void *mr, collection_t *to, collection_t *from, struct ncnf_obj_
 	if(merge_flags & MERGE_DUPCHECK) {
 	    for(from_idx = 0; from_idx < from->entries; from_idx++) {
 		struct ncnf_obj_s *obj = from->entry[from_idx].object;
-		if(_ncnf_coll_get(to,
-			CG_TYPE_NOCASE | CG_NAME_NOCASE,
+		if(_ncnf_coll_get(mr, to,
+			CG_TYPE_NOCASE | CG_NAME_NOCASE | CG_TYPE_ATOM,
 			(obj->obj_class == NOBJ_ATTRIBUTE
 			  || obj->obj_class == NOBJ_LAZY_NOTIF)
-			? obj->type
+			? (const char *)obj->type_atom
 			: NULL,
 				obj->value, NULL)) {
 			errno = EEXIST;
@@ -154,6 +364,11 @@ _ncnf_coll_join(void *mr, collection_t *to, collection_t *from, struct ncnf_obj_
 	    }
 	}
 
+	/* Joining into the empty collection: the final size is known */
+	if(to->entries == 0 && _ncnf_coll_reserve(mr, to, from->entries))
+		/* ENOMEM */
+		return -1;
+
 	if(_ncnf_coll_adjust_size(mr, to, to->entries + from->entries))
 		/* ENOMEM */
 		return -1;
@@ -169,6 +384,8 @@ _ncnf_coll_join(void *mr, collection_t *to, collection_t *from, struct ncnf_obj_
 
 	to->entries += from->entries;
 
+	(void)_ncnf_coll_prepare(mr, to);
+
 	if(merge_flags & MERGE_EMPTYSRC)
 		/* Empty the source collection */
 		_ncnf_coll_clear(mr, from, 0);
@@ -199,40 +416,75 @@ _ncnf_coll_clear(void *mr, collection_t *coll, int destroy) {
  * Search in given collection for object specified by type or value or both.
  */
 struct ncnf_obj_s *
-_ncnf_coll_get(collection_t *coll, enum cget_flags flags,
+_ncnf_coll_get(void *mr, collection_t *coll, enum cget_flags flags,
 	const char *opt_type, const char *opt_name,
 		void *iterator) {
 	struct ncnf_obj_s *found = NULL;
 	struct ncnf_obj_s *found_last = NULL;
-	int (*type_compare)(const char *, const char *);
 	int (*name_compare)(const char *, const char *);
+	struct coll_index *ci = NULL;
+	int *chain = NULL;	/* Index chain to follow, if any */
+	ncnf_atom_t type_atom = NULL;
+	int type_nocase = (flags & CG_TYPE_NOCASE);
 	int ignore_class;
-	int opt_type_len;
 	int opt_name_len;
 	int entries;
 	int i;
 
-	type_compare = (flags & CG_TYPE_NOCASE) ? strcasecmp : strcmp;
+	/*
+	 * Types are compared by their atoms
+	 * (the lower case ones, if case is to be ignored).
+	 */
+	if(opt_type) {
+		if(flags & CG_TYPE_ATOM) {
+			type_atom = (ncnf_atom_t)opt_type;
+			if(type_nocase)
+				type_atom = type_atom->fold;
+			opt_type = type_atom->name;
+		} else {
+			type_atom = _ncnf_atom_find(opt_type, type_nocase);
+			if(type_atom == NULL) {
+				/* Never seen such a type */
+				errno = ESRCH;
+				return NULL;
+			}
+		}
+	}
+
 	name_compare = (flags & CG_NAME_NOCASE) ? strcasecmp : strcmp;
 
 	ignore_class = (flags & CG_IGNORE_REFERENCES)
 		? NOBJ_REFERENCE
 		: -1;
 
-	opt_type_len = opt_type ? strlen(opt_type) : 0;
 	opt_name_len = opt_name ? strlen(opt_name) : 0;
 
-	for(i = 0, entries = coll->entries; i < entries; i++) {
+	i = 0;
+	entries = coll->entries;
+
+	if((opt_type || opt_name) && (ci = _ncnf_coll_current_index(coll))) {
+		enum coll_index_key key;
+		unsigned int h[CIK_MAX];
+
+		_ncnf_coll_key_hashes(opt_type, opt_name, h);
+		key = opt_type ? (opt_name ? CIK_BOTH : CIK_TYPE) : CIK_NAME;
+		chain = ci->next[key];
+		i = ci->head[key][h[key] & (ci->buckets - 1)];
+	}
+
+	for(; i >= 0 && i < entries; i = chain ? chain[i] : (i + 1)) {
 		struct ncnf_obj_s *cur = coll->entry[i].object;
 
 		/*
 		 * Filters.
 		 */
 
-		if(opt_type)
-			if(bstr_len(cur->type) != opt_type_len
-			|| type_compare(cur->type, opt_type))
+		if(type_atom) {
+			ncnf_atom_t ta = cur->type_atom;
+			if(ta == NULL
+			|| (type_nocase ? ta->fold : ta) != type_atom)
 				continue;
+		}
 		if(opt_name)
 			if(bstr_len(cur->value) != opt_name_len
 			|| name_compare(cur->value, opt_name))
@@ -267,14 +519,19 @@ _ncnf_coll_get(collection_t *coll, enum cget_flags flags,
 			}
 		} else {
 			if((flags & CG_RETURN_CHAIN)) {
+				/* Chain links live in the cold part */
+				if(_ncnf_obj_cold(cur) == NULL) {
+					errno = ENOMEM;
+					return NULL;
+				}
 				if(found) {
-					found_last->chain_next = cur;
+					found_last->cold->chain_next = cur;
 				} else {
 					found = cur;
 				}
 				found_last = cur;
-				found_last->chain_next = NULL;
-				found_last->chain_cur = NULL;
+				found_last->cold->chain_next = NULL;
+				found_last->cold->chain_cur = NULL;
 			} else {
 			    	return cur;
 			}
@@ -287,13 +544,65 @@ _ncnf_coll_get(collection_t *coll, enum cget_flags flags,
 	return found;
 }
 
+int
+_ncnf_coll_cursor(void *mr, collection_t *coll, coll_cursor *cursor,
+		ncnf_atom_t opt_type, const char *opt_name) {
+	struct coll_index *ci;
+
+	cursor->coll = coll;
+	cursor->type = opt_type;
+	cursor->name = opt_name;
+	cursor->name_len = opt_name ? strlen(opt_name) : 0;
+	cursor->chain = NULL;
+	cursor->pos = 0;
+
+	if((opt_type || opt_name) && (ci = _ncnf_coll_current_index(coll))) {
+		enum coll_index_key key;
+		unsigned int h[CIK_MAX];
+
+		_ncnf_coll_key_hashes(opt_type ? opt_type->name : NULL,
+			opt_name, h);
+		key = opt_type ? (opt_name ? CIK_BOTH : CIK_TYPE) : CIK_NAME;
+		cursor->chain = ci->next[key];
+		cursor->pos = ci->head[key][h[key] & (ci->buckets - 1)];
+		return 1;
+	}
+
+	return 0;
+}
+
+struct ncnf_obj_s *
+_ncnf_coll_cursor_next(coll_cursor *cursor) {
+	collection_t *coll = cursor->coll;
+
+	while(cursor->pos >= 0 && cursor->pos < (int)coll->entries) {
+		int i = cursor->pos;
+		struct ncnf_obj_s *cur = coll->entry[i].object;
+
+		cursor->pos = cursor->chain ? cursor->chain[i] : (i + 1);
+
+		if(coll->entry[i].ignore_in_search)
+			continue;
+		if(cursor->type && cur->type_atom != cursor->type)
+			continue;
+		if(cursor->name
+		&& (bstr_len(cur->value) != cursor->name_len
+			|| strcmp(cur->value, cursor->name)))
+			continue;
+
+		return cur;
+	}
+
+	return NULL;
+}
+
 
 /*
- * Remove all objects with mark equal to match_mark
+ * Remove all objects with mark (or diff mark) equal to match_mark
  * from the collection.
  */
-void
-_ncnf_coll_remove_marked(collection_t *coll, int match_mark) {
+static void
+_ncnf_coll_remove(void *mr, collection_t *coll, int match_mark, int dmark) {
 	int shift = 0;
 	int k;
 
@@ -307,7 +616,8 @@ _ncnf_coll_remove_marked(collection_t *coll, int match_mark) {
 
 		obj = coll->entry[k].object;
 
-		if(obj->mark == match_mark) {
+		if((dmark ? obj->dmark : obj->mark) == match_mark) {
+			_ncnf_coll_unindex(coll);
 			/* Squeeze a little tighter */
 			shift++;
 			coll->entries--;
@@ -317,6 +627,18 @@ _ncnf_coll_remove_marked(collection_t *coll, int match_mark) {
 		}
 	}
 
+	if(shift)
+		(void)_ncnf_coll_prepare(mr, coll);
+}
+
+void
+_ncnf_coll_remove_marked(void *mr, collection_t *coll, int match_mark) {
+	_ncnf_coll_remove(mr, coll, match_mark, 0);
+}
+
+void
+_ncnf_coll_remove_dmarked(void *mr, collection_t *coll, int match_dmark) {
+	_ncnf_coll_remove(mr, coll, match_dmark, 1);
 }
 
 
@@ -347,6 +669,7 @@ main(int ac, char **av) {
 	static collection_t coll;
 	struct ncnf_obj_s *obj;
 	int ret;
+	int i;
 
 	/*
 	 * Test 1
@@ -359,7 +682,7 @@ main(int ac, char **av) {
 	ret = _ncnf_coll_insert(0, &coll, obj, MERGE_DUPCHECK);
 	assert(ret == 0);
 
-	_ncnf_coll_remove_marked(&coll, 1);
+	_ncnf_coll_remove_marked(0, &coll, 1);
 
 	assert(coll.entries == 0);
 
@@ -391,7 +714,7 @@ main(int ac, char **av) {
 	ret = _ncnf_coll_insert(0, &coll, obj, MERGE_DUPCHECK);
 	assert(ret == 0);
 
-	_ncnf_coll_remove_marked(&coll, 1);
+	_ncnf_coll_remove_marked(0, &coll, 1);
 
 	assert(coll.entries == 1);
 	assert(coll.entry[0].object->mark != 1);
@@ -427,7 +750,7 @@ main(int ac, char **av) {
 	ret = _ncnf_coll_insert(0, &coll, obj, MERGE_DUPCHECK);
 	assert(ret == 0);
 
-	_ncnf_coll_remove_marked(&coll, 1);
+	_ncnf_coll_remove_marked(0, &coll, 1);
 
 	assert(coll.entries == 3);
 
@@ -435,6 +758,85 @@ main(int ac, char **av) {
 
 	assert(coll.entries == 0);
 
+	/*
+	 * Test 4: indexed lookups
+	 */
+
+	for(i = 0; i < 100; i++) {
+		char type[16], value[16];
+		snprintf(type, sizeof(type), "%s%d", (i & 1) ? "T" : "t", i / 2);
+		snprintf(value, sizeof(value), "v%d", i);
+		obj = _ncnf_obj_new(0, NOBJ_ATTRIBUTE,
+			str2bstr(type, -1), str2bstr(value, -1), 0);
+		assert(obj);
+		obj->mark = (i % 3) == 0;
+		ret = _ncnf_coll_insert(0, &coll, obj, MERGE_NOFLAGS);
+		assert(ret == 0);
+	}
+
+	assert(coll.index);	/* Kept up to date by the insertions */
+	obj = _ncnf_coll_get(0, &coll, 0, "t7", NULL, NULL);
+	assert(obj && !strcmp(obj->value, "v14"));
+	obj = _ncnf_coll_get(0, &coll, 0, "T7", NULL, NULL);
+	assert(obj && !strcmp(obj->value, "v15"));
+	obj = _ncnf_coll_get(0, &coll, CG_TYPE_NOCASE, "T7", NULL, NULL);
+	assert(obj && !strcmp(obj->value, "v14"));
+	obj = _ncnf_coll_get(0, &coll, 0, NULL, "v15", NULL);
+	assert(obj && !strcmp(obj->type, "T7"));
+	obj = _ncnf_coll_get(0, &coll, CG_NAME_NOCASE, "t7", "V14", NULL);
+	assert(obj && !strcmp(obj->value, "v14"));
+	obj = _ncnf_coll_get(0, &coll, 0, "t7", "V14", NULL);
+	assert(obj == NULL);
+
+	/* Chains preserve the collection order */
+	obj = _ncnf_coll_get(0, &coll, CG_RETURN_CHAIN | CG_TYPE_NOCASE,
+		"t7", NULL, NULL);
+	assert(obj && !strcmp(obj->value, "v14"));
+	assert(obj->cold->chain_next
+		&& !strcmp(obj->cold->chain_next->value, "v15"));
+	assert(obj->cold->chain_next->cold->chain_next == NULL);
+
+	/* Types given by atoms */
+	obj = _ncnf_coll_get(0, &coll, CG_TYPE_ATOM,
+		(const char *)_ncnf_atom("T7", -1), NULL, NULL);
+	assert(obj && !strcmp(obj->value, "v15"));
+	obj = _ncnf_coll_get(0, &coll, CG_TYPE_ATOM | CG_TYPE_NOCASE,
+		(const char *)_ncnf_atom("T7", -1), NULL, NULL);
+	assert(obj && !strcmp(obj->value, "v14"));
+	assert(obj->type_atom == _ncnf_atom("t7", -1));
+	assert(obj->type_atom == _ncnf_atom("T7", -1)->fold);
+	assert(_ncnf_coll_get(0, &coll, CG_TYPE_NOCASE, "no-such-type",
+		NULL, NULL) == NULL && errno == ESRCH);
+
+	/* Searchability is respected */
+	obj = _ncnf_coll_get(0, &coll, CG_MARK_UNSEARCHABLE, "t7", NULL, NULL);
+	assert(obj && !strcmp(obj->value, "v14"));
+	obj = _ncnf_coll_get(0, &coll, CG_TYPE_NOCASE, "t7", NULL, NULL);
+	assert(obj && !strcmp(obj->value, "v15"));
+
+	/* Removal and subsequent insertions */
+	_ncnf_coll_remove_marked(0, &coll, 1);
+	assert(coll.entries == 66);
+	assert(coll.index);	/* Rebuilt */
+	assert(_ncnf_coll_get(0, &coll, 0, NULL, "v99", NULL) == NULL);
+	obj = _ncnf_coll_get(0, &coll, 0, NULL, "v98", NULL);
+	assert(obj && !strcmp(obj->type, "t49"));
+	obj = _ncnf_obj_new(0, NOBJ_ATTRIBUTE,
+		str2bstr("t49", -1), str2bstr("v100", -1), 0);
+	ret = _ncnf_coll_insert(0, &coll, obj, MERGE_DUPCHECK);
+	assert(ret == 0);
+	obj = _ncnf_coll_get(0, &coll, 0, NULL, "v100", NULL);
+	assert(obj && !strcmp(obj->type, "t49"));
+	obj = _ncnf_obj_new(0, NOBJ_ATTRIBUTE,
+		str2bstr("T49", -1), str2bstr("V100", -1), 0);
+	ret = _ncnf_coll_insert(0, &coll, obj, MERGE_DUPCHECK);
+	assert(ret == -1 && errno == EEXIST);
+	_ncnf_obj_destroy(obj);
+
+	_ncnf_coll_clear(0, &coll, 1);
+	assert(coll.entries == 0);
+	assert(coll.index == NULL);
+
 	return 0;
 }
 
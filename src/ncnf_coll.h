@@ -44,10 +44,13 @@ typedef struct collection_entry_s {
 	int ignore_in_search;
 } collection_entry;
 
+struct coll_index;	/* Lookup index, see ncnf_coll.c */
+
 typedef struct collection_s {
 	collection_entry *entry;
 	unsigned int entries;	/* Number of meaningful entries */
 	unsigned int size;	/* Number of allocated entries */
+	struct coll_index *index;	/* Kept for wide collections */
 } collection_t;
 
 /*
@@ -83,22 +86,76 @@ enum cget_flags {
   CG_RETURN_CHAIN	= (1 << 3),	/* Chain the results */
   CG_TYPE_NOCASE	= (1 << 4),	/* Case insensitive type comparison */
   CG_NAME_NOCASE	= (1 << 5),	/* Case insensitive name comparison */
+  CG_TYPE_ATOM		= (1 << 6),	/* opt_type is an ncnf_atom_t */
 };
 
 /*
  * Iterator may be an struct ncnf_obj_s *iterator
+ * The lookups do not modify the collection: the lookup index is only
+ * followed if it is up to date, and the collection is scanned otherwise.
  */
-struct ncnf_obj_s *_ncnf_coll_get(collection_t *coll,
+struct ncnf_obj_s *_ncnf_coll_get(void *mr, collection_t *coll,
 	enum cget_flags,
 	const char *opt_type, const char *opt_name,
 	void *opt_iterator);
 
+/*
+ * Cursor over the entries of the given type atom and value (both
+ * optional), compared the same way _ncnf_coll_get() does by default.
+ * The lookup index is followed when there is one, and nothing is
+ * allocated; the collection must not be modified while iterating.
+ */
+typedef struct coll_cursor_s {
+	collection_t *coll;
+	const struct ncnf_atom_s *type;
+	const char *name;
+	int name_len;
+	int *chain;	/* Index chain to follow, if any */
+	int pos;
+} coll_cursor;
+
+/*
+ * Returns 1 if the index is used, 0 if the collection is to be scanned.
+ */
+int _ncnf_coll_cursor(void *mr, collection_t *coll, coll_cursor *cursor,
+	const struct ncnf_atom_s *opt_type, const char *opt_name);
+struct ncnf_obj_s *_ncnf_coll_cursor_next(coll_cursor *cursor);
+
 
 /* Adjust _storage size_ */
 int _ncnf_coll_adjust_size(void *ignore, collection_t *coll, int new_count);
 
+/*
+ * Pre-allocate the storage for the given number of entries.
+ * Returns -1 if memory is exhausted.
+ */
+int _ncnf_coll_reserve(void *mr, collection_t *coll, int count);
+
+/*
+ * Trim the storage down to the number of entries actually used.
+ */
+void _ncnf_coll_shrink(void *mr, collection_t *coll);
+
 /* Remove marked elements */
-void _ncnf_coll_remove_marked(collection_t *coll, int match_mark);
+void _ncnf_coll_remove_marked(void *mr, collection_t *coll, int match_mark);
+
+/* Remove elements by their diff marks */
+void _ncnf_coll_remove_dmarked(void *mr, collection_t *coll, int match_dmark);
+
+/*
+ * Forget the lookup index. Must be called whenever the type or value
+ * of an object already inside the collection is changed,
+ * followed by _ncnf_coll_prepare().
+ */
+void _ncnf_coll_unindex(collection_t *coll);
+
+/*
+ * Bring the lookup index up to date with the collection. This is done
+ * by the functions adding and removing the entries, so the lookups
+ * find the index ready and may be done by several threads at once.
+ * Returns -1 if memory is exhausted (the lookups will scan).
+ */
+int _ncnf_coll_prepare(void *mr, collection_t *coll);
 
 /*
  * Empty the collection.
@@ -31,6 +31,30 @@
 #include "headers.h"
 #include "ncnf_int.h"
 
+/*
+ * Number of bytes needed to hold the object of the given class.
+ * Attributes and insertions, which are the bulk of any configuration,
+ * carry only the common header.
+ */
+size_t
+_ncnf_obj_size(enum obj_class obj_class) {
+	switch(obj_class) {
+	case NOBJ_ATTRIBUTE:
+	case NOBJ_INSERTION:
+	case NOBJ_LAZY_NOTIF:
+		return offsetof(struct ncnf_obj_s, un);
+	case NOBJ_REFERENCE:
+		return offsetof(struct ncnf_obj_s, un)
+			+ sizeof(((struct ncnf_obj_s *)0)->un.property_REFERENCE);
+	case NOBJ_ITERATOR:
+		return offsetof(struct ncnf_obj_s, un)
+			+ sizeof(((struct ncnf_obj_s *)0)->un.property_ITERATOR);
+	default:
+		/* NOBJ_ROOT, NOBJ_COMPLEX and not yet classified objects */
+		return sizeof(struct ncnf_obj_s);
+	}
+}
+
 /*
  * Basic constructor for the configuration object.
  * Takes optional type and name/value, and inserts their copies into
@@ -39,8 +63,9 @@
 struct ncnf_obj_s *
 _ncnf_obj_new(void *mr, enum obj_class obj_class, const bstr_t type, const bstr_t value, int config_line) {
 	struct ncnf_obj_s *nobj;
+	size_t size = _ncnf_obj_size(obj_class);
 
-	nobj = calloc(1, sizeof(struct ncnf_obj_s));
+	nobj = _ncnf_mr_alloc(mr, size);
 	if(nobj == NULL)
 		return NULL;
 
@@ -49,23 +74,76 @@ _ncnf_obj_new(void *mr, enum obj_class obj_class, const bstr_t type, const bstr_
 	 */
 
 	nobj->obj_class = obj_class;
-	if(type) nobj->type = bstr_ref(type);
-	if(value) nobj->value = bstr_ref(value);
+	if(type) {
+		nobj->type_atom = _ncnf_atom(type, bstr_len(type));
+		if(nobj->type_atom == NULL) {
+			_ncnf_mr_free(mr, nobj, size);
+			return NULL;
+		}
+		nobj->type = _ncnf_mr_strref(mr, type);
+	}
+	if(value) nobj->value = _ncnf_mr_strref(mr, value);
 	nobj->config_line = config_line;
 	nobj->mr = mr;
 
 	return nobj;
 }
 
+/*
+ * Change the class of a freshly parsed object, resizing it if needed.
+ */
+struct ncnf_obj_s *
+_ncnf_obj_reclass(struct ncnf_obj_s *obj, enum obj_class obj_class) {
+	size_t old_size = _ncnf_obj_size(obj->obj_class);
+	size_t new_size = _ncnf_obj_size(obj_class);
+
+	assert(obj->parent == NULL);
+
+	if(old_size != new_size) {
+		obj = _ncnf_mr_realloc(obj->mr, obj, old_size, new_size);
+		if(obj == NULL)
+			return NULL;
+		if(new_size > old_size)
+			memset((char *)obj + old_size, 0, new_size - old_size);
+	}
+
+	obj->obj_class = obj_class;
+
+	return obj;
+}
+
+/*
+ * Get the cold part of the object, creating it if necessary.
+ */
+struct ncnf_obj_cold_s *
+_ncnf_obj_cold(struct ncnf_obj_s *obj) {
+	if(obj->cold == NULL)
+		obj->cold = _ncnf_mr_alloc(obj->mr,
+			sizeof(struct ncnf_obj_cold_s));
+	return obj->cold;
+}
+
 
 /*
  * Kill everything alive within the configuration object structure.
  */
 void
 _ncnf_obj_destroy(struct ncnf_obj_s *obj) {
+	void *mr = obj->mr;
+	int region_owner = (mr && _ncnf_mr_owner(mr) == obj);
+	size_t size;
 
 	assert(obj->obj_class != NOBJ_INVALID);
 
+	if(region_owner && (_ncnf_mr_flags(mr) & NMR_STRINGS)) {
+		/*
+		 * The whole tree, including strings, lives in the
+		 * region. No need to dismantle it piece by piece.
+		 */
+		_ncnf_mr_destroy(mr);
+		return;
+	}
+
 	/*
 	 * Clear the common object header.
 	 */
@@ -117,8 +195,40 @@ _ncnf_obj_destroy(struct ncnf_obj_s *obj) {
 	}
 
 
+	_ncnf_mr_free(mr, obj->cold, sizeof(struct ncnf_obj_cold_s));
+	obj->cold = NULL;
+
+	size = _ncnf_obj_size(obj->obj_class);
 	obj->obj_class = NOBJ_INVALID;	/* Post invalidity */
-	free(obj);
+	_ncnf_mr_free(mr, obj, size);
+
+	if(region_owner)
+		_ncnf_mr_destroy(mr);
+}
+
+
+/*
+ * Replace the value of the object, which may already be in the tree.
+ * The reference to the new value is taken over.
+ */
+void
+_ncnf_obj_set_value(struct ncnf_obj_s *obj, bstr_t value) {
+	struct ncnf_obj_s *parent = obj->parent;
+
+	bstr_free(obj->value);
+	obj->value = value;
+
+	if(parent && _NOBJ_CONTAINER(parent)) {
+		/* Parent's lookup indexes are keyed by value */
+		enum collections_e c;
+		for(c = 0; c < MAX_COLLECTIONS; c++) {
+			_ncnf_coll_unindex(&parent->m_collection[c]);
+			(void)_ncnf_coll_prepare(parent->mr,
+				&parent->m_collection[c]);
+		}
+	}
+
+	_ncnf_fingerprint_invalidate(obj);
 }
 
 
@@ -204,6 +314,12 @@ _ncnf_obj_clone(void *mr, struct ncnf_obj_s *root) {
 	if(obj == NULL)
 		return NULL;
 
+	/* The tree may have been prepared for the concurrent reads */
+	if(root->cold && _ncnf_obj_cold(obj) == NULL) {
+		_ncnf_obj_destroy(obj);
+		return NULL;
+	}
+
 	switch(obj->obj_class) {
 	case NOBJ_ROOT:
 	case NOBJ_COMPLEX:
@@ -211,6 +327,12 @@ _ncnf_obj_clone(void *mr, struct ncnf_obj_s *root) {
 			collection_t *coll = &root->m_collection[c];
 			int i;
 
+			if(_ncnf_coll_reserve(mr, &obj->m_collection[c],
+					coll->entries)) {
+				_ncnf_obj_destroy(obj);
+				return NULL;
+			}
+
 			for(i = 0; i < coll->entries; i++) {
 				struct ncnf_obj_s *clone;
 
@@ -235,13 +357,15 @@ _ncnf_obj_clone(void *mr, struct ncnf_obj_s *root) {
 				}
 			}
 		}
+		obj->m_fingerprint = root->m_fingerprint;
+		obj->m_refs = root->m_refs;
 		break;
 	case NOBJ_ATTRIBUTE:
 		obj->m_attr_flags = root->m_attr_flags;
 		break;
 	case NOBJ_REFERENCE:
-		obj->m_ref_type = bstr_ref(root->m_ref_type);
-		obj->m_ref_value = bstr_ref(root->m_ref_value);
+		obj->m_ref_type = _ncnf_mr_strref(mr, root->m_ref_type);
+		obj->m_ref_value = _ncnf_mr_strref(mr, root->m_ref_value);
 		obj->m_ref_flags = root->m_ref_flags;
 		obj->m_direct_reference = root->m_direct_reference;
 		break;
@@ -35,15 +35,41 @@
 
 /*
  * Basic constructor for the configuration object.
+ * The object is allocated from the given memory region (or heap, if NULL).
  */
-struct ncnf_obj_s *_ncnf_obj_new(void *ignore, enum obj_class,
+struct ncnf_obj_s *_ncnf_obj_new(void *mr, enum obj_class,
 	const bstr_t _type, const bstr_t _name, int _config_line);
 
+/*
+ * Size of the object of the given class; smaller classes do not carry
+ * the unused tail of the class-specific union.
+ */
+size_t _ncnf_obj_size(enum obj_class);
+
+/*
+ * Change the class of the object which is not yet in the tree.
+ * Returns the (possibly moved) object, or NULL if it cannot be resized;
+ * the original object is left intact in that case.
+ */
+struct ncnf_obj_s *_ncnf_obj_reclass(struct ncnf_obj_s *, enum obj_class);
+
+/*
+ * Get the cold part of the object (chains, notifications, user data),
+ * allocating it on first use. Returns NULL if out of memory.
+ */
+struct ncnf_obj_cold_s *_ncnf_obj_cold(struct ncnf_obj_s *);
+
 /*
  * Universal destructor of any type of configuration object.
  */
 void _ncnf_obj_destroy(struct ncnf_obj_s *);
 
+/*
+ * Replace the value of the object, which may already be in the tree.
+ * The reference to the new value is taken over.
+ */
+void _ncnf_obj_set_value(struct ncnf_obj_s *, bstr_t value);
+
 /*
  * Insert an object into an object.
  */
@@ -52,6 +78,6 @@ int _ncnf_attach_obj(struct ncnf_obj_s *to, struct ncnf_obj_s *what, int relaxed
 /*
  * Create a full copy of the given object.
  */
-struct ncnf_obj_s *_ncnf_obj_clone(void *ignore, struct ncnf_obj_s *root);
+struct ncnf_obj_s *_ncnf_obj_clone(void *mr, struct ncnf_obj_s *root);
 
 #endif	/* __NCNF_CONSTR_H__ */
@@ -28,13 +28,22 @@
 #include "headers.h"
 #include "ncnf_int.h"
 #include "ncnf_cr.h"
+#include "ncnf_tpool.h"
 
-int ncnf_cr_parse(void *_param);
+int ncnf_cr_parse(void *scanner, struct ncnf_cr_ctx *);
+int ncnf_cr_lex_init_extra(struct ncnf_cr_ctx *, void **scanner);
+int ncnf_cr_lex_destroy(void *scanner);
+void *ncnf_cr__scan_string(const char *str, void *scanner);
+void *ncnf_cr__scan_buffer(char *base, size_t size, void *scanner);
 
-extern int __ncnf_cr_lineno;
-void ncnf_cr_restart( FILE * );
-void *ncnf_cr__scan_string( const char *str );
-void ncnf_cr__delete_buffer( void *buffer_state );
+#ifndef	MAP_ANONYMOUS
+#define	MAP_ANONYMOUS	MAP_ANON
+#endif
+
+/*
+ * Map the file for scanning in place.
+ */
+static char *_ncnf_cr_map(int fd, size_t size, size_t *map_size);
 
 /*
  * Low-level function to expand insertions and assignments.
@@ -53,11 +62,14 @@ static int _ncnf_cr_check_insertion_loops(struct ncnf_obj_s *, void *refs[], int
  * Read the configuration file and create the objects tree.
  */
 int
-_ncnf_cr_read(const char *cfdata, enum ncnf_source_type stype, struct ncnf_obj_s **root, int relaxed_ns) {
-	FILE *fp;
+_ncnf_cr_read(const char *cfdata, enum ncnf_source_type stype, struct ncnf_obj_s **root, int relaxed_ns, enum ncnf_mr_flags mr_flags, struct ncnf_token_pool *pool) {
+	struct ncnf_cr_ctx ctx;
+	struct stat sb;
+	char *map = NULL;
+	size_t map_size = 0;
+	int fd = -1;		/* Descriptor to read */
+	int own_fd = 0;		/* Close it when done */
 	int ret;
-	void *bstate = NULL;
-	void *parse_param[2];
 
 	if(cfdata == NULL || root == NULL) {
 		errno = EINVAL;
@@ -66,68 +78,197 @@ _ncnf_cr_read(const char *cfdata, enum ncnf_source_type stype, struct ncnf_obj_s
 
 	switch(stype) {
 	case NCNF_ST_TEXT:
-		fp = NULL;
 		break;
 	case NCNF_ST_FILENAME:
-		fp = fopen(cfdata, "r");
-		if(fp) {
-			struct stat sb;
+		fd = open(cfdata, O_RDONLY);
+		if(fd == -1)
+			return -1;
+		own_fd = 1;
 
-			if(fstat(fileno(fp), &sb) == -1) {
-				/* fstat() failed */
-				fclose(fp);
-				return -1;
-			}
-	
-			if((sb.st_mode & S_IFMT) != S_IFREG) {
-				fclose(fp);
-				errno = EIO;
-				return -1;
-			}
-		} else {
+		if(fstat(fd, &sb) == -1) {
+			/* fstat() failed */
+			close(fd);
+			return -1;
+		}
+
+		if((sb.st_mode & S_IFMT) != S_IFREG) {
+			close(fd);
+			errno = EIO;
+			return -1;
+		}
+
+		if(sb.st_size == 0) {
+			/* Nothing to map */
+			close(fd);
+			fd = -1;
+			cfdata = "";
+			break;
+		}
+
+		map = _ncnf_cr_map(fd, sb.st_size, &map_size);
+		if(map) {
+			close(fd);
+			fd = -1;
+		}
+		/* Otherwise, read it in chunks */
+		break;
+	case NCNF_ST_FD: {
+		char *end;
+		long l;
+
+		errno = 0;
+		l = strtol(cfdata, &end, 10);
+		if(errno || end == cfdata || *end || l < 0 || l > INT_MAX) {
+			errno = EINVAL;
 			return -1;
 		}
 
+		fd = l;
+		if(fcntl(fd, F_GETFL) == -1)
+			return -1;	/* EBADF */
+
+		/* Read in chunks, regardless of the descriptor kind */
 		break;
+		}
 	default:
 		assert(!"ncnf_cr_read: invalid stype");
 		errno = EINVAL;
 		return -1;
 	}
 
-	__ncnf_cr_lineno = 1;
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.relaxed_ns = relaxed_ns;
+	ctx.lineno = 1;
+	ctx.fd = fd;
+
+	if(mr_flags != NMR_DISABLED) {
+		ctx.mr = _ncnf_mr_new(mr_flags);
+		if(ctx.mr == NULL) {
+			if(own_fd && fd != -1) close(fd);
+			if(map) munmap(map, map_size);
+			return -1;
+		}
+	}
+
+	if(pool) {
+		ctx.token_pool = pool;
+	} else {
+		/* Tokens go into the region of the tree */
+		ctx.token_pool = _ncnf_tpool_new(ctx.mr, 0);
+		if(ctx.token_pool == NULL) {
+			if(own_fd && fd != -1) close(fd);
+			if(map) munmap(map, map_size);
+			_ncnf_mr_destroy(ctx.mr);
+			return -1;
+		}
+	}
 
 	/*
 	 * Prepare input source for LEX.
 	 */
-	if(fp) {
-		ncnf_cr_restart(fp);
-	} else {
-		bstate = ncnf_cr__scan_string(cfdata);
+	if(ncnf_cr_lex_init_extra(&ctx, &ctx.scanner)) {
+		if(own_fd && fd != -1) close(fd);
+		if(map) munmap(map, map_size);
+		if(ctx.token_pool != pool)
+			_ncnf_tpool_destroy(ctx.token_pool);
+		_ncnf_mr_destroy(ctx.mr);
+		return -1;
+	}
+
+	if(map) {
+		/* The scanner works right on the mapped pages */
+		(void)ncnf_cr__scan_buffer(map, sb.st_size + 2, ctx.scanner);
+	} else if(fd == -1) {
+		(void)ncnf_cr__scan_string(cfdata, ctx.scanner);
 	}
+	/* Otherwise the scanner pulls the data from ctx.fd by itself */
 
 	*root = NULL;
-	parse_param[0] = (void *)root;
-	parse_param[1] = (void *)relaxed_ns;
-	ret = ncnf_cr_parse((void *)parse_param);
+	ret = ncnf_cr_parse(ctx.scanner, &ctx);
 
 	/*
-	 * Destroy input source.
+	 * Destroy input source and the parser state.
 	 */
-	if(fp) fclose(fp);
+	ncnf_cr_lex_destroy(ctx.scanner);
+	if(own_fd && fd != -1) close(fd);
+	if(map) munmap(map, map_size);
+	free(ctx.s_buf);
+
+	/* Tokens are referenced by the tree, if needed */
+	if(ctx.token_pool != pool)
+		_ncnf_tpool_destroy(ctx.token_pool);
+	else
+		/* Forget the tokens of the trees destroyed by now */
+		(void)_ncnf_tpool_trim(pool);
+
+	if(ret == 0 && ctx.input_errno) {
+		/* Input was cut short by a read error */
+		_ncnf_debug_print(1, "Configuration read failed at line %d: %s",
+			ctx.lineno, strerror(ctx.input_errno));
+		if(ctx.root) {
+			_ncnf_mr_set_owner(ctx.mr, ctx.root);
+			_ncnf_obj_destroy(ctx.root);
+		} else {
+			_ncnf_mr_destroy(ctx.mr);
+		}
+		errno = ctx.input_errno;
+		return -1;
+	}
 
 	if(ret) {
-		if(*root)
+		if(ctx.root)
 			perror("ncnf root defined after failure!");
+		_ncnf_mr_destroy(ctx.mr);
+		if(ctx.input_errno) {
+			errno = ctx.input_errno;
+			return -1;
+		}
 		return 1;
 	}
 
-	assert(*root);
+	assert(ctx.root);
+
+	/* The tree root holds the whole region */
+	_ncnf_mr_set_owner(ctx.mr, ctx.root);
+
+	*root = ctx.root;
 
 	return 0;
 }
 
 
+/*
+ * flex scans a buffer in place if it is writable and ends with two
+ * NUL characters. The file is mapped privately over an anonymous
+ * reservation that is at least two bytes longer than the file, so
+ * the terminators come from the zero-filled tail of the mapping
+ * and the file itself is never copied up front.
+ */
+static char *
+_ncnf_cr_map(int fd, size_t size, size_t *map_size) {
+	size_t page = sysconf(_SC_PAGESIZE);
+	size_t len = (size + 2 + page - 1) & ~(page - 1);
+	char *base;
+
+	base = mmap(NULL, len, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(base == MAP_FAILED)
+		return NULL;
+
+	if(mmap(base, size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+		munmap(base, len);
+		return NULL;
+	}
+
+#ifdef	MADV_SEQUENTIAL
+	(void)madvise(base, size, MADV_SEQUENTIAL);
+#endif
+
+	*map_size = len;
+	return base;
+}
+
 
 /*
  * If we have an insertion, copy the contents of the referred object
@@ -188,8 +329,9 @@ _ncnf_cr_expand_insert(struct ncnf_obj_s *obj, struct ncnf_obj_s *insert, int re
 				/*
 				 * Don't override local values.
 				 */
-				if(_ncnf_coll_get(&obj->m_collection[c],
-					0, coll->entry[i].object->type,
+				if(_ncnf_coll_get(obj->mr, &obj->m_collection[c],
+					CG_TYPE_ATOM, (const char *)
+					coll->entry[i].object->type_atom,
 					NULL, 0))
 					continue;
 			}
@@ -438,6 +580,13 @@ _ncnf_cr_resolve_references(struct ncnf_obj_s *root,
 
 
 
+int
+_ncnf_cr_resolve_object(struct ncnf_obj_s *obj,
+	int (*func)(struct ncnf_obj_s *ref, int invocation)) {
+	return __ncnf_cr_resolve_assignment(obj, func, 0);
+}
+
+
 static int
 __ncnf_cr_ra_callback(struct ncnf_obj_s *obj, void *key) {
 	int (*func)(struct ncnf_obj_s *ref, int invocation) = key;
@@ -548,8 +697,8 @@ __ncnf_cr_resolve_assignment(struct ncnf_obj_s *obj, int (*func)(struct ncnf_obj
 			assert((resolved_attr->m_attr_flags & 1) == 0);
 		}
 
-		bstr_free(obj->value);
-		obj->value = bstr_ref(resolved_attr->value);
+		_ncnf_obj_set_value(obj,
+			_ncnf_mr_strref(obj->mr, resolved_attr->value));
 		obj->m_attr_flags &= ~1;
 	}
 
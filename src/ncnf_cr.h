@@ -29,14 +29,42 @@
 #define	__NCNF_CR_H__
 
 #include "ncnf.h"
+#include "ncnf_mr.h"
+
+/*
+ * Parser state of a single _ncnf_cr_read() invocation,
+ * shared by the scanner and the parser.
+ */
+struct ncnf_cr_ctx {
+	void *scanner;			/* Reentrant scanner instance */
+	struct ncnf_obj_s *root;	/* Resulting tree */
+	int relaxed_ns;			/* Do not check for duplicates */
+	void *mr;			/* Memory region for the tree */
+	int lineno;			/* Current line */
+
+	/* Buffer for the multiline strings */
+	char *s_buf;
+	int s_buf_len;
+	int s_buf_size;
+
+	struct ncnf_token_pool *token_pool;	/* Interned tokens */
+
+	int fd;				/* Descriptor to read, or -1 */
+	int input_errno;		/* read() failure */
+};
 
 /*
  * Read the configuration file.
+ * The tree is allocated inside the new memory region (see ncnf_mr.h),
+ * unless mr_flags is NMR_DISABLED.
+ * The tokens are interned in the given pool (see ncnf_tpool.h),
+ * or in a private one if the pool is NULL.
  * Returns 0 if all OK, -1 if file open error or 1 if parse error.
  */
 
 int _ncnf_cr_read(const char *cfname, enum ncnf_source_type,
-	struct ncnf_obj_s **root, int relaxed_namespace);
+	struct ncnf_obj_s **root, int relaxed_namespace,
+	enum ncnf_mr_flags mr_flags, struct ncnf_token_pool *pool);
 
 
 /*
@@ -55,4 +83,11 @@ int _ncnf_cr_resolve(struct ncnf_obj_s *root, int relaxed_namespace);
 int _ncnf_cr_resolve_references(struct ncnf_obj_s *root,
 	int (*func)(struct ncnf_obj_s *ref, int invocation));
 
+/*
+ * Same as above, but for the single reference or attribute,
+ * not descending into the objects.
+ */
+int _ncnf_cr_resolve_object(struct ncnf_obj_s *obj,
+	int (*func)(struct ncnf_obj_s *ref, int invocation));
+
 #endif /* __NCNF_CR_H__ */
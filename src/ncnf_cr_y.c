@@ -1,1280 +0,0 @@
-
-/*  A Bison parser, made from ncnf_cr_y.y
-    by GNU Bison version 1.28  */
-
-#define YYBISON 1  /* Identify Bison output.  */
-
-#define yyparse ncnf_cr_parse
-#define yylex ncnf_cr_lex
-#define yyerror ncnf_cr_error
-#define yylval ncnf_cr_lval
-#define yychar ncnf_cr_char
-#define yydebug ncnf_cr_debug
-#define yynerrs ncnf_cr_nerrs
-#define	TOK_NAME	257
-#define	TOK_STRING	258
-#define	ERROR	259
-#define	AT	260
-#define	SEMICOLON	261
-#define	INSERT	262
-#define	INHERIT	263
-#define	REF	264
-#define	ATTACH	265
-
-#line 28 "ncnf_cr_y.y"
-
-
-#undef	NDEBUG
-#include "headers.h"
-#include "ncnf_int.h"
-#include "ncnf.h"
-
-#define	YYPARSE_PARAM	paramp
-
-int yylex(void);
-int yyerror(char *s);
-
-extern int __ncnf_cr_lineno;
-
-#define	RELAXED_NS		((int)*((void **)YYPARSE_PARAM+1))
-#define	ALLOC_NOBJ(_class)	_ncnf_obj_new(0, _class, NULL, NULL, __ncnf_cr_lineno)
-
-
-/*
- * Quick wrapper around object attachment.
- */
-#define	ATTACH_OBJ(dst,src) do {				\
-		if(_ncnf_attach_obj(dst, src, RELAXED_NS)) {	\
-			int lineno = src->config_line;		\
-			_ncnf_obj_destroy(src);			\
-			_ncnf_obj_destroy(dst);			\
-			dst = NULL;				\
-			if(errno == EEXIST) {			\
-			__ncnf_cr_lineno = lineno;		\
-			yyerror("Similarly named entity already defined"); \
-			}					\
-			YYABORT;				\
-		}						\
-	} while(0)
-
-
-#line 68 "ncnf_cr_y.y"
-typedef union {
-	int tv_int;
-	bstr_t tv_str;
-	struct ncnf_obj_s *tv_obj;
-} YYSTYPE;
-#include <stdio.h>
-
-#ifndef __cplusplus
-#ifndef __STDC__
-#define const
-#endif
-#endif
-
-
-
-#define	YYFINAL		45
-#define	YYFLAG		-32768
-#define	YYNTBASE	15
-
-#define YYTRANSLATE(x) ((unsigned)(x) <= 265 ? yytranslate[x] : 25)
-
-static const char yytranslate[] = {     0,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-    14,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,    12,     2,    13,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-     2,     2,     2,     2,     2,     1,     3,     4,     5,     6,
-     7,     8,     9,    10,    11
-};
-
-#if YYDEBUG != 0
-static const short yyprhs[] = {     0,
-     0,     1,     3,     4,     6,     9,    13,    15,    18,    21,
-    24,    28,    33,    35,    39,    42,    45,    52,    58,    63,
-    69,    71,    73
-};
-
-static const short yyrhs[] = {    -1,
-    17,     0,     0,     7,     0,    18,    16,     0,    17,    18,
-    16,     0,    19,     0,    20,     7,     0,    21,     7,     0,
-    22,     7,     0,    24,    12,    13,     0,    24,    12,    17,
-    13,     0,    24,     0,     3,    14,     3,     0,     8,    24,
-     0,     9,    24,     0,    23,     3,     4,    14,     3,     4,
-     0,    23,     3,    14,     3,     4,     0,    23,    14,     3,
-     4,     0,    23,     3,     4,    14,     4,     0,    10,     0,
-    11,     0,     3,     4,     0
-};
-
-#endif
-
-#if YYDEBUG != 0
-static const short yyrline[] = { 0,
-    99,   104,   129,   130,   132,   150,   194,   196,   197,   198,
-   201,   208,   246,   253,   265,   272,   281,   294,   306,   318,
-   332,   336,   341
-};
-#endif
-
-
-#if YYDEBUG != 0 || defined (YYERROR_VERBOSE)
-
-static const char * const yytname[] = {   "$","error","$undefined.","TOK_NAME",
-"TOK_STRING","ERROR","AT","SEMICOLON","INSERT","INHERIT","REF","ATTACH","'{'",
-"'}'","'='","cfg_file","ps","sequence","block","object","attribute","insertion",
-"reference","reftype","entity", NULL
-};
-#endif
-
-static const short yyr1[] = {     0,
-    15,    15,    16,    16,    17,    17,    18,    18,    18,    18,
-    19,    19,    20,    20,    21,    21,    22,    22,    22,    22,
-    23,    23,    24
-};
-
-static const short yyr2[] = {     0,
-     0,     1,     0,     1,     2,     3,     1,     2,     2,     2,
-     3,     4,     1,     3,     2,     2,     6,     5,     4,     5,
-     1,     1,     2
-};
-
-static const short yydefact[] = {     1,
-     0,     0,     0,    21,    22,     2,     3,     7,     0,     0,
-     0,     0,    13,    23,     0,     0,    15,    16,     3,     4,
-     5,     8,     9,    10,     0,     0,     0,    14,     6,     0,
-     0,     0,    11,     0,     0,     0,    19,    12,     0,    20,
-    18,    17,     0,     0,     0
-};
-
-static const short yydefgoto[] = {    43,
-    21,     6,     7,     8,     9,    10,    11,    12,    13
-};
-
-static const short yypact[] = {    22,
-     1,    -1,    -1,-32768,-32768,    22,    -3,-32768,    16,    27,
-    28,    -2,    -5,-32768,    26,    32,-32768,-32768,    -3,-32768,
--32768,-32768,-32768,-32768,     2,    34,     0,-32768,-32768,    25,
-    35,    36,-32768,    11,    14,    37,-32768,-32768,    38,-32768,
--32768,-32768,    43,    44,-32768
-};
-
-static const short yypgoto[] = {-32768,
-    29,    18,    -6,-32768,-32768,-32768,-32768,-32768,    24
-};
-
-
-#define	YYLAST		48
-
-
-static const short yytable[] = {    19,
-    25,    16,     1,    20,    14,    30,    27,     2,     3,     4,
-     5,    26,    33,     1,    15,    31,    39,    40,     2,     3,
-     4,     5,    22,    38,     1,    17,    18,    19,    28,     2,
-     3,     4,     5,    23,    24,    14,    32,    36,    35,    37,
-    41,    42,    44,    45,    34,     0,     0,    29
-};
-
-static const short yycheck[] = {     6,
-     3,     3,     3,     7,     4,     4,    12,     8,     9,    10,
-    11,    14,    13,     3,    14,    14,     3,     4,     8,     9,
-    10,    11,     7,    13,     3,     2,     3,    34,     3,     8,
-     9,    10,    11,     7,     7,     4,     3,     3,    14,     4,
-     4,     4,     0,     0,    27,    -1,    -1,    19
-};
-/* -*-C-*-  Note some compilers choke on comments on `#line' lines.  */
-#line 3 "/usr/share/bison.simple"
-/* This file comes from bison-1.28.  */
-
-/* Skeleton output parser for bison,
-   Copyright (C) 1984, 1989, 1990 Free Software Foundation, Inc.
-
-   This program is free software; you can redistribute it and/or modify
-   it under the terms of the GNU General Public License as published by
-   the Free Software Foundation; either version 2, or (at your option)
-   any later version.
-
-   This program is distributed in the hope that it will be useful,
-   but WITHOUT ANY WARRANTY; without even the implied warranty of
-   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-   GNU General Public License for more details.
-
-   You should have received a copy of the GNU General Public License
-   along with this program; if not, write to the Free Software
-   Foundation, Inc., 59 Temple Place - Suite 330,
-   Boston, MA 02111-1307, USA.  */
-
-/* As a special exception, when this file is copied by Bison into a
-   Bison output file, you may use that output file without restriction.
-   This special exception was added by the Free Software Foundation
-   in version 1.24 of Bison.  */
-
-/* This is the parser code that is written into each bison parser
-  when the %semantic_parser declaration is not specified in the grammar.
-  It was written by Richard Stallman by simplifying the hairy parser
-  used when %semantic_parser is specified.  */
-
-#ifndef YYSTACK_USE_ALLOCA
-#ifdef alloca
-#define YYSTACK_USE_ALLOCA
-#else /* alloca not defined */
-#ifdef __GNUC__
-#define YYSTACK_USE_ALLOCA
-#define alloca __builtin_alloca
-#else /* not GNU C.  */
-#if (!defined (__STDC__) && defined (sparc)) || defined (__sparc__) || defined (__sparc) || defined (__sgi) || (defined (__sun) && defined (__i386))
-#define YYSTACK_USE_ALLOCA
-#include <alloca.h>
-#else /* not sparc */
-/* We think this test detects Watcom and Microsoft C.  */
-/* This used to test MSDOS, but that is a bad idea
-   since that symbol is in the user namespace.  */
-#if (defined (_MSDOS) || defined (_MSDOS_)) && !defined (__TURBOC__)
-#if 0 /* No need for malloc.h, which pollutes the namespace;
-	 instead, just don't use alloca.  */
-#include <malloc.h>
-#endif
-#else /* not MSDOS, or __TURBOC__ */
-#if defined(_AIX)
-/* I don't know what this was needed for, but it pollutes the namespace.
-   So I turned it off.   rms, 2 May 1997.  */
-/* #include <malloc.h>  */
- #pragma alloca
-#define YYSTACK_USE_ALLOCA
-#else /* not MSDOS, or __TURBOC__, or _AIX */
-#if 0
-#ifdef __hpux /* haible@ilog.fr says this works for HPUX 9.05 and up,
-		 and on HPUX 10.  Eventually we can turn this on.  */
-#define YYSTACK_USE_ALLOCA
-#define alloca __builtin_alloca
-#endif /* __hpux */
-#endif
-#endif /* not _AIX */
-#endif /* not MSDOS, or __TURBOC__ */
-#endif /* not sparc */
-#endif /* not GNU C */
-#endif /* alloca not defined */
-#endif /* YYSTACK_USE_ALLOCA not defined */
-
-#ifdef YYSTACK_USE_ALLOCA
-#define YYSTACK_ALLOC alloca
-#else
-#define YYSTACK_ALLOC malloc
-#endif
-
-/* Note: there must be only one dollar sign in this file.
-   It is replaced by the list of actions, each action
-   as one case of the switch.  */
-
-#define yyerrok		(yyerrstatus = 0)
-#define yyclearin	(yychar = YYEMPTY)
-#define YYEMPTY		-2
-#define YYEOF		0
-#define YYACCEPT	goto yyacceptlab
-#define YYABORT 	goto yyabortlab
-#define YYERROR		goto yyerrlab1
-/* Like YYERROR except do call yyerror.
-   This remains here temporarily to ease the
-   transition to the new meaning of YYERROR, for GCC.
-   Once GCC version 2 has supplanted version 1, this can go.  */
-#define YYFAIL		goto yyerrlab
-#define YYRECOVERING()  (!!yyerrstatus)
-#define YYBACKUP(token, value) \
-do								\
-  if (yychar == YYEMPTY && yylen == 1)				\
-    { yychar = (token), yylval = (value);			\
-      yychar1 = YYTRANSLATE (yychar);				\
-      YYPOPSTACK;						\
-      goto yybackup;						\
-    }								\
-  else								\
-    { yyerror ("syntax error: cannot back up"); YYERROR; }	\
-while (0)
-
-#define YYTERROR	1
-#define YYERRCODE	256
-
-#ifndef YYPURE
-#define YYLEX		yylex()
-#endif
-
-#ifdef YYPURE
-#ifdef YYLSP_NEEDED
-#ifdef YYLEX_PARAM
-#define YYLEX		yylex(&yylval, &yylloc, YYLEX_PARAM)
-#else
-#define YYLEX		yylex(&yylval, &yylloc)
-#endif
-#else /* not YYLSP_NEEDED */
-#ifdef YYLEX_PARAM
-#define YYLEX		yylex(&yylval, YYLEX_PARAM)
-#else
-#define YYLEX		yylex(&yylval)
-#endif
-#endif /* not YYLSP_NEEDED */
-#endif
-
-/* If nonreentrant, generate the variables here */
-
-#ifndef YYPURE
-
-int	yychar;			/*  the lookahead symbol		*/
-YYSTYPE	yylval;			/*  the semantic value of the		*/
-				/*  lookahead symbol			*/
-
-#ifdef YYLSP_NEEDED
-YYLTYPE yylloc;			/*  location data for the lookahead	*/
-				/*  symbol				*/
-#endif
-
-int yynerrs;			/*  number of parse errors so far       */
-#endif  /* not YYPURE */
-
-#if YYDEBUG != 0
-int yydebug;			/*  nonzero means print parse trace	*/
-/* Since this is uninitialized, it does not stop multiple parsers
-   from coexisting.  */
-#endif
-
-/*  YYINITDEPTH indicates the initial size of the parser's stacks	*/
-
-#ifndef	YYINITDEPTH
-#define YYINITDEPTH 200
-#endif
-
-/*  YYMAXDEPTH is the maximum size the stacks can grow to
-    (effective only if the built-in stack extension method is used).  */
-
-#if YYMAXDEPTH == 0
-#undef YYMAXDEPTH
-#endif
-
-#ifndef YYMAXDEPTH
-#define YYMAXDEPTH 10000
-#endif
-
-/* Define __yy_memcpy.  Note that the size argument
-   should be passed with type unsigned int, because that is what the non-GCC
-   definitions require.  With GCC, __builtin_memcpy takes an arg
-   of type size_t, but it can handle unsigned int.  */
-
-#if __GNUC__ > 1		/* GNU C and GNU C++ define this.  */
-#define __yy_memcpy(TO,FROM,COUNT)	__builtin_memcpy(TO,FROM,COUNT)
-#else				/* not GNU C or C++ */
-#ifndef __cplusplus
-
-/* This is the most reliable way to avoid incompatibilities
-   in available built-in functions on various systems.  */
-static void
-__yy_memcpy (to, from, count)
-     char *to;
-     char *from;
-     unsigned int count;
-{
-  register char *f = from;
-  register char *t = to;
-  register int i = count;
-
-  while (i-- > 0)
-    *t++ = *f++;
-}
-
-#else /* __cplusplus */
-
-/* This is the most reliable way to avoid incompatibilities
-   in available built-in functions on various systems.  */
-static void
-__yy_memcpy (char *to, char *from, unsigned int count)
-{
-  register char *t = to;
-  register char *f = from;
-  register int i = count;
-
-  while (i-- > 0)
-    *t++ = *f++;
-}
-
-#endif
-#endif
-
-#line 217 "/usr/share/bison.simple"
-
-/* The user can define YYPARSE_PARAM as the name of an argument to be passed
-   into yyparse.  The argument should have type void *.
-   It should actually point to an object.
-   Grammar actions can access the variable by casting it
-   to the proper pointer type.  */
-
-#ifdef YYPARSE_PARAM
-#ifdef __cplusplus
-#define YYPARSE_PARAM_ARG void *YYPARSE_PARAM
-#define YYPARSE_PARAM_DECL
-#else /* not __cplusplus */
-#define YYPARSE_PARAM_ARG YYPARSE_PARAM
-#define YYPARSE_PARAM_DECL void *YYPARSE_PARAM;
-#endif /* not __cplusplus */
-#else /* not YYPARSE_PARAM */
-#define YYPARSE_PARAM_ARG
-#define YYPARSE_PARAM_DECL
-#endif /* not YYPARSE_PARAM */
-
-/* Prevent warning if -Wstrict-prototypes.  */
-#ifdef __GNUC__
-#ifdef YYPARSE_PARAM
-int yyparse (void *);
-#else
-int yyparse (void);
-#endif
-#endif
-
-int
-yyparse(YYPARSE_PARAM_ARG)
-     YYPARSE_PARAM_DECL
-{
-  register int yystate;
-  register int yyn;
-  register short *yyssp;
-  register YYSTYPE *yyvsp;
-  int yyerrstatus;	/*  number of tokens to shift before error messages enabled */
-  int yychar1 = 0;		/*  lookahead token as an internal (translated) token number */
-
-  short	yyssa[YYINITDEPTH];	/*  the state stack			*/
-  YYSTYPE yyvsa[YYINITDEPTH];	/*  the semantic value stack		*/
-
-  short *yyss = yyssa;		/*  refer to the stacks thru separate pointers */
-  YYSTYPE *yyvs = yyvsa;	/*  to allow yyoverflow to reallocate them elsewhere */
-
-#ifdef YYLSP_NEEDED
-  YYLTYPE yylsa[YYINITDEPTH];	/*  the location stack			*/
-  YYLTYPE *yyls = yylsa;
-  YYLTYPE *yylsp;
-
-#define YYPOPSTACK   (yyvsp--, yyssp--, yylsp--)
-#else
-#define YYPOPSTACK   (yyvsp--, yyssp--)
-#endif
-
-  int yystacksize = YYINITDEPTH;
-  int yyfree_stacks = 0;
-
-#ifdef YYPURE
-  int yychar;
-  YYSTYPE yylval;
-  int yynerrs;
-#ifdef YYLSP_NEEDED
-  YYLTYPE yylloc;
-#endif
-#endif
-
-  YYSTYPE yyval;		/*  the variable used to return		*/
-				/*  semantic values from the action	*/
-				/*  routines				*/
-
-  int yylen;
-
-#if YYDEBUG != 0
-  if (yydebug)
-    fprintf(stderr, "Starting parse\n");
-#endif
-
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
-  yychar = YYEMPTY;		/* Cause a token to be read.  */
-
-  /* Initialize stack pointers.
-     Waste one element of value and location stack
-     so that they stay on the same level as the state stack.
-     The wasted elements are never initialized.  */
-
-  yyssp = yyss - 1;
-  yyvsp = yyvs;
-#ifdef YYLSP_NEEDED
-  yylsp = yyls;
-#endif
-
-/* Push a new state, which is found in  yystate  .  */
-/* In all cases, when you get here, the value and location stacks
-   have just been pushed. so pushing a state here evens the stacks.  */
-yynewstate:
-
-  *++yyssp = yystate;
-
-  if (yyssp >= yyss + yystacksize - 1)
-    {
-      /* Give user a chance to reallocate the stack */
-      /* Use copies of these so that the &'s don't force the real ones into memory. */
-      YYSTYPE *yyvs1 = yyvs;
-      short *yyss1 = yyss;
-#ifdef YYLSP_NEEDED
-      YYLTYPE *yyls1 = yyls;
-#endif
-
-      /* Get the current used size of the three stacks, in elements.  */
-      int size = yyssp - yyss + 1;
-
-#ifdef yyoverflow
-      /* Each stack pointer address is followed by the size of
-	 the data in use in that stack, in bytes.  */
-#ifdef YYLSP_NEEDED
-      /* This used to be a conditional around just the two extra args,
-	 but that might be undefined if yyoverflow is a macro.  */
-      yyoverflow("parser stack overflow",
-		 &yyss1, size * sizeof (*yyssp),
-		 &yyvs1, size * sizeof (*yyvsp),
-		 &yyls1, size * sizeof (*yylsp),
-		 &yystacksize);
-#else
-      yyoverflow("parser stack overflow",
-		 &yyss1, size * sizeof (*yyssp),
-		 &yyvs1, size * sizeof (*yyvsp),
-		 &yystacksize);
-#endif
-
-      yyss = yyss1; yyvs = yyvs1;
-#ifdef YYLSP_NEEDED
-      yyls = yyls1;
-#endif
-#else /* no yyoverflow */
-      /* Extend the stack our own way.  */
-      if (yystacksize >= YYMAXDEPTH)
-	{
-	  yyerror("parser stack overflow");
-	  if (yyfree_stacks)
-	    {
-	      free (yyss);
-	      free (yyvs);
-#ifdef YYLSP_NEEDED
-	      free (yyls);
-#endif
-	    }
-	  return 2;
-	}
-      yystacksize *= 2;
-      if (yystacksize > YYMAXDEPTH)
-	yystacksize = YYMAXDEPTH;
-#ifndef YYSTACK_USE_ALLOCA
-      yyfree_stacks = 1;
-#endif
-      yyss = (short *) YYSTACK_ALLOC (yystacksize * sizeof (*yyssp));
-      __yy_memcpy ((char *)yyss, (char *)yyss1,
-		   size * (unsigned int) sizeof (*yyssp));
-      yyvs = (YYSTYPE *) YYSTACK_ALLOC (yystacksize * sizeof (*yyvsp));
-      __yy_memcpy ((char *)yyvs, (char *)yyvs1,
-		   size * (unsigned int) sizeof (*yyvsp));
-#ifdef YYLSP_NEEDED
-      yyls = (YYLTYPE *) YYSTACK_ALLOC (yystacksize * sizeof (*yylsp));
-      __yy_memcpy ((char *)yyls, (char *)yyls1,
-		   size * (unsigned int) sizeof (*yylsp));
-#endif
-#endif /* no yyoverflow */
-
-      yyssp = yyss + size - 1;
-      yyvsp = yyvs + size - 1;
-#ifdef YYLSP_NEEDED
-      yylsp = yyls + size - 1;
-#endif
-
-#if YYDEBUG != 0
-      if (yydebug)
-	fprintf(stderr, "Stack size increased to %d\n", yystacksize);
-#endif
-
-      if (yyssp >= yyss + yystacksize - 1)
-	YYABORT;
-    }
-
-#if YYDEBUG != 0
-  if (yydebug)
-    fprintf(stderr, "Entering state %d\n", yystate);
-#endif
-
-  goto yybackup;
- yybackup:
-
-/* Do appropriate processing given the current state.  */
-/* Read a lookahead token if we need one and don't already have one.  */
-/* yyresume: */
-
-  /* First try to decide what to do without reference to lookahead token.  */
-
-  yyn = yypact[yystate];
-  if (yyn == YYFLAG)
-    goto yydefault;
-
-  /* Not known => get a lookahead token if don't already have one.  */
-
-  /* yychar is either YYEMPTY or YYEOF
-     or a valid token in external form.  */
-
-  if (yychar == YYEMPTY)
-    {
-#if YYDEBUG != 0
-      if (yydebug)
-	fprintf(stderr, "Reading a token: ");
-#endif
-      yychar = YYLEX;
-    }
-
-  /* Convert token to internal form (in yychar1) for indexing tables with */
-
-  if (yychar <= 0)		/* This means end of input. */
-    {
-      yychar1 = 0;
-      yychar = YYEOF;		/* Don't call YYLEX any more */
-
-#if YYDEBUG != 0
-      if (yydebug)
-	fprintf(stderr, "Now at end of input.\n");
-#endif
-    }
-  else
-    {
-      yychar1 = YYTRANSLATE(yychar);
-
-#if YYDEBUG != 0
-      if (yydebug)
-	{
-	  fprintf (stderr, "Next token is %d (%s", yychar, yytname[yychar1]);
-	  /* Give the individual parser a way to print the precise meaning
-	     of a token, for further debugging info.  */
-#ifdef YYPRINT
-	  YYPRINT (stderr, yychar, yylval);
-#endif
-	  fprintf (stderr, ")\n");
-	}
-#endif
-    }
-
-  yyn += yychar1;
-  if (yyn < 0 || yyn > YYLAST || yycheck[yyn] != yychar1)
-    goto yydefault;
-
-  yyn = yytable[yyn];
-
-  /* yyn is what to do for this token type in this state.
-     Negative => reduce, -yyn is rule number.
-     Positive => shift, yyn is new state.
-       New state is final state => don't bother to shift,
-       just return success.
-     0, or most negative number => error.  */
-
-  if (yyn < 0)
-    {
-      if (yyn == YYFLAG)
-	goto yyerrlab;
-      yyn = -yyn;
-      goto yyreduce;
-    }
-  else if (yyn == 0)
-    goto yyerrlab;
-
-  if (yyn == YYFINAL)
-    YYACCEPT;
-
-  /* Shift the lookahead token.  */
-
-#if YYDEBUG != 0
-  if (yydebug)
-    fprintf(stderr, "Shifting token %d (%s), ", yychar, yytname[yychar1]);
-#endif
-
-  /* Discard the token being shifted unless it is eof.  */
-  if (yychar != YYEOF)
-    yychar = YYEMPTY;
-
-  *++yyvsp = yylval;
-#ifdef YYLSP_NEEDED
-  *++yylsp = yylloc;
-#endif
-
-  /* count tokens shifted since error; after three, turn off error status.  */
-  if (yyerrstatus) yyerrstatus--;
-
-  yystate = yyn;
-  goto yynewstate;
-
-/* Do the default action for the current state.  */
-yydefault:
-
-  yyn = yydefact[yystate];
-  if (yyn == 0)
-    goto yyerrlab;
-
-/* Do a reduction.  yyn is the number of a rule to reduce with.  */
-yyreduce:
-  yylen = yyr2[yyn];
-  if (yylen > 0)
-    yyval = yyvsp[1-yylen]; /* implement default value of the action */
-
-#if YYDEBUG != 0
-  if (yydebug)
-    {
-      int i;
-
-      fprintf (stderr, "Reducing via rule %d (line %d), ",
-	       yyn, yyrline[yyn]);
-
-      /* Print the symbols being reduced, and their result.  */
-      for (i = yyprhs[yyn]; yyrhs[i] > 0; i++)
-	fprintf (stderr, "%s ", yytname[yyrhs[i]]);
-      fprintf (stderr, " -> %s\n", yytname[yyr1[yyn]]);
-    }
-#endif
-
-
-  switch (yyn) {
-
-case 1:
-#line 99 "ncnf_cr_y.y"
-{
-		**(void ***)YYPARSE_PARAM = ALLOC_NOBJ(NOBJ_ROOT);
-		if(**(void ***)YYPARSE_PARAM == NULL)
-			YYABORT;
-	;
-    break;}
-case 2:
-#line 104 "ncnf_cr_y.y"
-{
-		struct ncnf_obj_s *param_value = NULL;
-
-		if(yyvsp[0].tv_obj == NULL) {
-			errno = EINVAL;
-			YYABORT;
-		}
-
-		if(yyvsp[0].tv_obj->obj_class == NOBJ_ROOT) {
-			param_value = yyvsp[0].tv_obj;
-		} else {
-			param_value = ALLOC_NOBJ(NOBJ_ROOT);
-			if(param_value == NULL) {
-				_ncnf_obj_destroy(yyvsp[0].tv_obj);
-				YYABORT;
-			} else {
-				ATTACH_OBJ(param_value, yyvsp[0].tv_obj);
-			}
-		}
-
-		/* Propagate root up to the caller */
-		**(void ***)YYPARSE_PARAM = param_value;
-	;
-    break;}
-case 5:
-#line 132 "ncnf_cr_y.y"
-{
-		if(yyvsp[-1].tv_obj == NULL) {
-			yyval.tv_obj = NULL;
-			yyclearin;
-			yyerrok;
-			break;
-		}
-
-		yyval.tv_obj = ALLOC_NOBJ(NOBJ_ROOT);
-		if(yyval.tv_obj == NULL) {
-			_ncnf_obj_destroy(yyvsp[-1].tv_obj);
-			yyvsp[-1].tv_obj = NULL;
-			yyval.tv_obj = NULL;
-			YYABORT;
-		} else {
-			ATTACH_OBJ(yyval.tv_obj, yyvsp[-1].tv_obj);
-		}
-	;
-    break;}
-case 6:
-#line 150 "ncnf_cr_y.y"
-{
-
-		yyval.tv_obj = NULL;
-		if(yyvsp[-2].tv_obj == NULL) {
-			if(yyvsp[-1].tv_obj) _ncnf_obj_destroy(yyvsp[-1].tv_obj);
-			break;
-		} else if(yyvsp[-1].tv_obj == NULL) {
-			if(yyvsp[-2].tv_obj) _ncnf_obj_destroy(yyvsp[-2].tv_obj);
-			break;
-		}
-
-		if(yyvsp[-2].tv_obj->obj_class == NOBJ_ROOT) {
-			yyval.tv_obj = yyvsp[-2].tv_obj;
-
-			ATTACH_OBJ(yyval.tv_obj, yyvsp[-1].tv_obj);
-		} else {
-			yyval.tv_obj = ALLOC_NOBJ(NOBJ_ROOT);
-			if(yyval.tv_obj == NULL) {
-				_ncnf_obj_destroy(yyvsp[-2].tv_obj);
-				_ncnf_obj_destroy(yyvsp[-1].tv_obj);
-				yyval.tv_obj = NULL;
-				YYABORT;
-			}
-
-			/* Join two blocks under root */
-
-			/* Insert a nested object 1 */
-			if(_ncnf_attach_obj(yyval.tv_obj, yyvsp[-2].tv_obj, RELAXED_NS)) {
-				_ncnf_obj_destroy(yyvsp[-2].tv_obj);
-				_ncnf_obj_destroy(yyvsp[-1].tv_obj);	/* Don't forget */
-				_ncnf_obj_destroy(yyval.tv_obj);
-				yyval.tv_obj = NULL;
-				if(errno == EEXIST)
-					yyerror("Similarly named entity "
-						"already defined");
-				YYABORT;
-			} else {
-				/* Insert object 2 */
-				ATTACH_OBJ(yyval.tv_obj, yyvsp[-1].tv_obj);
-			}
-		}
-	;
-    break;}
-case 7:
-#line 195 "ncnf_cr_y.y"
-{ yyval.tv_obj = yyvsp[0].tv_obj; ;
-    break;}
-case 8:
-#line 196 "ncnf_cr_y.y"
-{ yyval.tv_obj = yyvsp[-1].tv_obj; ;
-    break;}
-case 9:
-#line 197 "ncnf_cr_y.y"
-{ yyval.tv_obj = yyvsp[-1].tv_obj; ;
-    break;}
-case 10:
-#line 198 "ncnf_cr_y.y"
-{ yyval.tv_obj = yyvsp[-1].tv_obj; ;
-    break;}
-case 11:
-#line 202 "ncnf_cr_y.y"
-{
-		yyval.tv_obj = yyvsp[-2].tv_obj;
-		if(yyval.tv_obj) {
-			yyval.tv_obj->obj_class = NOBJ_COMPLEX;
-		}
-	;
-    break;}
-case 12:
-#line 208 "ncnf_cr_y.y"
-{
-		int c;
-
-		yyval.tv_obj = NULL;
-		if(yyvsp[-3].tv_obj == NULL) {
-			if(yyvsp[-1].tv_obj) _ncnf_obj_destroy(yyvsp[-1].tv_obj);
-			break;
-		} else if(yyvsp[-1].tv_obj == NULL) {
-			if(yyvsp[-3].tv_obj) _ncnf_obj_destroy(yyvsp[-3].tv_obj);
-			break;
-		}
-
-		assert(yyvsp[-1].tv_obj->obj_class == NOBJ_ROOT);
-
-		yyval.tv_obj = yyvsp[-3].tv_obj;
-		yyval.tv_obj->obj_class = NOBJ_COMPLEX;
-		
-		for(c = 0; c < MAX_COLLECTIONS; c++) {
-			collection_t *coll_to = &(yyval.tv_obj)->m_collection[c];
-			collection_t *coll_from = &(yyvsp[-1].tv_obj)->m_collection[c];
-			if(_ncnf_coll_join((yyval.tv_obj)->mr,
-				coll_to, coll_from, yyval.tv_obj,
-				(RELAXED_NS ? MERGE_NOFLAGS : MERGE_DUPCHECK)
-				| MERGE_EMPTYSRC))
-				break;
-		}
-
-		/* Dispose the NCNF_ROOT wrapper around $3 */
-		_ncnf_obj_destroy(yyvsp[-1].tv_obj);
-
-		if(c < MAX_COLLECTIONS) {
-			_ncnf_obj_destroy(yyval.tv_obj);
-			yyval.tv_obj = NULL;
-			YYABORT;
-		}
-	;
-    break;}
-case 13:
-#line 247 "ncnf_cr_y.y"
-{
-		yyval.tv_obj = yyvsp[0].tv_obj;
-		if(yyval.tv_obj) {
-			yyval.tv_obj->obj_class = NOBJ_ATTRIBUTE;
-		}
-	;
-    break;}
-case 14:
-#line 253 "ncnf_cr_y.y"
-{
-		yyval.tv_obj = ALLOC_NOBJ(NOBJ_ATTRIBUTE);
-		if(yyval.tv_obj) {
-			yyval.tv_obj->type = bstr_ref(yyvsp[-2].tv_str);
-			yyval.tv_obj->value = bstr_ref(yyvsp[0].tv_str);
-			yyval.tv_obj->m_attr_flags |= 1;
-		} else {
-			YYABORT;
-		}
-	;
-    break;}
-case 15:
-#line 266 "ncnf_cr_y.y"
-{
-		yyval.tv_obj = yyvsp[0].tv_obj;
-		if(yyval.tv_obj) {
-			yyval.tv_obj->obj_class = NOBJ_INSERTION;
-		}
-	;
-    break;}
-case 16:
-#line 272 "ncnf_cr_y.y"
-{
-		yyval.tv_obj = yyvsp[0].tv_obj;
-		if(yyval.tv_obj) {
-			yyval.tv_obj->obj_class = NOBJ_INSERTION;
-			yyval.tv_obj->m_insert_flags |= 1;
-		}
-	;
-    break;}
-case 17:
-#line 282 "ncnf_cr_y.y"
-{
-		yyval.tv_obj = ALLOC_NOBJ(NOBJ_REFERENCE);
-		if(yyval.tv_obj) {
-			yyval.tv_obj->type = bstr_ref(yyvsp[-4].tv_str);
-			yyval.tv_obj->value = bstr_ref(yyvsp[-3].tv_str);
-			yyval.tv_obj->m_ref_type = bstr_ref(yyvsp[-1].tv_str);
-			yyval.tv_obj->m_ref_value = bstr_ref(yyvsp[0].tv_str);
-			yyval.tv_obj->m_ref_flags = yyvsp[-5].tv_int;
-		} else {
-			YYABORT;
-		}
-	;
-    break;}
-case 18:
-#line 294 "ncnf_cr_y.y"
-{
-		yyval.tv_obj = ALLOC_NOBJ(NOBJ_REFERENCE);
-		if(yyval.tv_obj) {
-			yyval.tv_obj->type = bstr_ref(yyvsp[-3].tv_str);
-			yyval.tv_obj->value = bstr_ref(yyvsp[0].tv_str);
-			yyval.tv_obj->m_ref_type = bstr_ref(yyvsp[-1].tv_str);
-			yyval.tv_obj->m_ref_value = bstr_ref(yyvsp[0].tv_str);
-			yyval.tv_obj->m_ref_flags = yyvsp[-4].tv_int;
-		} else {
-			YYABORT;
-		}
-	;
-    break;}
-case 19:
-#line 306 "ncnf_cr_y.y"
-{
-                yyval.tv_obj = ALLOC_NOBJ(NOBJ_REFERENCE);
-                if(yyval.tv_obj) {
-                        yyval.tv_obj->type = bstr_ref(yyvsp[-1].tv_str);
-                        yyval.tv_obj->value = bstr_ref(yyvsp[0].tv_str);
-                        yyval.tv_obj->m_ref_type = bstr_ref(yyvsp[-1].tv_str);
-                        yyval.tv_obj->m_ref_value = bstr_ref(yyvsp[0].tv_str);
-                        yyval.tv_obj->m_ref_flags = yyvsp[-3].tv_int;
-                } else {
-			YYABORT;
-                }
-	;
-    break;}
-case 20:
-#line 318 "ncnf_cr_y.y"
-{
-                yyval.tv_obj = ALLOC_NOBJ(NOBJ_REFERENCE);
-                if(yyval.tv_obj) {
-                        yyval.tv_obj->type = bstr_ref(yyvsp[-3].tv_str);
-                        yyval.tv_obj->value = bstr_ref(yyvsp[-2].tv_str);
-                        yyval.tv_obj->m_ref_type = bstr_ref(yyvsp[-3].tv_str);
-                        yyval.tv_obj->m_ref_value = bstr_ref(yyvsp[0].tv_str);
-                        yyval.tv_obj->m_ref_flags = yyvsp[-4].tv_int;
-                } else {
-			YYABORT;
-                }
-	;
-    break;}
-case 21:
-#line 333 "ncnf_cr_y.y"
-{
-		yyval.tv_int = 0;
-	;
-    break;}
-case 22:
-#line 336 "ncnf_cr_y.y"
-{
-		yyval.tv_int = 1;
-	;
-    break;}
-case 23:
-#line 342 "ncnf_cr_y.y"
-{
-		yyval.tv_obj = ALLOC_NOBJ(-2);
-		if(yyval.tv_obj) {
-			yyval.tv_obj->type = bstr_ref(yyvsp[-1].tv_str);
-			yyval.tv_obj->value = bstr_ref(yyvsp[0].tv_str);
-		} else {
-			YYABORT;
-		}
-	;
-    break;}
-}
-   /* the action file gets copied in in place of this dollarsign */
-#line 543 "/usr/share/bison.simple"
-
-  yyvsp -= yylen;
-  yyssp -= yylen;
-#ifdef YYLSP_NEEDED
-  yylsp -= yylen;
-#endif
-
-#if YYDEBUG != 0
-  if (yydebug)
-    {
-      short *ssp1 = yyss - 1;
-      fprintf (stderr, "state stack now");
-      while (ssp1 != yyssp)
-	fprintf (stderr, " %d", *++ssp1);
-      fprintf (stderr, "\n");
-    }
-#endif
-
-  *++yyvsp = yyval;
-
-#ifdef YYLSP_NEEDED
-  yylsp++;
-  if (yylen == 0)
-    {
-      yylsp->first_line = yylloc.first_line;
-      yylsp->first_column = yylloc.first_column;
-      yylsp->last_line = (yylsp-1)->last_line;
-      yylsp->last_column = (yylsp-1)->last_column;
-      yylsp->text = 0;
-    }
-  else
-    {
-      yylsp->last_line = (yylsp+yylen-1)->last_line;
-      yylsp->last_column = (yylsp+yylen-1)->last_column;
-    }
-#endif
-
-  /* Now "shift" the result of the reduction.
-     Determine what state that goes to,
-     based on the state we popped back to
-     and the rule number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTBASE] + *yyssp;
-  if (yystate >= 0 && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTBASE];
-
-  goto yynewstate;
-
-yyerrlab:   /* here on detecting error */
-
-  if (! yyerrstatus)
-    /* If not already recovering from an error, report this error.  */
-    {
-      ++yynerrs;
-
-#ifdef YYERROR_VERBOSE
-      yyn = yypact[yystate];
-
-      if (yyn > YYFLAG && yyn < YYLAST)
-	{
-	  int size = 0;
-	  char *msg;
-	  int x, count;
-
-	  count = 0;
-	  /* Start X at -yyn if nec to avoid negative indexes in yycheck.  */
-	  for (x = (yyn < 0 ? -yyn : 0);
-	       x < (sizeof(yytname) / sizeof(char *)); x++)
-	    if (yycheck[x + yyn] == x)
-	      size += strlen(yytname[x]) + 15, count++;
-	  msg = (char *) malloc(size + 15);
-	  if (msg != 0)
-	    {
-	      strcpy(msg, "parse error");
-
-	      if (count < 5)
-		{
-		  count = 0;
-		  for (x = (yyn < 0 ? -yyn : 0);
-		       x < (sizeof(yytname) / sizeof(char *)); x++)
-		    if (yycheck[x + yyn] == x)
-		      {
-			strcat(msg, count == 0 ? ", expecting `" : " or `");
-			strcat(msg, yytname[x]);
-			strcat(msg, "'");
-			count++;
-		      }
-		}
-	      yyerror(msg);
-	      free(msg);
-	    }
-	  else
-	    yyerror ("parse error; also virtual memory exceeded");
-	}
-      else
-#endif /* YYERROR_VERBOSE */
-	yyerror("parse error");
-    }
-
-  goto yyerrlab1;
-yyerrlab1:   /* here on error raised explicitly by an action */
-
-  if (yyerrstatus == 3)
-    {
-      /* if just tried and failed to reuse lookahead token after an error, discard it.  */
-
-      /* return failure if at end of input */
-      if (yychar == YYEOF)
-	YYABORT;
-
-#if YYDEBUG != 0
-      if (yydebug)
-	fprintf(stderr, "Discarding token %d (%s).\n", yychar, yytname[yychar1]);
-#endif
-
-      yychar = YYEMPTY;
-    }
-
-  /* Else will try to reuse lookahead token
-     after shifting the error token.  */
-
-  yyerrstatus = 3;		/* Each real token shifted decrements this */
-
-  goto yyerrhandle;
-
-yyerrdefault:  /* current state does not do anything special for the error token. */
-
-#if 0
-  /* This is wrong; only states that explicitly want error tokens
-     should shift them.  */
-  yyn = yydefact[yystate];  /* If its default is to accept any token, ok.  Otherwise pop it.*/
-  if (yyn) goto yydefault;
-#endif
-
-yyerrpop:   /* pop the current state because it cannot handle the error token */
-
-  if (yyssp == yyss) YYABORT;
-  yyvsp--;
-  yystate = *--yyssp;
-#ifdef YYLSP_NEEDED
-  yylsp--;
-#endif
-
-#if YYDEBUG != 0
-  if (yydebug)
-    {
-      short *ssp1 = yyss - 1;
-      fprintf (stderr, "Error: state stack now");
-      while (ssp1 != yyssp)
-	fprintf (stderr, " %d", *++ssp1);
-      fprintf (stderr, "\n");
-    }
-#endif
-
-yyerrhandle:
-
-  yyn = yypact[yystate];
-  if (yyn == YYFLAG)
-    goto yyerrdefault;
-
-  yyn += YYTERROR;
-  if (yyn < 0 || yyn > YYLAST || yycheck[yyn] != YYTERROR)
-    goto yyerrdefault;
-
-  yyn = yytable[yyn];
-  if (yyn < 0)
-    {
-      if (yyn == YYFLAG)
-	goto yyerrpop;
-      yyn = -yyn;
-      goto yyreduce;
-    }
-  else if (yyn == 0)
-    goto yyerrpop;
-
-  if (yyn == YYFINAL)
-    YYACCEPT;
-
-#if YYDEBUG != 0
-  if (yydebug)
-    fprintf(stderr, "Shifting error token, ");
-#endif
-
-  *++yyvsp = yylval;
-#ifdef YYLSP_NEEDED
-  *++yylsp = yylloc;
-#endif
-
-  yystate = yyn;
-  goto yynewstate;
-
- yyacceptlab:
-  /* YYACCEPT comes here.  */
-  if (yyfree_stacks)
-    {
-      free (yyss);
-      free (yyvs);
-#ifdef YYLSP_NEEDED
-      free (yyls);
-#endif
-    }
-  return 0;
-
- yyabortlab:
-  /* YYABORT comes here.  */
-  if (yyfree_stacks)
-    {
-      free (yyss);
-      free (yyvs);
-#ifdef YYLSP_NEEDED
-      free (yyls);
-#endif
-    }
-  return 1;
-}
-#line 354 "ncnf_cr_y.y"
-
-
-int
-yyerror(char *s) {
-	if(s == NULL) {
-		switch(errno) {
-		case EEXIST:
-			s = "Entity already defined this context";
-			break;
-		default:
-			s = strerror(errno);
-		}
-	}
-
-	_ncnf_debug_print(1,
-		"Config parse error near line %d: %s",
-		__ncnf_cr_lineno, s);
-	return -1;
-};
-
@@ -32,15 +32,14 @@
 #include "ncnf_int.h"
 #include "ncnf.h"
 
-#define	YYPARSE_PARAM	paramp
+#include "ncnf_cr.h"
 
-int yylex(void);
-int yyerror(char *s);
+static int yyerror(void *scanner, struct ncnf_cr_ctx *ctx, const char *s);
 
-extern int __ncnf_cr_lineno;
-
-#define	RELAXED_NS		((int)*((void **)YYPARSE_PARAM+1))
-#define	ALLOC_NOBJ(_class)	_ncnf_obj_new(0, _class, NULL, NULL, __ncnf_cr_lineno)
+#define	RELAXED_NS		(ctx->relaxed_ns)
+#define	ALLOC_NOBJ(_class)	_ncnf_obj_new(ctx->mr, _class, NULL, NULL, ctx->lineno)
+#define	ALLOC_TYPED(_class, _type, _value)				\
+	_ncnf_obj_new(ctx->mr, _class, _type, _value, ctx->lineno)
 
 
 /*
@@ -53,8 +52,9 @@ extern int __ncnf_cr_lineno;
 			_ncnf_obj_destroy(dst);			\
 			dst = NULL;				\
 			if(errno == EEXIST) {			\
-			__ncnf_cr_lineno = lineno;		\
-			yyerror("Similarly named entity already defined"); \
+			ctx->lineno = lineno;			\
+			yyerror(scanner, ctx,			\
+				"Similarly named entity already defined"); \
 			}					\
 			YYABORT;				\
 		}						\
@@ -62,6 +62,14 @@ extern int __ncnf_cr_lineno;
 
 %}
 
+/*
+ * Reentrant parser: all the state lives in the per-read context.
+ */
+%define api.pure
+%parse-param {void *scanner}
+%parse-param {struct ncnf_cr_ctx *ctx}
+%lex-param {void *scanner}
+
 /*
  * Token value definition
  */
@@ -71,6 +79,10 @@ extern int __ncnf_cr_lineno;
 	struct ncnf_obj_s *tv_obj;
 }
 
+%{
+int yylex(YYSTYPE *lvalp, void *scanner);
+%}
+
 /*
  * Token types returned by scanner
  */
@@ -97,8 +109,8 @@ extern int __ncnf_cr_lineno;
 
 %%
 cfg_file: {
-		**(void ***)YYPARSE_PARAM = ALLOC_NOBJ(NOBJ_ROOT);
-		if(**(void ***)YYPARSE_PARAM == NULL)
+		ctx->root = ALLOC_NOBJ(NOBJ_ROOT);
+		if(ctx->root == NULL)
 			YYABORT;
 	}
 	| sequence {
@@ -122,7 +134,7 @@ cfg_file: {
 		}
 
 		/* Propagate root up to the caller */
-		**(void ***)YYPARSE_PARAM = param_value;
+		ctx->root = param_value;
 	}
 	;
 
@@ -180,7 +192,8 @@ sequence: block ps {
 				_ncnf_obj_destroy($$);
 				$$ = NULL;
 				if(errno == EEXIST)
-					yyerror("Similarly named entity "
+					yyerror(scanner, ctx,
+						"Similarly named entity "
 						"already defined");
 				YYABORT;
 			} else {
@@ -245,16 +258,15 @@ object:
 
 attribute:
 	entity {
-		$$ = $1;
-		if($$) {
-			$$->obj_class = NOBJ_ATTRIBUTE;
+		$$ = _ncnf_obj_reclass($1, NOBJ_ATTRIBUTE);
+		if($$ == NULL) {
+			_ncnf_obj_destroy($1);
+			YYABORT;
 		}
 	}
 	| TOK_NAME '=' TOK_NAME {
-		$$ = ALLOC_NOBJ(NOBJ_ATTRIBUTE);
+		$$ = ALLOC_TYPED(NOBJ_ATTRIBUTE, $1, $3);
 		if($$) {
-			$$->type = bstr_ref($1);
-			$$->value = bstr_ref($3);
 			$$->m_attr_flags |= 1;
 		} else {
 			YYABORT;
@@ -264,26 +276,26 @@ attribute:
 
 insertion:
 	INSERT entity {
-		$$ = $2;
-		if($$) {
-			$$->obj_class = NOBJ_INSERTION;
+		$$ = _ncnf_obj_reclass($2, NOBJ_INSERTION);
+		if($$ == NULL) {
+			_ncnf_obj_destroy($2);
+			YYABORT;
 		}
 	}
 	| INHERIT entity {
-		$$ = $2;
-		if($$) {
-			$$->obj_class = NOBJ_INSERTION;
-			$$->m_insert_flags |= 1;
+		$$ = _ncnf_obj_reclass($2, NOBJ_INSERTION);
+		if($$ == NULL) {
+			_ncnf_obj_destroy($2);
+			YYABORT;
 		}
+		$$->m_insert_flags |= 1;
 	}
 	;
 
 reference:
 	reftype TOK_NAME TOK_STRING '=' TOK_NAME TOK_STRING {
-		$$ = ALLOC_NOBJ(NOBJ_REFERENCE);
+		$$ = ALLOC_TYPED(NOBJ_REFERENCE, $2, $3);
 		if($$) {
-			$$->type = bstr_ref($2);
-			$$->value = bstr_ref($3);
 			$$->m_ref_type = bstr_ref($5);
 			$$->m_ref_value = bstr_ref($6);
 			$$->m_ref_flags = $1;
@@ -292,10 +304,8 @@ reference:
 		}
 	}
 	| reftype TOK_NAME '=' TOK_NAME TOK_STRING {
-		$$ = ALLOC_NOBJ(NOBJ_REFERENCE);
+		$$ = ALLOC_TYPED(NOBJ_REFERENCE, $2, $5);
 		if($$) {
-			$$->type = bstr_ref($2);
-			$$->value = bstr_ref($5);
 			$$->m_ref_type = bstr_ref($4);
 			$$->m_ref_value = bstr_ref($5);
 			$$->m_ref_flags = $1;
@@ -304,10 +314,8 @@ reference:
 		}
 	}
 	| reftype '=' TOK_NAME TOK_STRING {
-                $$ = ALLOC_NOBJ(NOBJ_REFERENCE);
+                $$ = ALLOC_TYPED(NOBJ_REFERENCE, $3, $4);
                 if($$) {
-                        $$->type = bstr_ref($3);
-                        $$->value = bstr_ref($4);
                         $$->m_ref_type = bstr_ref($3);
                         $$->m_ref_value = bstr_ref($4);
                         $$->m_ref_flags = $1;
@@ -316,10 +324,8 @@ reference:
                 }
 	}
 	| reftype TOK_NAME TOK_STRING '=' TOK_STRING {
-                $$ = ALLOC_NOBJ(NOBJ_REFERENCE);
+                $$ = ALLOC_TYPED(NOBJ_REFERENCE, $2, $3);
                 if($$) {
-                        $$->type = bstr_ref($2);
-                        $$->value = bstr_ref($3);
                         $$->m_ref_type = bstr_ref($2);
                         $$->m_ref_value = bstr_ref($5);
                         $$->m_ref_flags = $1;
@@ -340,21 +346,19 @@ reftype:
 
 entity:
 	TOK_NAME TOK_STRING {
-		$$ = ALLOC_NOBJ(-2);
-		if($$) {
-			$$->type = bstr_ref($1);
-			$$->value = bstr_ref($2);
-		} else {
+		$$ = ALLOC_TYPED(-2, $1, $2);
+		if($$ == NULL)
 			YYABORT;
-		}
 	}
 	;
 
 
 %%
 
-int
-yyerror(char *s) {
+static int
+yyerror(void *scanner, struct ncnf_cr_ctx *ctx, const char *s) {
+	(void)scanner;
+
 	if(s == NULL) {
 		switch(errno) {
 		case EEXIST:
@@ -367,7 +371,7 @@ yyerror(char *s) {
 
 	_ncnf_debug_print(1,
 		"Config parse error near line %d: %s",
-		__ncnf_cr_lineno, s);
+		ctx->lineno, s);
 	return -1;
 };
 
@@ -39,28 +39,100 @@ enum difftype {
 	DT_DELETED	= 3,
 };
 
+/*
+ * Objects touched by the diff, in the tree order: every changed
+ * container precedes the changed objects within it.
+ * The work after the diff is done over this list only.
+ */
+struct diff_list {
+	struct ncnf_obj_s **obj;
+	int count;
+	int size;
+	int lost;	/* Some objects could not be recorded */
+};
+
+/*
+ * Matching of the old and new trees. The old tree is only read,
+ * the differences are reported to the callbacks.
+ */
+struct diff_match {
+	/* The old entry is gone, or replaced by one of another class */
+	int (*deleted)(void *key, struct ncnf_obj_s *oobj,
+		enum collections_e, int pos);
+	/* The old reference is retained, maybe pointing elsewhere */
+	int (*reference)(void *key, struct ncnf_obj_s *oobj,
+		enum collections_e, int pos, struct ncnf_obj_s *nent);
+	/* The new entry is not in the old tree (pos follows the old ones) */
+	int (*added)(void *key, struct ncnf_obj_s *oobj,
+		enum collections_e, int pos, struct ncnf_obj_s *nent);
+	/* The collection is over (optional) */
+	int (*done)(void *key, struct ncnf_obj_s *oobj, enum collections_e);
+	void *key;
+};
+
+/*
+ * Staged diff: the changes to be made to the old tree,
+ * with the added objects already cloned.
+ */
+struct stage_op {
+	enum {
+		SO_DELETE,
+		SO_ADD,
+		SO_REFERENCE,
+	} op;
+	enum collections_e coll;
+	int pos;			/* Position of the old object */
+	struct ncnf_obj_s *parent;	/* Container in the old tree */
+	struct ncnf_obj_s *obj;		/* Old object, or the staged clone */
+	bstr_t ref_type;		/* New reference target, or NULL */
+	bstr_t ref_value;
+	int ref_flags;
+};
+
+struct ncnf_diff_stage {
+	struct ncnf_obj_s *old_root;
+	uint64_t fingerprint;	/* Of the old tree, at prepare time */
+	unsigned int rules;	/* The new tree was validated with */
+	void *mr;		/* Region of the clones */
+	int private_mr;		/* The clones are moved out on commit */
+	struct stage_op *op;
+	int count;
+	int size;
+	int applied;		/* Clones before it are in the old tree */
+};
+
 /*
  * Function prototypes.
  */
 
 static int
-_ncnf_diff_level(struct ncnf_obj_s *oobj, struct ncnf_obj_s *nobj);
+_ncnf_diff_match(struct diff_match *,
+	struct ncnf_obj_s *oobj, struct ncnf_obj_s *nobj);
 
-static int
-_ncnf_check_difference(struct ncnf_obj_s *oobj, struct ncnf_obj_s *nobj,
-	enum collections_e);
+static int _ncnf_diff_apply(struct diff_list *, struct ncnf_diff_stage *);
+static int _ncnf_stage_move(struct ncnf_diff_stage *, void *mr);
+static void _ncnf_diff_stage_free(struct ncnf_diff_stage *);
 
-static int __ncnf_diff_resolve_references_callback(struct ncnf_obj_s *, int);
-static int __ncnf_diff_invoke_lazy_notificators(struct ncnf_obj_s *, void *);
-static int __ncnf_diff_invoke_notificators(struct ncnf_obj_s *, void *);
+static int _ncnf_diff_touch(struct diff_list *, struct ncnf_obj_s *);
+static int _ncnf_diff_resolve(struct diff_list *, struct ncnf_obj_s *);
+static void _ncnf_diff_notify(struct diff_list *);
+static void _ncnf_diff_finish(struct diff_list *, struct ncnf_obj_s *root);
+static void _ncnf_diff_undo(struct diff_list *);
 
-static int __ncnf_diff_remove_deleted(struct ncnf_obj_s *, void *key);
+static int _ncnf_diff_changeset(struct diff_list *,
+	struct ncnf_changeset **);
 
-static int __ncnf_diff_undo_callback(struct ncnf_obj_s *, void *key);
+static int __ncnf_stage_deleted(void *, struct ncnf_obj_s *,
+	enum collections_e, int);
+static int __ncnf_stage_reference(void *, struct ncnf_obj_s *,
+	enum collections_e, int, struct ncnf_obj_s *);
+static int __ncnf_stage_added(void *, struct ncnf_obj_s *,
+	enum collections_e, int, struct ncnf_obj_s *);
 
-static int __ncnf_diff_set_mark_func(struct ncnf_obj_s *, void *markv);
+static int __ncnf_diff_invoke_notificators(struct ncnf_obj_s *, void *);
 
-static int __ncnf_diff_cleanup_leaf(struct ncnf_obj_s *, void *key);
+static int __ncnf_diff_mark_deleted(struct ncnf_obj_s *, void *key);
+static int __ncnf_diff_unmark(struct ncnf_obj_s *, void *key);
 
 
 /*
@@ -69,8 +141,9 @@ static int __ncnf_diff_cleanup_leaf(struct ncnf_obj_s *, void *key);
 
 
 int
-_ncnf_diff(struct ncnf_obj_s *old_tree, struct ncnf_obj_s *new_tree) {
-	int ret;
+_ncnf_diff(struct ncnf_obj_s *old_tree, struct ncnf_obj_s *new_tree,
+		struct ncnf_changeset **changes) {
+	struct ncnf_diff_stage *st;
 
 	if(old_tree->obj_class != NOBJ_ROOT
 	  || new_tree->obj_class != NOBJ_ROOT) {
@@ -78,74 +151,259 @@ _ncnf_diff(struct ncnf_obj_s *old_tree, struct ncnf_obj_s *new_tree) {
 		return -1;
 	}
 
-	/* Clear all marks - they will be required */
-	if(old_tree->obj_class == NOBJ_ROOT) {
-		_ncnf_walk_tree(old_tree,
-			__ncnf_diff_cleanup_leaf, NULL);
-		_ncnf_walk_tree(new_tree,
-			__ncnf_diff_cleanup_leaf, NULL);
+	/* The clones go right into the old tree's region */
+	_ncnf_fingerprint(old_tree);
+	st = _ncnf_diff_prepare(old_tree, new_tree, 1);
+	if(st == NULL)
+		return -1;
+
+	return _ncnf_diff_commit(st, changes);
+}
+
+struct ncnf_diff_stage *
+_ncnf_diff_prepare(struct ncnf_obj_s *old_tree, struct ncnf_obj_s *new_tree,
+		int in_place) {
+	struct ncnf_diff_stage *st;
+
+	/*
+	 * The cached fingerprint tells whether the old tree
+	 * is changed before the commit; it can't be computed here.
+	 */
+	if(old_tree->m_fingerprint == 0) {
+		errno = ESTALE;
+		return NULL;
+	}
+
+	st = calloc(1, sizeof(*st));
+	if(st == NULL)
+		return NULL;
+
+	st->old_root = old_tree;
+	st->fingerprint = old_tree->m_fingerprint;
+	st->rules = new_tree->m_rules;
+
+	if(in_place) {
+		st->mr = old_tree->mr;
+	} else if(old_tree->mr) {
+		/* The old tree's region may be in use meanwhile */
+		st->mr = _ncnf_mr_new(_ncnf_mr_flags(old_tree->mr));
+		if(st->mr == NULL) {
+			free(st);
+			return NULL;
+		}
+		st->private_mr = 1;
+	}
+
+	if(st->fingerprint != _ncnf_fingerprint(new_tree)) {
+		struct diff_match dm = {
+			__ncnf_stage_deleted,
+			__ncnf_stage_reference,
+			__ncnf_stage_added,
+			NULL,
+			st
+		};
+
+		if(_ncnf_diff_match(&dm, old_tree, new_tree)) {
+			_ncnf_diff_stage_free(st);
+			return NULL;
+		}
 	}
 
-	ret = _ncnf_diff_level(old_tree, new_tree);
+	return st;
+}
+
+int
+_ncnf_diff_commit(struct ncnf_diff_stage *st,
+		struct ncnf_changeset **changes) {
+	struct ncnf_obj_s *old_tree = st->old_root;
+	struct diff_list dl = { NULL, 0, 0, 0 };
+	int ret;
+
+	/* The old tree must be the same as it was at prepare time */
+	if(_ncnf_fingerprint(old_tree) != st->fingerprint) {
+		_ncnf_diff_stage_free(st);
+		errno = ESTALE;
+		return -1;
+	}
+
+	if(st->count == 0) {
+		/* Nothing has changed */
+		old_tree->m_rules = st->rules;
+		_ncnf_diff_stage_free(st);
+		return changes ? _ncnf_diff_changeset(&dl, changes) : 0;
+	}
+
+	/*
+	 * The old tree is ours now: make the clones live in its region,
+	 * so the memory they release later on is reused by the tree.
+	 */
+	if(st->private_mr && _ncnf_stage_move(st, old_tree->mr)) {
+		_ncnf_diff_stage_free(st);
+		return -1;
+	}
+
+	ret = _ncnf_diff_apply(&dl, st);
+
+	/*
+	 * Describe the changes while the deleted objects are still here
+	 * and the diff may be undone.
+	 */
+	if(ret == 0 && changes)
+		ret = _ncnf_diff_changeset(&dl, changes);
 
 	if(ret == 0) {
 		/*
 		 * After diffing, we should resolve
 		 * all our references again.
 		 */
-		ret = _ncnf_cr_resolve_references(old_tree,
-			__ncnf_diff_resolve_references_callback);
+		ret = _ncnf_diff_resolve(&dl, old_tree);
 		assert(ret == 0);
 
-		/* Invoke notificators */
-		_ncnf_walk_tree(old_tree,
-			__ncnf_diff_invoke_notificators, NULL);
+		/* Invoke notificators and lazy notificators */
+		_ncnf_diff_notify(&dl);
 
-		/* Invoke lazy notificators */
-		_ncnf_walk_tree(old_tree,
-			__ncnf_diff_invoke_lazy_notificators, NULL);
+		/* Remove deleted entities, clear marks */
+		_ncnf_diff_finish(&dl, old_tree);
 
-		/* Remove deleted entities */
-		_ncnf_walk_tree(old_tree,
-			__ncnf_diff_remove_deleted, NULL);
+		/* Recompute fingerprints of the changed subtrees */
+		_ncnf_fingerprint(old_tree);
 
-		/* Cleanup old tree */
-		_ncnf_walk_tree(old_tree,
-			__ncnf_diff_cleanup_leaf, NULL);
+		/* The old tree is as valid as the new one now */
+		old_tree->m_rules = st->rules;
 	} else {
 		/* Undo additions and clear marks */
-		_ncnf_walk_tree(old_tree,
-			__ncnf_diff_undo_callback, NULL);
+		_ncnf_diff_undo(&dl);
 	}
 
+	free(dl.obj);
+	_ncnf_diff_stage_free(st);
+
 	return ret;
 }
 
+void
+_ncnf_diff_abort(struct ncnf_diff_stage *st) {
+	_ncnf_diff_stage_free(st);
+}
 
 
 /*
- * This procedure checks difference in entibutes, objects and
- * references.
- * For deleted and changed items in the old tree it marks 'em
- * as DT_DELETED and DT_CHANGED. For added items from the
- * new tree it clone it, mark as DR_ADDED and added it to the
- * old tree.
+ * Fingerprints.
  */
-static int
-_ncnf_diff_level(struct ncnf_obj_s *oobj, struct ncnf_obj_s *nobj) {
-	int ret;
 
-	/* Check difference in the entity attributes. */
-	ret = _ncnf_check_difference(oobj, nobj, COLLECTION_ATTRIBUTES);
-	if(ret == -1) return -1;
+static uint64_t
+_fp_mix(uint64_t h) {
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
 
-	/* Check difference in the object entitities. */
-	ret = _ncnf_check_difference(oobj, nobj, COLLECTION_OBJECTS);
-	if(ret == -1) return -1;
+static uint64_t
+_fp_str(uint64_t h, const char *str) {
+	/* FNV-1a, with the terminating zero to separate the strings */
+	if(str) {
+		do {
+			h ^= (unsigned char)*str;
+			h *= 0x100000001b3ULL;
+		} while(*str++);
+	} else {
+		h ^= 0xff;
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
 
-	return 0;
+uint64_t
+_ncnf_fingerprint(struct ncnf_obj_s *obj) {
+	uint64_t h = 0xcbf29ce484222325ULL;
+	uint64_t sum;
+	enum collections_e c;
+	int refs;
+	int i;
+
+	if(_NOBJ_CONTAINER(obj) && obj->m_fingerprint)
+		return obj->m_fingerprint;
+
+	h = _fp_str(h ^ obj->obj_class, obj->type);
+	h = _fp_str(h, obj->value);
+
+	switch(obj->obj_class) {
+	case NOBJ_ROOT:
+	case NOBJ_COMPLEX:
+		/*
+		 * The diff matches entries regardless of their order,
+		 * so do the fingerprints.
+		 */
+		sum = 0;
+		refs = 0;
+		for(c = 0; c < MAX_COLLECTIONS; c++) {
+			collection_t *coll = &obj->m_collection[c];
+
+			if(c != COLLECTION_ATTRIBUTES
+			&& c != COLLECTION_OBJECTS)
+				continue;
+
+			for(i = 0; i < coll->entries; i++) {
+				struct ncnf_obj_s *child = coll->entry[i].object;
+
+				sum += _ncnf_fingerprint(child);
+				if(child->obj_class == NOBJ_REFERENCE)
+					refs++;
+				else if(child->obj_class == NOBJ_COMPLEX)
+					refs += child->m_refs;
+			}
+		}
+		h = _fp_mix(h + _fp_mix(sum));
+		if(h == 0) h = 1;
+		obj->m_fingerprint = h;
+		obj->m_refs = refs;
+		return h;
+	case NOBJ_REFERENCE:
+		h = _fp_str(h, obj->m_ref_type);
+		h = _fp_str(h ^ obj->m_ref_flags, obj->m_ref_value);
+		break;
+	default:
+		break;
+	}
+
+	h = _fp_mix(h);
+	return h ? h : 1;
+}
+
+void
+_ncnf_fingerprint_invalidate(struct ncnf_obj_s *obj) {
+	for(; obj; obj = obj->parent) {
+		if(_NOBJ_CONTAINER(obj))
+			obj->m_fingerprint = 0;
+	}
 }
 
+struct ncnf_obj_s *
+_ncnf_diff_counterpart(struct ncnf_obj_s *other_parent,
+		struct ncnf_obj_s *obj) {
+	struct ncnf_obj_s *cp;
+
+	if(other_parent == NULL || obj->obj_class != NOBJ_COMPLEX)
+		return NULL;
+
+	/* The first one, same as the diff would match */
+	cp = _ncnf_coll_get(other_parent->mr,
+		&other_parent->m_collection[COLLECTION_OBJECTS],
+		CG_TYPE_ATOM, (const char *)obj->type_atom, obj->value, NULL);
+	if(cp == NULL || cp->obj_class != NOBJ_COMPLEX)
+		return NULL;
+
+	return cp;
+}
+
+int
+_ncnf_diff_unchanged(struct ncnf_obj_s *obj, struct ncnf_obj_s *counterpart) {
+	return counterpart
+		&& _ncnf_fingerprint(counterpart) == _ncnf_fingerprint(obj);
+}
 
 
 /*
@@ -153,130 +411,478 @@ _ncnf_diff_level(struct ncnf_obj_s *oobj, struct ncnf_obj_s *nobj) {
  */
 
 
+/*
+ * Collections narrower than that are matched by the plain search.
+ */
+#define	DIFF_JOIN_THRESHOLD	16
+
+/*
+ * Temporary hash of the new collection, used to match the old entries
+ * against it in linear time. The chains are kept in the collection
+ * order, so the first unmatched entry is found, same as with
+ * _ncnf_coll_get(). Matched entries are unlinked from the chains,
+ * so the duplicates are never walked over again.
+ */
+struct diff_join {
+	unsigned int buckets;	/* Power of two */
+	int *head;
+	int *next;
+	unsigned int *hash;	/* Hash of every entry */
+};
+
+static unsigned int
+_ncnf_diff_join_hash(struct ncnf_obj_s *obj) {
+	unsigned int h = (unsigned int)((uintptr_t)obj->type_atom >> 4);
+	const char *p;
+
+	if(obj->value) {
+		for(p = obj->value; *p; p++)
+			h = (h * 31) + *(const unsigned char *)p;
+	}
+
+	return h;
+}
+
+static struct diff_join *
+_ncnf_diff_join_new(collection_t *ncoll) {
+	struct diff_join *dj;
+	unsigned int buckets;
+	int i;
+
+	for(buckets = DIFF_JOIN_THRESHOLD;
+		buckets < ncoll->entries; buckets <<= 1);
+
+	dj = malloc(sizeof(*dj) + buckets * sizeof(int)
+		+ ncoll->entries * (sizeof(int) + sizeof(unsigned int)));
+	if(dj == NULL)
+		return NULL;
+
+	dj->buckets = buckets;
+	dj->head = (int *)(dj + 1);
+	dj->next = dj->head + buckets;
+	dj->hash = (unsigned int *)(dj->next + ncoll->entries);
+	memset(dj->head, 0xff, buckets * sizeof(int));
+
+	/* Prepend in reverse to keep the collection order */
+	for(i = ncoll->entries - 1; i >= 0; i--) {
+		unsigned int b;
+
+		if(ncoll->entry[i].ignore_in_search)
+			continue;
+
+		dj->hash[i] = _ncnf_diff_join_hash(ncoll->entry[i].object);
+		b = dj->hash[i] & (buckets - 1);
+		dj->next[i] = dj->head[b];
+		dj->head[b] = i;
+	}
+
+	return dj;
+}
+
+/*
+ * Find and unlink the new entry with the same type and value.
+ * Returns its position, or -1 if there is none.
+ */
 static int
-_ncnf_check_difference(struct ncnf_obj_s *oobj, struct ncnf_obj_s *nobj,
-	enum collections_e c) {
-	collection_t *coll;
-	collection_t *ncoll;
+_ncnf_diff_join_find(struct diff_join *dj, collection_t *ncoll,
+		struct ncnf_obj_s *ent) {
+	unsigned int h = _ncnf_diff_join_hash(ent);
+	int *prev = &dj->head[h & (dj->buckets - 1)];
 	int i;
-	int stopped_at;
 
-	assert(_NOBJ_CONTAINER(oobj) && _NOBJ_CONTAINER(nobj));
+	for(i = *prev; i != -1; prev = &dj->next[i], i = *prev) {
+		struct ncnf_obj_s *nent = ncoll->entry[i].object;
 
-	coll = &oobj->m_collection[c];
-	ncoll = &nobj->m_collection[c];
-	for(i = 0; i < coll->entries; i++) {
-		struct ncnf_obj_s *ent;
-		struct ncnf_obj_s *nent;
-
-		ent  = coll->entry[i].object;
-		nent = _ncnf_coll_get(ncoll,
-			CG_RETURN_POSITION,
-			ent->type, ent->value,
-			(void *)&stopped_at);
-
-		if(nent) {
-		    if(
-			(ent->obj_class != nent->obj_class)
-		    ) {
-			/*
-			 * Object is of another type,
-			 * mean the previous was deleted.
-			 * Here we relay on our anti-duplicate
-			 * technique.
-			 */
-			ent->mark = DT_DELETED;
-			oobj->mark = DT_CHANGED;	/* Parent object */
+		if(dj->hash[i] != h
+		|| nent->type_atom != ent->type_atom
+		|| bstr_len(nent->value) != bstr_len(ent->value)
+		|| strcmp(nent->value, ent->value))
+			continue;
 
-			/* Propagate DT_DELETED down the tree */
-			ncnf_walk_tree(ent, __ncnf_diff_set_mark_func,
-				(void *)DT_DELETED);
-		    } else {
+		*prev = dj->next[i];
+		return i;
+	}
 
-			if(ent->obj_class == NOBJ_COMPLEX) {
+	return -1;
+}
 
-			    /* Walk down the tree */
-			    if(_ncnf_diff_level(ent, nent))
-				return -1;
 
-			    /* Propagate changes back */
-			    if(ent->mark == DT_CHANGED)
-				oobj->mark = DT_CHANGED;
+/*
+ * Match the collections of the two containers. The old entries are
+ * searched for in the new collection by their type and value, every
+ * new entry matching at most one old entry. The entries left
+ * unmatched are reported as deleted and added, respectively.
+ * Neither tree is modified.
+ */
+static int
+_ncnf_diff_match(struct diff_match *dm,
+		struct ncnf_obj_s *oobj, struct ncnf_obj_s *nobj) {
+	enum collections_e c;
 
-			} else if(ent->obj_class == NOBJ_REFERENCE) {
+	assert(_NOBJ_CONTAINER(oobj) && _NOBJ_CONTAINER(nobj));
+
+	for(c = COLLECTION_ATTRIBUTES; c <= COLLECTION_OBJECTS; c++) {
+		collection_t *coll = &oobj->m_collection[c];
+		collection_t *ncoll = &nobj->m_collection[c];
+		struct diff_join *dj = NULL;
+		char *retained;
+		int ret = 0;
+		int i, j;
+
+		retained = calloc(ncoll->entries + 1, 1);
+		if(retained == NULL)
+			return -1;
+
+		/*
+		 * Wide collections are joined through the temporary hash.
+		 * If there's no memory for it, the plain search will do.
+		 */
+		if(coll->entries >= DIFF_JOIN_THRESHOLD
+		&& ncoll->entries >= DIFF_JOIN_THRESHOLD)
+			dj = _ncnf_diff_join_new(ncoll);
+
+		for(i = 0; ret == 0 && i < coll->entries; i++) {
+			struct ncnf_obj_s *ent = coll->entry[i].object;
+			struct ncnf_obj_s *nent = NULL;
+
+			if(dj) {
+				j = _ncnf_diff_join_find(dj, ncoll, ent);
+			} else {
+				for(j = 0; j < ncoll->entries; j++) {
+					nent = ncoll->entry[j].object;
+					if(!retained[j]
+					&& !ncoll->entry[j].ignore_in_search
+					&& nent->type_atom == ent->type_atom
+					&& !strcmp(nent->value, ent->value))
+						break;
+				}
+				if(j == ncoll->entries) j = -1;
+			}
+			nent = (j == -1) ? NULL : ncoll->entry[j].object;
 
-			    if(strcmp(ent->m_ref_value, nent->m_ref_value)
-				|| strcmp(ent->m_ref_type, nent->m_ref_type)
-			    ) {
+			/*
+			 * Object of another class means the previous
+			 * one was deleted. Here we relay on our
+			 * anti-duplicate technique.
+			 */
+			if(nent == NULL || nent->obj_class != ent->obj_class) {
+				ret = dm->deleted(dm->key, oobj, c, i);
+				continue;
+			}
+
+			/* Object retained */
+			retained[j] = 1;
+
+			switch(ent->obj_class) {
+			case NOBJ_COMPLEX:
 				/*
-				 * References are not absolutely equal.
-				 * Maybe, something is changed.
+				 * Identical subtrees need no walking.
+				 * The cached fingerprint is used,
+				 * so the old tree is never written.
 				 */
-				ent->mark = DT_CHANGED;
-				oobj->mark = DT_CHANGED;
-
-				ent->m_new_ref_type = bstr_ref(nent->m_ref_type);
-				ent->m_new_ref_value = bstr_ref(nent->m_ref_value);
-			    }
-
-			    /*
-			     * We will not be able to do an UNDO operation,
-			     * but we should be able to at least
-			     * modify the flags of a reference.
-			     */
-			    ent->m_ref_flags = nent->m_ref_flags;
+				if(ent->m_fingerprint == 0
+				|| ent->m_fingerprint
+					!= _ncnf_fingerprint(nent))
+					ret = _ncnf_diff_match(dm, ent, nent);
+				break;
+			case NOBJ_REFERENCE:
+				ret = dm->reference(dm->key, oobj, c, i, nent);
+				break;
+			default:
+				break;
 			}
+		}
 
-			/* Object retained */
-			ncoll->entry[stopped_at].ignore_in_search = 1;
-		    }
-		} else {
-		    ent->mark = DT_DELETED;
-		    oobj->mark = DT_CHANGED;
+		free(dj);
 
-		    /* Propagate DT_DELETED down the tree */
-		    ncnf_walk_tree(ent, __ncnf_diff_set_mark_func,
-			(void *)DT_DELETED);
+		for(j = 0; ret == 0 && j < ncoll->entries; j++) {
+			if(retained[j])
+				continue;
+			ret = dm->added(dm->key, oobj, c, coll->entries + j,
+				ncoll->entry[j].object);
 		}
 
+		free(retained);
+
+		if(ret == 0 && dm->done)
+			ret = dm->done(dm->key, oobj, c);
+		if(ret)
+			return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Staging the changes.
+ */
+
+static int
+_ncnf_stage_push(struct ncnf_diff_stage *st, int op,
+		struct ncnf_obj_s *parent, enum collections_e c, int pos,
+		struct ncnf_obj_s *obj) {
+	struct stage_op *so;
+
+	if(st->count == st->size) {
+		int size = st->size ? st->size * 2 : 32;
+		void *p;
+
+		p = realloc(st->op, size * sizeof(st->op[0]));
+		if(p == NULL)
+			return -1;
+		st->op = p;
+		st->size = size;
 	}
 
-	/* Add all unmarked properties */
-	for(i = 0; i < ncoll->entries; i++) {
-		struct ncnf_obj_s *nent;
+	so = &st->op[st->count++];
+	memset(so, 0, sizeof(*so));
+	so->op = op;
+	so->coll = c;
+	so->pos = pos;
+	so->parent = parent;
+	so->obj = obj;
+
+	return 0;
+}
+
+static int
+__ncnf_stage_deleted(void *key, struct ncnf_obj_s *oobj,
+		enum collections_e c, int pos) {
+	return _ncnf_stage_push(key, SO_DELETE, oobj, c, pos,
+		oobj->m_collection[c].entry[pos].object);
+}
+
+static int
+__ncnf_stage_reference(void *key, struct ncnf_obj_s *oobj,
+		enum collections_e c, int pos, struct ncnf_obj_s *nent) {
+	struct ncnf_diff_stage *st = key;
+	struct ncnf_obj_s *ent = oobj->m_collection[c].entry[pos].object;
+	struct stage_op *so;
+	int retarget;
+
+	retarget = strcmp(ent->m_ref_value, nent->m_ref_value)
+		|| strcmp(ent->m_ref_type, nent->m_ref_type);
+
+	if(!retarget && ent->m_ref_flags == nent->m_ref_flags)
+		return 0;
+
+	if(_ncnf_stage_push(st, SO_REFERENCE, oobj, c, pos, ent))
+		return -1;
+	so = &st->op[st->count - 1];
+	so->ref_flags = nent->m_ref_flags;
+
+	if(retarget) {
+		/*
+		 * References are not absolutely equal.
+		 * Maybe, something is changed.
+		 */
+		so->ref_type = _ncnf_mr_strref(st->mr, nent->m_ref_type);
+		so->ref_value = _ncnf_mr_strref(st->mr, nent->m_ref_value);
+		if(so->ref_type == NULL || so->ref_value == NULL)
+			return -1;
+	}
+
+	return 0;
+}
+
+static int
+__ncnf_stage_added(void *key, struct ncnf_obj_s *oobj,
+		enum collections_e c, int pos, struct ncnf_obj_s *nent) {
+	struct ncnf_diff_stage *st = key;
+	struct ncnf_obj_s *clone;
+
+	clone = _ncnf_obj_clone(st->mr, nent);
+	if(clone == NULL) {
+		/* ENOMEM? */
+		return -1;
+	}
+
+	if(_ncnf_stage_push(st, SO_ADD, oobj, c, pos, clone)) {
+		_ncnf_obj_destroy(clone);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Replace the staged clones by their copies allocated in the given region.
+ */
+static int
+_ncnf_stage_move(struct ncnf_diff_stage *st, void *mr) {
+	int i;
+
+	for(i = 0; i < st->count; i++) {
+		struct stage_op *so = &st->op[i];
+		struct ncnf_obj_s *clone;
 
-		if(ncoll->entry[i].ignore_in_search) {
-			ncoll->entry[i].ignore_in_search = 0;
+		if(so->op != SO_ADD)
 			continue;
-		}
 
-		nent = _ncnf_obj_clone(oobj->mr, ncoll->entry[i].object);
-		if(nent == NULL) {
-			/* ENOMEM? */
+		clone = _ncnf_obj_clone(mr, so->obj);
+		if(clone == NULL)
 			return -1;
+		_ncnf_obj_destroy(so->obj);
+		so->obj = clone;
+	}
+
+	return 0;
+}
+
+static void
+_ncnf_diff_stage_free(struct ncnf_diff_stage *st) {
+	int i;
+
+	for(i = 0; i < st->count; i++) {
+		struct stage_op *so = &st->op[i];
+
+		switch(so->op) {
+		case SO_ADD:
+			/* Not yet in the old tree */
+			if(i >= st->applied)
+				_ncnf_obj_destroy(so->obj);
+			break;
+		case SO_REFERENCE:
+			bstr_free(so->ref_type);
+			bstr_free(so->ref_value);
+			break;
+		default:
+			break;
 		}
+	}
 
-		if(_ncnf_coll_insert(oobj->mr, coll, nent, MERGE_NOFLAGS)) {
-			/*
-			 * Memory allocation failure (ENOMEM).
-			 */
-			_ncnf_obj_destroy(nent);
+	if(st->private_mr)
+		_ncnf_mr_destroy(st->mr);
+
+	free(st->op);
+	free(st);
+}
+
+/*
+ * Mark the unmodified containers of the object as changed,
+ * recording them outermost first.
+ */
+static int
+_ncnf_diff_touch_parents(struct diff_list *dl, struct ncnf_obj_s *parent) {
+	struct ncnf_obj_s *top;
+
+	if(parent->dmark != DT_UNMODIFIED)
+		return 0;
+
+	/* Find the outermost unmodified container */
+	for(top = parent; top->parent
+		&& top->parent->dmark == DT_UNMODIFIED; top = top->parent);
+
+	for(;;) {
+		struct ncnf_obj_s *obj;
+
+		if(_ncnf_diff_touch(dl, top))
 			return -1;
-		} else {
-			nent->parent = oobj;
-		}
+		top->dmark = DT_CHANGED;
+		if(top == parent)
+			return 0;
 
-		nent->mark = DT_ADDED;
-		oobj->mark = DT_CHANGED;
+		/* Step down towards the parent */
+		for(obj = parent; obj->parent != top; obj = obj->parent);
+		top = obj;
 	}
+}
+
+/*
+ * Apply the staged changes to the old tree, marking and recording
+ * the touched objects. Stops at the first failure, so the diff
+ * may be undone.
+ */
+static int
+_ncnf_diff_apply(struct diff_list *dl, struct ncnf_diff_stage *st) {
+	int i;
 
+	for(i = 0; i < st->count; i++) {
+		struct stage_op *so = &st->op[i];
+		collection_t *coll = &so->parent->m_collection[so->coll];
+		struct ncnf_obj_s *ent;
 
-	/* Mark all deleted properties to ignore them */
-	for(i = 0; i < coll->entries; i++) {
-		if(coll->entry[i].object->mark == DT_DELETED)
-			coll->entry[i].ignore_in_search = 1;
-	}
+		if(so->op != SO_ADD
+		&& (so->pos >= coll->entries
+			|| coll->entry[so->pos].object != so->obj)) {
+			errno = ESTALE;
+			return -1;
+		}
 
+		switch(so->op) {
+		case SO_DELETE:
+			ent = so->obj;
+			if(_ncnf_diff_touch_parents(dl, so->parent)
+			|| _ncnf_diff_touch(dl, ent))
+				return -1;
+			/* Mark the deleted property to ignore it */
+			coll->entry[so->pos].ignore_in_search = 1;
+			/* Propagate DT_DELETED down the tree */
+			_ncnf_walk_tree(ent, __ncnf_diff_mark_deleted, NULL);
+			break;
+		case SO_ADD:
+			if(i == 0 || so[-1].op != SO_ADD
+			|| so[-1].parent != so->parent
+			|| so[-1].coll != so->coll) {
+				int added;
+
+				/* Make room for the whole group at once */
+				for(added = 1; i + added < st->count
+					&& so[added].op == SO_ADD
+					&& so[added].parent == so->parent
+					&& so[added].coll == so->coll;
+						added++);
+				if(_ncnf_coll_reserve(so->parent->mr, coll,
+						coll->entries + added))
+					return -1;
+			}
+
+			ent = so->obj;
+			if(_ncnf_diff_touch_parents(dl, so->parent))
+				return -1;
+			if(_ncnf_coll_insert(so->parent->mr, coll, ent,
+					MERGE_NOFLAGS)) {
+				/*
+				 * Memory allocation failure (ENOMEM).
+				 */
+				return -1;
+			}
+			st->applied = i + 1;
+			ent->parent = so->parent;
+
+			/* Undo finds it by the mark even if not recorded */
+			ent->dmark = DT_ADDED;
+
+			if(_ncnf_diff_touch(dl, ent))
+				return -1;
+			break;
+		case SO_REFERENCE:
+			ent = so->obj;
+
+			/*
+			 * We will not be able to do an UNDO operation,
+			 * but we should be able to at least
+			 * modify the flags of a reference.
+			 */
+			if(ent->m_ref_flags != so->ref_flags) {
+				ent->m_ref_flags = so->ref_flags;
+				_ncnf_fingerprint_invalidate(so->parent);
+			}
+
+			if(so->ref_type == NULL)
+				break;
+
+			if(_ncnf_diff_touch_parents(dl, so->parent)
+			|| _ncnf_diff_touch(dl, ent))
+				return -1;
+			ent->dmark = DT_CHANGED;
+			ent->m_new_ref_type = _ncnf_mr_strref(ent->mr,
+				so->ref_type);
+			ent->m_new_ref_value = _ncnf_mr_strref(ent->mr,
+				so->ref_value);
+			break;
+		}
+	}
 
 	return 0;
 }
@@ -288,166 +894,730 @@ _ncnf_check_difference(struct ncnf_obj_s *oobj, struct ncnf_obj_s *nobj,
 
 
 /*
+ * Record the touched object.
+ */
+static int
+_ncnf_diff_touch(struct diff_list *dl, struct ncnf_obj_s *obj) {
+
+	if(dl->count == dl->size) {
+		int size = dl->size ? dl->size * 2 : 64;
+		void *p;
+
+		p = realloc(dl->obj, size * sizeof(dl->obj[0]));
+		if(p == NULL)
+			return -1;
+		dl->obj = p;
+		dl->size = size;
+	}
+
+	dl->obj[dl->count++] = obj;
+
+	return 0;
+}
+
+/*
+ * Resolve the references again. Only the changed subtrees and the
+ * ones having references are visited.
  * In any case, this function should succeed, because
  * it does not allocate memory and logically should find everything.
  */
 static int
-__ncnf_diff_resolve_references_callback(struct ncnf_obj_s *ref, int inv) {
+_ncnf_diff_resolve(struct diff_list *dl, struct ncnf_obj_s *obj) {
+	collection_t *coll;
+	int i;
 
-	if(inv == 0) {
-		if(ref->mark == DT_DELETED)
-			return -1;
+	switch(obj->obj_class) {
+	case NOBJ_ROOT:
+	case NOBJ_COMPLEX:
+		if(obj->dmark == DT_DELETED)
+			return 0;
+
+		/* Unchanged contents: the cached counter is valid */
+		if(obj->dmark != DT_CHANGED
+		&& (_ncnf_fingerprint(obj), obj->m_refs == 0))
+			return 0;
+
+		coll = &obj->m_collection[COLLECTION_OBJECTS];
+		for(i = 0; i < coll->entries; i++) {
+			if(_ncnf_diff_resolve(dl, coll->entry[i].object))
+				return -1;
+		}
+		return 0;
+	case NOBJ_REFERENCE:
+		if(obj->dmark == DT_DELETED)
+			return 0;
+		break;
+	default:
 		return 0;
 	}
 
+	if(_ncnf_cr_resolve_object(obj, NULL))
+		return -1;
+
 	/*
 	 * Our reference is of type "attach",
 	 * so check if referenced object is changed, than
 	 * propagate changes up the tree.
 	 */
-	if((ref->m_ref_flags & 1)) {
-		if(ref->m_direct_reference->mark != DT_UNMODIFIED) {
-			/*
-			 * Referenced object is changed,
-			 * so changed the reference itself.
-			 * Propagate changed up the tree.
-			 */
-			ref->mark = DT_CHANGED;
-
-			while(ref->parent
-			  && ref->parent->mark == DT_UNMODIFIED) {
-				ref->parent->mark = DT_CHANGED;
-				ref = ref->parent;
-			}
-		}
-
+	if((obj->m_ref_flags & 1)
+	&& obj->m_direct_reference->dmark != DT_UNMODIFIED) {
+		/*
+		 * Referenced object is changed,
+		 * so changed the reference itself.
+		 * Propagate changed up the tree.
+		 */
+		do {
+			if(obj->dmark == DT_UNMODIFIED
+			&& _ncnf_diff_touch(dl, obj))
+				dl->lost = 1;
+			obj->dmark = DT_CHANGED;
+			obj = obj->parent;
+		} while(obj && obj->dmark == DT_UNMODIFIED);
 	}
 
 	return 0;
 }
 
-static int
-__ncnf_diff_invoke_notificators(struct ncnf_obj_s *obj, void *key) {
-
-	(void)key;
+/*
+ * Invoke notificators, then lazy notificators, of the touched objects.
+ */
+static void
+_ncnf_diff_notify(struct diff_list *dl) {
+	int i;
 
-	/*
-	 * General notifications.
-	 */
+	for(i = 0; i < dl->count; i++) {
+		struct ncnf_obj_s *obj = dl->obj[i];
 
-	if(obj->notify) {
-		switch(obj->mark) {
+		switch(obj->dmark) {
+		case DT_DELETED:
+			/* Everything within is deleted as well */
+			_ncnf_walk_tree(obj,
+				__ncnf_diff_invoke_notificators, NULL);
+			break;
 		case DT_CHANGED:
-			obj->notify((ncnf_obj *)obj, NCNF_OBJ_CHANGE,
-				obj->notify_key);
+			__ncnf_diff_invoke_notificators(obj, NULL);
 			break;
+		}
+	}
+
+	for(i = 0; i < dl->count; i++) {
+		struct ncnf_obj_s *obj = dl->obj[i];
+
+		if(obj->dmark == DT_CHANGED && _NOBJ_CONTAINER(obj))
+			_ncnf_check_lazy_filters(obj, DT_ADDED);
+	}
+}
+
+/*
+ * Squeeze configuration to get rid of deleted values,
+ * and clear the marks. The objects within are processed
+ * before their parents, so nothing is visited after it is destroyed.
+ */
+static void
+_ncnf_diff_finish(struct diff_list *dl, struct ncnf_obj_s *root) {
+	collection_t *coll;
+	int i;
+
+	for(i = dl->count - 1; i >= 0; i--) {
+		struct ncnf_obj_s *obj = dl->obj[i];
+
+		switch(obj->dmark) {
 		case DT_DELETED:
-			obj->notify((ncnf_obj *)obj, NCNF_OBJ_DESTROY,
-				obj->notify_key);
+			/* Will be destroyed along with the parent's entry */
+			continue;
+		case DT_CHANGED:
+			if(!_NOBJ_CONTAINER(obj))
+				break;
+
+			coll = &obj->m_collection[COLLECTION_OBJECTS];
+			_ncnf_coll_remove_dmarked(obj->mr, coll, DT_DELETED);
+			if(coll->entries < coll->size / 4)
+				_ncnf_coll_shrink(obj->mr, coll);
+
+			coll = &obj->m_collection[COLLECTION_ATTRIBUTES];
+			_ncnf_coll_remove_dmarked(obj->mr, coll, DT_DELETED);
+			if(coll->entries < coll->size / 4)
+				_ncnf_coll_shrink(obj->mr, coll);
+
+			/* Contents have changed */
+			obj->m_fingerprint = 0;
 			break;
+		}
+
+		__ncnf_diff_unmark(obj, NULL);
+	}
+
+	/* Objects marked but not recorded (ENOMEM) */
+	if(dl->lost)
+		_ncnf_walk_tree(root, __ncnf_diff_unmark, NULL);
+}
+
+/*
+ * Remove the added objects and clear the marks.
+ */
+static void
+_ncnf_diff_undo(struct diff_list *dl) {
+	collection_t *coll;
+	enum collections_e c;
+	int i, j;
+
+	for(i = dl->count - 1; i >= 0; i--) {
+		struct ncnf_obj_s *obj = dl->obj[i];
+
+		switch(obj->dmark) {
 		case DT_ADDED:
-			/*
-			 * We can't notify something that already
-			 * has an event notificator on it.
-			 */
-			assert(0);
-			break;
+			/* Will be destroyed along with the parent's entry */
+			continue;
+		case DT_DELETED:
+			_ncnf_walk_tree(obj, __ncnf_diff_unmark, NULL);
+			continue;
+		}
+
+		if(_NOBJ_CONTAINER(obj)) {
+			/* Shrink collections to eliminate all added entries */
+			for(c = COLLECTION_ATTRIBUTES;
+					c <= COLLECTION_OBJECTS; c++) {
+				coll = &obj->m_collection[c];
+				for(j = 0; j < coll->entries; j++) {
+					if(coll->entry[j].object->dmark
+							== DT_ADDED) {
+						_ncnf_coll_adjust_size(obj->mr,
+							coll, j);
+						coll->entries = j;
+						break;
+					}
+					/* Set for the deleted ones */
+					coll->entry[j].ignore_in_search = 0;
+				}
+			}
 		}
+
+		__ncnf_diff_unmark(obj, NULL);
 	}
+}
 
+/*
+ * Change sets.
+ */
 
-	return 0;
+/* Records of a single kind, concatenated at the end */
+struct cs_bucket {
+	struct ncnf_change *change;
+	int count;
+	int size;
+};
+
+struct cs_builder {
+	struct cs_bucket deleted;	/* Deletions */
+	struct cs_bucket added;		/* Additions and modifications */
+	struct cs_bucket refs;		/* References */
+	struct cs_attr {
+		struct ncnf_obj_s *obj;
+		int pos;	/* Added ones follow the deleted ones */
+		int deleted;
+	} *attr;			/* Scratch, see _cs_attr_pairs() */
+	int attr_count;
+	int attr_size;
+};
+
+static void
+_cs_record_free(struct ncnf_change *ch) {
+	free(ch->path);
+	free(ch->old_value);
+	free(ch->new_value);
+}
+
+static void
+_cs_bucket_free(struct cs_bucket *bk) {
+	int i;
+	for(i = 0; i < bk->count; i++)
+		_cs_record_free(&bk->change[i]);
+	free(bk->change);
+}
+
+/*
+ * "type:name" of the object, or just "type" for attributes.
+ */
+static size_t
+_cs_component(struct ncnf_obj_s *obj, char *buf) {
+	size_t tlen = strlen(obj->type);
+	size_t vlen;
+
+	if(obj->obj_class == NOBJ_ATTRIBUTE) {
+		if(buf) memcpy(buf, obj->type, tlen);
+		return tlen;
+	}
+
+	vlen = strlen(obj->value);
+	if(buf) {
+		memcpy(buf, obj->type, tlen);
+		buf[tlen] = ':';
+		memcpy(buf + tlen + 1, obj->value, vlen);
+	}
+	return tlen + 1 + vlen;
+}
+
+static char *
+_cs_path(struct ncnf_obj_s *obj) {
+	struct ncnf_obj_s *o;
+	size_t len = 0;
+	char *buf;
+
+	for(o = obj; o->obj_class != NOBJ_ROOT; o = o->parent)
+		len += _cs_component(o, NULL) + 1;
+
+	buf = malloc(len ? len : 1);
+	if(buf == NULL)
+		return NULL;
+
+	/* Fill from the end */
+	buf[len ? --len : 0] = '\0';
+	for(o = obj; o->obj_class != NOBJ_ROOT; o = o->parent) {
+		len -= _cs_component(o, NULL);
+		_cs_component(o, buf + len);
+		if(len) buf[--len] = '/';
+	}
+
+	return buf;
+}
+
+/*
+ * The value as it is reported in the change set.
+ */
+static char *
+_cs_value(struct ncnf_obj_s *obj, int new_ref) {
+	const char *type, *value;
+	size_t tlen, vlen;
+	char *buf;
+
+	if(obj->obj_class != NOBJ_REFERENCE)
+		return strdup(obj->value);
+
+	if(new_ref) {
+		type = obj->m_new_ref_type;
+		value = obj->m_new_ref_value;
+	} else {
+		type = obj->m_ref_type;
+		value = obj->m_ref_value;
+	}
+
+	tlen = strlen(type);
+	vlen = strlen(value);
+	buf = malloc(tlen + vlen + 2);
+	if(buf) {
+		memcpy(buf, type, tlen);
+		buf[tlen] = ':';
+		memcpy(buf + tlen + 1, value, vlen + 1);
+	}
+	return buf;
 }
 
 static int
-__ncnf_diff_invoke_lazy_notificators(struct ncnf_obj_s *obj, void *key) {
-	(void)key;
+_cs_add(struct cs_bucket *bk, enum ncnf_change_kind kind,
+		struct ncnf_obj_s *obj, struct ncnf_obj_s *old_obj) {
+	struct ncnf_change *ch;
+
+	if(bk->count == bk->size) {
+		int size = bk->size ? bk->size * 2 : 16;
+		void *p = realloc(bk->change, size * sizeof(bk->change[0]));
+		if(p == NULL)
+			return -1;
+		bk->change = p;
+		bk->size = size;
+	}
 
-	if(obj->mark == DT_CHANGED &&
-			_NOBJ_CONTAINER(obj))
-		_ncnf_check_lazy_filters(obj, DT_ADDED);
+	ch = &bk->change[bk->count];
+	ch->kind = kind;
+	ch->path = _cs_path(obj);
+	ch->old_value = NULL;
+	ch->new_value = NULL;
+
+	switch(kind) {
+	case NCNF_CHANGE_ADD:
+		ch->new_value = _cs_value(obj, 0);
+		break;
+	case NCNF_CHANGE_MODIFY:
+		/* Either a pair of objects or a reference changed in place */
+		if(old_obj) {
+			ch->old_value = _cs_value(old_obj, 0);
+			ch->new_value = _cs_value(obj, 0);
+		} else {
+			ch->old_value = _cs_value(obj, 0);
+			ch->new_value = _cs_value(obj, 1);
+		}
+		break;
+	case NCNF_CHANGE_DELETE:
+		ch->old_value = _cs_value(obj, 0);
+		break;
+	}
+
+	if(ch->path == NULL
+	|| (kind != NCNF_CHANGE_ADD && ch->old_value == NULL)
+	|| (kind != NCNF_CHANGE_DELETE && ch->new_value == NULL)) {
+		_cs_record_free(ch);
+		return -1;
+	}
 
+	bk->count++;
 	return 0;
 }
 
 /*
- * Squeeze configuration to get rid of deleted values.
+ * Describe the added object and everything within it.
  */
-
 static int
-__ncnf_diff_remove_deleted(struct ncnf_obj_s *obj, void *key) {
-	collection_t *coll;
+_cs_added_tree(struct cs_builder *csb, struct ncnf_obj_s *obj) {
+	enum collections_e c;
+	int i;
+
+	switch(obj->obj_class) {
+	case NOBJ_ATTRIBUTE:
+		return _cs_add(&csb->added, NCNF_CHANGE_ADD, obj, NULL);
+	case NOBJ_REFERENCE:
+		return _cs_add(&csb->refs, NCNF_CHANGE_ADD, obj, NULL);
+	case NOBJ_COMPLEX:
+		if(_cs_add(&csb->added, NCNF_CHANGE_ADD, obj, NULL))
+			return -1;
+		for(c = COLLECTION_ATTRIBUTES; c <= COLLECTION_OBJECTS; c++) {
+			collection_t *coll = &obj->m_collection[c];
+			for(i = 0; i < coll->entries; i++) {
+				if(_cs_added_tree(csb, coll->entry[i].object))
+					return -1;
+			}
+		}
+		return 0;
+	default:
+		return 0;
+	}
+}
 
-	if(_NOBJ_CONTAINER(obj)) {
+static int
+_cs_attr_cmp(const void *ap, const void *bp) {
+	const struct cs_attr *a = ap;
+	const struct cs_attr *b = bp;
+
+	/* Group by type, keeping the collection order */
+	if(a->obj->type_atom != b->obj->type_atom)
+		return a->obj->type_atom < b->obj->type_atom ? -1 : 1;
+	return a->pos - b->pos;
+}
 
-		coll = &obj->m_collection[COLLECTION_OBJECTS];
-		_ncnf_coll_remove_marked(coll, DT_DELETED);
-	
-		coll = &obj->m_collection[COLLECTION_ATTRIBUTES];
-		_ncnf_coll_remove_marked(coll, DT_DELETED);
+static int
+_cs_attr_push(struct cs_builder *csb, struct ncnf_obj_s *obj,
+		int pos, int deleted) {
+	struct cs_attr *ca;
+
+	if(csb->attr_count == csb->attr_size) {
+		int size = csb->attr_size ? csb->attr_size * 2 : 16;
+		void *p = realloc(csb->attr, size * sizeof(csb->attr[0]));
+		if(p == NULL)
+			return -1;
+		csb->attr = p;
+		csb->attr_size = size;
 	}
 
+	ca = &csb->attr[csb->attr_count++];
+	ca->obj = obj;
+	ca->pos = pos;
+	ca->deleted = deleted;
+
 	return 0;
 }
 
+/*
+ * Describe the deleted and added attributes of a single container,
+ * as pushed by _cs_attr_push().
+ * The attribute which is the single deleted and the single added one
+ * of its type is reported as modified.
+ */
+static int
+_cs_attr_pairs(struct cs_builder *csb) {
+	struct cs_attr *attr = csb->attr;
+	int count = csb->attr_count;
+	int i, j;
+
+	csb->attr_count = 0;
+
+	qsort(attr, count, sizeof(attr[0]), _cs_attr_cmp);
+
+	for(i = 0; i < count; i = j) {
+		int ret = 0;
+
+		for(j = i + 1; j < count
+			&& attr[j].obj->type_atom == attr[i].obj->type_atom;
+				j++);
 
+		if(j - i == 2 && attr[i].deleted && !attr[i + 1].deleted) {
+			ret = _cs_add(&csb->added, NCNF_CHANGE_MODIFY,
+				attr[i + 1].obj, attr[i].obj);
+		} else {
+			int k;
+			for(k = i; ret == 0 && k < j; k++) {
+				if(attr[k].deleted)
+					ret = _cs_add(&csb->deleted,
+						NCNF_CHANGE_DELETE,
+						attr[k].obj, NULL);
+				else
+					ret = _cs_add(&csb->added,
+						NCNF_CHANGE_ADD,
+						attr[k].obj, NULL);
+			}
+		}
+		if(ret)
+			return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Describe the changed attributes of the container, using diff marks.
+ */
 static int
-__ncnf_diff_undo_callback(struct ncnf_obj_s *obj, void *key) {
-	collection_t *coll;
-	struct ncnf_obj_s *o;
+_cs_attributes(struct cs_builder *csb, struct ncnf_obj_s *obj) {
+	collection_t *coll = &obj->m_collection[COLLECTION_ATTRIBUTES];
 	int i;
 
-	(void)key;
+	for(i = 0; i < coll->entries; i++) {
+		struct ncnf_obj_s *a = coll->entry[i].object;
+		if(a->dmark != DT_ADDED && a->dmark != DT_DELETED)
+			continue;
+		if(_cs_attr_push(csb, a, i, a->dmark == DT_DELETED))
+			return -1;
+	}
 
-	if(_NOBJ_CONTAINER(obj)) {
+	return _cs_attr_pairs(csb);
+}
 
-		coll = &obj->m_collection[COLLECTION_ATTRIBUTES];
-		for(i = 0; i < coll->entries; i++) {
-			if(coll->entry[i].object->mark == DT_ADDED) {
-				_ncnf_coll_adjust_size(obj->mr, coll, i);
-				coll->entries = i;
-				break;
+/*
+ * Concatenate the records into the change set.
+ */
+static int
+_cs_finish(struct cs_builder *csb, int ret, struct ncnf_changeset **changes) {
+	struct ncnf_changeset *cs;
+	int i;
+
+	free(csb->attr);
+
+	cs = NULL;
+	if(ret == 0)
+		cs = calloc(1, sizeof(*cs));
+	if(cs) {
+		cs->count = csb->deleted.count + csb->added.count
+			+ csb->refs.count;
+		if(cs->count) {
+			cs->change = malloc(cs->count * sizeof(cs->change[0]));
+			if(cs->change == NULL) {
+				free(cs);
+				cs = NULL;
 			}
 		}
-	
-		coll = &obj->m_collection[COLLECTION_OBJECTS];
-		for(i = 0; i < coll->entries; i++) {
-			o = coll->entry[i].object;
-	
-			/* Shrink collection to eliminate all added entries */
-			if(o->mark == DT_ADDED) {
-				_ncnf_coll_adjust_size(obj->mr, coll, i);
-				coll->entries = i;
-				break;
-			}
-	
-			if(o->obj_class == NOBJ_COMPLEX)
-				/* Go down the tree */
-				__ncnf_diff_undo_callback(o, key);
+	}
+	if(cs == NULL) {
+		_cs_bucket_free(&csb->deleted);
+		_cs_bucket_free(&csb->added);
+		_cs_bucket_free(&csb->refs);
+		errno = ENOMEM;
+		return -1;
+	}
+
+	i = 0;
+	memcpy(cs->change + i, csb->deleted.change,
+		csb->deleted.count * sizeof(cs->change[0]));
+	i += csb->deleted.count;
+	memcpy(cs->change + i, csb->added.change,
+		csb->added.count * sizeof(cs->change[0]));
+	i += csb->added.count;
+	memcpy(cs->change + i, csb->refs.change,
+		csb->refs.count * sizeof(cs->change[0]));
+	free(csb->deleted.change);
+	free(csb->added.change);
+	free(csb->refs.change);
+
+	for(i = 0; i < cs->count; i++) {
+		switch(cs->change[i].kind) {
+		case NCNF_CHANGE_ADD: cs->added++; break;
+		case NCNF_CHANGE_MODIFY: cs->modified++; break;
+		case NCNF_CHANGE_DELETE: cs->deleted++; break;
 		}
+	}
 
+	*changes = cs;
+	return 0;
+}
+
+static int
+_ncnf_diff_changeset(struct diff_list *dl, struct ncnf_changeset **changes) {
+	struct cs_builder csb;
+	int ret = 0;
+	int i;
+
+	memset(&csb, 0, sizeof(csb));
+
+	for(i = 0; ret == 0 && i < dl->count; i++) {
+		struct ncnf_obj_s *obj = dl->obj[i];
+
+		/* Attributes are described by their parent */
+		if(obj->obj_class == NOBJ_ATTRIBUTE)
+			continue;
+
+		switch(obj->dmark) {
+		case DT_DELETED:
+			ret = _cs_add(&csb.deleted, NCNF_CHANGE_DELETE,
+				obj, NULL);
+			break;
+		case DT_ADDED:
+			ret = _cs_added_tree(&csb, obj);
+			break;
+		case DT_CHANGED:
+			if(_NOBJ_CONTAINER(obj))
+				ret = _cs_attributes(&csb, obj);
+			else if(obj->obj_class == NOBJ_REFERENCE
+				&& obj->m_new_ref_type)
+				ret = _cs_add(&csb.refs, NCNF_CHANGE_MODIFY,
+					obj, NULL);
+			break;
+		}
 	}
 
+	return _cs_finish(&csb, ret, changes);
+}
 
-	obj->mark = 0;
-	return 0;
+/*
+ * Describe the differences found by _ncnf_diff_match(),
+ * without marking the trees.
+ */
+static int
+__ncnf_cs_deleted(void *key, struct ncnf_obj_s *oobj,
+		enum collections_e c, int pos) {
+	struct cs_builder *csb = key;
+	struct ncnf_obj_s *ent = oobj->m_collection[c].entry[pos].object;
+
+	if(ent->obj_class == NOBJ_ATTRIBUTE)
+		return _cs_attr_push(csb, ent, pos, 1);
+	return _cs_add(&csb->deleted, NCNF_CHANGE_DELETE, ent, NULL);
 }
 
 static int
-__ncnf_diff_set_mark_func(struct ncnf_obj_s *obj, void *markv) {
-	obj->mark = (int)markv;
+__ncnf_cs_reference(void *key, struct ncnf_obj_s *oobj,
+		enum collections_e c, int pos, struct ncnf_obj_s *nent) {
+	struct cs_builder *csb = key;
+	struct ncnf_obj_s *ent = oobj->m_collection[c].entry[pos].object;
+
+	if(strcmp(ent->m_ref_value, nent->m_ref_value)
+	|| strcmp(ent->m_ref_type, nent->m_ref_type))
+		return _cs_add(&csb->refs, NCNF_CHANGE_MODIFY, nent, ent);
 	return 0;
 }
 
+static int
+__ncnf_cs_added(void *key, struct ncnf_obj_s *oobj,
+		enum collections_e c, int pos, struct ncnf_obj_s *nent) {
+	struct cs_builder *csb = key;
+
+	(void)oobj;
+	(void)c;
+
+	if(nent->obj_class == NOBJ_ATTRIBUTE)
+		return _cs_attr_push(csb, nent, pos, 0);
+	return _cs_added_tree(csb, nent);
+}
+
+static int
+__ncnf_cs_done(void *key, struct ncnf_obj_s *oobj, enum collections_e c) {
+	struct cs_builder *csb = key;
+
+	(void)oobj;
+	(void)c;
+
+	return csb->attr_count ? _cs_attr_pairs(csb) : 0;
+}
+
+int
+_ncnf_diff_compare(struct ncnf_obj_s *old_tree, struct ncnf_obj_s *new_tree,
+		struct ncnf_changeset **changes) {
+	struct cs_builder csb;
+	int ret = 0;
+
+	memset(&csb, 0, sizeof(csb));
+
+	if(old_tree == NULL) {
+		enum collections_e c;
+		int i;
+
+		/* Everything is new */
+		for(c = COLLECTION_ATTRIBUTES; c <= COLLECTION_OBJECTS; c++) {
+			collection_t *ncoll = &new_tree->m_collection[c];
+			for(i = 0; ret == 0 && i < ncoll->entries; i++)
+				ret = _cs_added_tree(&csb,
+					ncoll->entry[i].object);
+		}
+	} else if(_ncnf_fingerprint(old_tree)
+			!= _ncnf_fingerprint(new_tree)) {
+		struct diff_match dm = {
+			__ncnf_cs_deleted,
+			__ncnf_cs_reference,
+			__ncnf_cs_added,
+			__ncnf_cs_done,
+			&csb
+		};
+
+		ret = _ncnf_diff_match(&dm, old_tree, new_tree);
+	}
+
+	return _cs_finish(&csb, ret, changes);
+}
+
+void
+_ncnf_changeset_free(struct ncnf_changeset *cs) {
+	int i;
 
+	for(i = 0; i < cs->count; i++)
+		_cs_record_free(&cs->change[i]);
+	free(cs->change);
+	free(cs);
+}
 
 static int
-__ncnf_diff_cleanup_leaf(struct ncnf_obj_s *obj, void *key) {
+__ncnf_diff_invoke_notificators(struct ncnf_obj_s *obj, void *key) {
+
+	(void)key;
+
+	/*
+	 * General notifications.
+	 */
+
+	if(obj->cold && obj->cold->notify) {
+		switch(obj->dmark) {
+		case DT_CHANGED:
+			obj->cold->notify((ncnf_obj *)obj, NCNF_OBJ_CHANGE,
+				obj->cold->notify_key);
+			break;
+		case DT_DELETED:
+			obj->cold->notify((ncnf_obj *)obj, NCNF_OBJ_DESTROY,
+				obj->cold->notify_key);
+			break;
+		}
+	}
+
+
+	return 0;
+}
+
+static int
+__ncnf_diff_mark_deleted(struct ncnf_obj_s *obj, void *key) {
+	(void)key;
+	obj->dmark = DT_DELETED;
+	return 0;
+}
+
+static int
+__ncnf_diff_unmark(struct ncnf_obj_s *obj, void *key) {
 
 	(void)key;
 
 	/* Clear mark */
-	obj->mark = DT_UNMODIFIED;
+	obj->dmark = DT_UNMODIFIED;
 
 	/* Clear side reference data. */
 	if(obj->obj_class == NOBJ_REFERENCE) {
@@ -458,4 +1628,3 @@ __ncnf_diff_cleanup_leaf(struct ncnf_obj_s *obj, void *key) {
 	}
 	return 0;
 }
-
@@ -31,6 +31,67 @@
 #ifndef	__NCNF_DIFF_H__
 #define	__NCNF_DIFF_H__
 
-int _ncnf_diff(struct ncnf_obj_s *old_root, struct ncnf_obj_s *new_root);
+struct ncnf_changeset;	/* Defined in ncnf.h */
+
+/*
+ * If changes is not NULL, the change set is returned there as well.
+ */
+int _ncnf_diff(struct ncnf_obj_s *old_root, struct ncnf_obj_s *new_root,
+	struct ncnf_changeset **changes);
+void _ncnf_changeset_free(struct ncnf_changeset *);
+
+/*
+ * The same diff, in two steps. Preparing only reads the old tree
+ * (its fingerprint must already be computed) and clones the additions,
+ * into the old tree's region if in_place is set, or into a region
+ * of its own otherwise. Commit applies the staged changes; it fails
+ * with ESTALE if the old tree has changed since. Both commit and
+ * abort free the stage.
+ */
+struct ncnf_diff_stage *_ncnf_diff_prepare(struct ncnf_obj_s *old_root,
+	struct ncnf_obj_s *new_root, int in_place);
+int _ncnf_diff_commit(struct ncnf_diff_stage *,
+	struct ncnf_changeset **changes);
+void _ncnf_diff_abort(struct ncnf_diff_stage *);
+
+/*
+ * Describe the changes _ncnf_diff() would make, without modifying
+ * either tree, so both may be read by other threads meanwhile.
+ * The fingerprints of both trees must already be computed.
+ * A NULL old_root stands for the empty configuration.
+ */
+int _ncnf_diff_compare(struct ncnf_obj_s *old_root,
+	struct ncnf_obj_s *new_root, struct ncnf_changeset **changes);
+
+/*
+ * Structural fingerprint of the subtree: type, value and class of the
+ * object, its attributes, nested objects and reference targets.
+ * The order of the entries does not matter, same as for the diff.
+ * Containers cache their fingerprints, along with the number of
+ * references below them; the missing ones are computed on demand.
+ * Never returns 0.
+ */
+uint64_t _ncnf_fingerprint(struct ncnf_obj_s *obj);
+
+/*
+ * Forget the cached fingerprints of the object and all its parents.
+ * Must be called whenever the object is modified in place.
+ */
+void _ncnf_fingerprint_invalidate(struct ncnf_obj_s *obj);
+
+/*
+ * Find the complex object of the same type and value within the
+ * container of another tree (the one _ncnf_diff() would match it with).
+ * Returns NULL if there is none, or if other_parent is NULL.
+ */
+struct ncnf_obj_s *_ncnf_diff_counterpart(struct ncnf_obj_s *other_parent,
+	struct ncnf_obj_s *obj);
+
+/*
+ * Whether the subtree is the same as its counterpart (which may be NULL),
+ * judging by the fingerprints.
+ */
+int _ncnf_diff_unchanged(struct ncnf_obj_s *obj,
+	struct ncnf_obj_s *counterpart);
 
 #endif	/* __NCNF_DIFF_H__ */
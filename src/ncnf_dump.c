@@ -91,16 +91,20 @@ _display_value(FILE *f, const char *value) {
 
 void
 _ncnf_obj_dump_recursive(FILE *f, struct ncnf_obj_s *obj,
-		const char *flatten_type, int marked_only,
+		const char *flatten_type,
+		int (*opt_filter)(struct ncnf_obj_s *, void *), void *opt_key,
 		int verbose, int indent, int indent_shift, int single_level,
 		int *ret_rsize
 ) {
 	int cc;
-	int recursive_size = sizeof(*obj);
+	int recursive_size = _ncnf_obj_size(obj->obj_class);
 
 	assert(obj->obj_class != NOBJ_INVALID);
 
-	if(marked_only && !obj->mark)		/* Skip unmarked entries */
+	if(obj->cold)
+		recursive_size += sizeof(struct ncnf_obj_cold_s);
+
+	if(opt_filter && !opt_filter(obj, opt_key))	/* Skip filtered out */
 		return;
 
 	if(obj->obj_class != NOBJ_ROOT)
@@ -191,7 +195,7 @@ _ncnf_obj_dump_recursive(FILE *f, struct ncnf_obj_s *obj,
 				) continue;
 
 				_ncnf_obj_dump_recursive(f, child, 0,
-					marked_only,
+					opt_filter, opt_key,
 					verbose,
 					indent + (obj->type?indent_shift:0),
 					indent_shift, flatten_type ? 1 : 0,
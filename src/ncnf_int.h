@@ -31,12 +31,15 @@
 #ifndef	__NCNF_INT_H__
 #define	__NCNF_INT_H__
 
+#include <stdint.h>
 #include <bstr.h>
 
 #include "ncnf_coll.h"
 #include "ncnf_notif.h"
 #include "ncnf_walk.h"
 #include "ncnf_diff.h"
+#include "ncnf_mr.h"
+#include "ncnf_atom.h"
 
 enum obj_class {
 	NOBJ_INVALID	= 0,	/* INVALID */
@@ -58,43 +61,64 @@ enum collections_e {
 	MAX_COLLECTIONS		= 4,
 };
 
+/*
+ * Rarely used properties, allocated on demand.
+ */
+struct ncnf_obj_cold_s {
+	/* For building run-time chains */
+	struct ncnf_obj_s *chain_next;
+	struct ncnf_obj_s *chain_cur;
+
+	/*
+	 * User callbacks and data
+	 */
+	int  (*notify)(ncnf_obj *, enum ncnf_notify_event, void *notify_key);
+	void *notify_key;
+	void *user_data;
+
+	int uses;	/* Someone relies on this. Used by ncnf-strip */
+};
+
 struct ncnf_obj_s {
 	/*
-	 * Common header
+	 * Common header: everything the lookups and tree walks need.
 	 */
 	enum obj_class obj_class;
+	int config_line;
+
+	int mark;	/* Sometimes we need to mark object somehow */
+	short flags;	/* Class-specific flags, see m_*_flags below */
+	short dmark;	/* Diff state, zero outside of _ncnf_diff() */
 
 	bstr_t type;
+	ncnf_atom_t type_atom;	/* Interned type, see ncnf_atom.h */
 	bstr_t value;
 
 	struct ncnf_obj_s *parent;
-	int config_line;
 
-	/* For building run-time chains */
-	struct ncnf_obj_s *chain_next;
-	struct ncnf_obj_s *chain_cur;
+	void *mr;	/* Allocated in this memory region (optional) */
 
-	/*
-	 * User callbacks and data
-	 */
-	int  (*notify)(ncnf_obj *, enum ncnf_notify_event, void *notify_key);
-	void *notify_key;
-	void *user_data;
+	struct ncnf_obj_cold_s *cold;	/* See _ncnf_obj_cold() */
 
 	/****************************
 	* Class-specific properties *
 	****************************/
 
+	/*
+	 * Only the part used by the object class is allocated,
+	 * see _ncnf_obj_size().
+	 */
 	union {
 		struct {
 			/*
 			 * Properties for NOBJ_COMPLEX and NOBJ_ROOT
 			 */
 			collection_t collection[MAX_COLLECTIONS];
+			uint64_t fingerprint;	/* 0 if unknown */
+			int refs;	/* References below, with fingerprint */
+			/* NOBJ_ROOT: vr_config id it was validated with */
+			unsigned int rules;
 		} property_CONTAINER;
-		struct {
-			int attr_flags;	/* &1 = not resolved */
-		} property_ATTRIBUTE;
 		struct {
 			/*
 			 * Properties for NOBJ_ITERATOR
@@ -108,7 +132,6 @@ struct ncnf_obj_s {
 			 */
 			bstr_t ref_type;
 			bstr_t ref_value;
-			int ref_flags;	/* &1 = Dependent */
 
 			bstr_t new_ref_type;
 			bstr_t new_ref_value;
@@ -119,41 +142,37 @@ struct ncnf_obj_s {
 			 */
 			struct ncnf_obj_s *direct_reference;
 		} property_REFERENCE;
-		struct {
-			/*
-			 * Properties for NOBJ_INSERTION
-			 */
-			int insert_flags;	/* &1 = inheritance */
-		} property_INSERTION;
 	} un;
 #define	m_collection	un.property_CONTAINER.collection
-#define	m_attr_flags	un.property_ATTRIBUTE.attr_flags
+#define	m_fingerprint	un.property_CONTAINER.fingerprint
+#define	m_refs	un.property_CONTAINER.refs
+#define	m_rules	un.property_CONTAINER.rules
+#define	m_attr_flags	flags	/* &1 = not resolved */
 #define	m_iterator_collection	un.property_ITERATOR.iterator_collection
 #define	m_iterator_position	un.property_ITERATOR.iterator_position
 #define	m_ref_type	un.property_REFERENCE.ref_type
 #define	m_ref_value	un.property_REFERENCE.ref_value
-#define	m_ref_flags	un.property_REFERENCE.ref_flags
+#define	m_ref_flags	flags	/* &1 = Dependent */
 #define	m_new_ref_type	un.property_REFERENCE.new_ref_type
 #define	m_new_ref_value	un.property_REFERENCE.new_ref_value
 #define	m_direct_reference	un.property_REFERENCE.direct_reference
-#define	m_insert_flags	un.property_INSERTION.insert_flags
-
-	/*
-	 * Auxiliary temporary variables.
-	 */
-
-	int mark;	/* Sometimes we need to mark object somehow */
-
-	int uses;	/* Someone relies on this. Used by ncnf-strip */
-
-	void *mr;	/* Allocated in this memory region (optional) */
+#define	m_insert_flags	flags	/* &1 = inheritance */
 };
 
+/*
+ * Cold properties of the object, or the default if none were ever set.
+ */
+#define	_NOBJ_COLD(obj, field, dflt)	\
+	((obj)->cold ? (obj)->cold->field : (dflt))
+
 #include "ncnf_constr.h"
 
 
-/* Recursively dump the object tree */
-void _ncnf_obj_dump_recursive(FILE *f, struct ncnf_obj_s *obj, const char *flatten_type, int marked_only, int verbose, int indent, int indent_shift, int single_level, int *recursive_size);
+/*
+ * Recursively dump the object tree.
+ * If opt_filter is given, only the objects it returns non-zero for are shown.
+ */
+void _ncnf_obj_dump_recursive(FILE *f, struct ncnf_obj_s *obj, const char *flatten_type, int (*opt_filter)(struct ncnf_obj_s *, void *), void *opt_key, int verbose, int indent, int indent_shift, int single_level, int *recursive_size);
 
 void _ncnf_debug_print(int, const char *, ...)
 	__attribute__ ((format (printf, 2, 3) ));
@@ -0,0 +1,428 @@
+/*
+ * Copyright (c) 2001, 2002, 2003, 2004, 2005  Netli, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * $Id$
+ */
+/*
+ * Memory region: chunked allocator for the configuration tree.
+ *
+ * The configuration tree consists of a large number of small objects,
+ * collections and strings, which are all created at once during parsing
+ * and mostly destroyed at once as well. Allocating them from a few big
+ * chunks reduces the malloc(3) overhead and fragmentation, improves
+ * locality of the tree walks and makes destruction of the whole tree
+ * a matter of releasing a handful of chunks.
+ */
+#include "headers.h"
+#include "ncnf_int.h"
+
+#define	MR_ALIGN		16	/* Alignment of every allocation */
+#define	MR_ROUND(size)		(((size) + MR_ALIGN - 1) & ~(MR_ALIGN - 1))
+#define	MR_HDR(type)		MR_ROUND(sizeof(type))
+
+#define	MR_CHUNK_MIN		(16 * 1024)	/* Initial chunk size */
+#define	MR_CHUNK_MAX		(1024 * 1024)	/* Chunk size limit */
+
+/*
+ * Size classes:
+ * 	0..31	16..512 bytes, in steps of MR_ALIGN;
+ * 	32..38	1K..64K, powers of two.
+ * Larger blocks are allocated individually.
+ */
+#define	MR_SMALL_MAX		512
+#define	MR_MEDIUM_MAX		(64 * 1024)
+#define	MR_SMALL_CLASSES	(MR_SMALL_MAX / MR_ALIGN)
+#define	MR_CLASSES		(MR_SMALL_CLASSES + 7)
+
+struct mr_chunk {
+	struct mr_chunk *next;
+	size_t size;		/* Usable size */
+	size_t used;
+};
+
+struct mr_large {
+	struct mr_large *next;
+	struct mr_large *prev;
+};
+
+struct mr_free {
+	struct mr_free *next;
+};
+
+struct ncnf_mr {
+	bstr_allocator_t bstr_alloc;	/* Must be the first member */
+	enum ncnf_mr_flags flags;
+
+	struct mr_chunk *chunks;	/* Current chunk first */
+	size_t next_chunk_size;
+
+	struct mr_free *free_list[MR_CLASSES];
+	struct mr_large *large;
+	size_t size;		/* Memory obtained from malloc(3) */
+
+	struct ncnf_obj_s *owner;
+	int notified;
+
+	/* Mapped snapshot image, see _ncnf_mr_attach_image() */
+	char *image;
+	size_t image_size;
+};
+
+static void *_ncnf_mr_bstr_alloc(bstr_allocator_t *, int size);
+static void _ncnf_mr_bstr_release(bstr_allocator_t *, void *mem, int size);
+
+void *
+_ncnf_mr_new(enum ncnf_mr_flags flags) {
+	struct ncnf_mr *mr;
+
+	if(!(flags & NMR_ENABLED))
+		return NULL;
+
+	mr = calloc(1, sizeof(*mr));
+	if(mr == NULL)
+		return NULL;
+
+	mr->bstr_alloc.alloc = _ncnf_mr_bstr_alloc;
+	mr->bstr_alloc.release = _ncnf_mr_bstr_release;
+	mr->flags = flags;
+	mr->next_chunk_size = MR_CHUNK_MIN;
+
+	return mr;
+}
+
+enum ncnf_mr_flags
+_ncnf_mr_flags(void *mrp) {
+	struct ncnf_mr *mr = mrp;
+	return mr ? mr->flags : NMR_DISABLED;
+}
+
+void
+_ncnf_mr_destroy(void *mrp) {
+	struct ncnf_mr *mr = mrp;
+	struct mr_chunk *chunk;
+	struct mr_large *large;
+
+	if(mr == NULL)
+		return;
+
+	while((chunk = mr->chunks)) {
+		mr->chunks = chunk->next;
+		free(chunk);
+	}
+
+	while((large = mr->large)) {
+		mr->large = large->next;
+		free(large);
+	}
+
+	if(mr->image)
+		munmap(mr->image, mr->image_size);
+
+	free(mr);
+}
+
+/*
+ * Determine the size class for the given allocation size.
+ * Returns -1 for blocks which are too large to be kept in chunks.
+ */
+static int
+_ncnf_mr_class(size_t size, size_t *class_size) {
+	size_t csize;
+	int cls;
+
+	if(size <= MR_SMALL_MAX) {
+		csize = size ? MR_ROUND(size) : MR_ALIGN;
+		*class_size = csize;
+		return csize / MR_ALIGN - 1;
+	}
+
+	if(size > MR_MEDIUM_MAX)
+		return -1;
+
+	for(cls = MR_SMALL_CLASSES, csize = 2 * MR_SMALL_MAX;
+		csize < size; cls++, csize <<= 1);
+
+	*class_size = csize;
+	return cls;
+}
+
+/*
+ * Cut the memory from the current chunk, allocating a new one
+ * if there is not enough space left.
+ */
+static void *
+_ncnf_mr_carve(struct ncnf_mr *mr, size_t size) {
+	struct mr_chunk *chunk = mr->chunks;
+	void *p;
+
+	if(chunk == NULL || (chunk->size - chunk->used) < size) {
+		size_t chunk_size = mr->next_chunk_size;
+
+		while(chunk_size < size)
+			chunk_size <<= 1;
+
+		chunk = malloc(MR_HDR(struct mr_chunk) + chunk_size);
+		if(chunk == NULL)
+			return NULL;
+		chunk->size = chunk_size;
+		chunk->used = 0;
+		chunk->next = mr->chunks;
+		mr->chunks = chunk;
+		mr->size += chunk_size;
+
+		if(mr->next_chunk_size < MR_CHUNK_MAX)
+			mr->next_chunk_size <<= 1;
+	}
+
+	p = (char *)chunk + MR_HDR(struct mr_chunk) + chunk->used;
+	chunk->used += size;
+
+	return p;
+}
+
+void *
+_ncnf_mr_alloc(void *mrp, size_t size) {
+	struct ncnf_mr *mr = mrp;
+	struct mr_large *large;
+	size_t csize;
+	void *p;
+	int cls;
+
+	if(mr == NULL)
+		return calloc(1, size ? size : 1);
+
+	cls = _ncnf_mr_class(size, &csize);
+	if(cls == -1) {
+		large = calloc(1, MR_HDR(struct mr_large) + size);
+		if(large == NULL)
+			return NULL;
+		large->next = mr->large;
+		if(mr->large)
+			mr->large->prev = large;
+		mr->large = large;
+		mr->size += size;
+		return (char *)large + MR_HDR(struct mr_large);
+	}
+
+	if(mr->free_list[cls]) {
+		p = mr->free_list[cls];
+		mr->free_list[cls] = mr->free_list[cls]->next;
+	} else {
+		p = _ncnf_mr_carve(mr, csize);
+		if(p == NULL)
+			return NULL;
+	}
+
+	memset(p, 0, csize);
+
+	return p;
+}
+
+void
+_ncnf_mr_free(void *mrp, void *ptr, size_t size) {
+	struct ncnf_mr *mr = mrp;
+	struct mr_free *fr;
+	size_t csize;
+	int cls;
+
+	if(ptr == NULL)
+		return;
+
+	if(mr == NULL) {
+		free(ptr);
+		return;
+	}
+
+	cls = _ncnf_mr_class(size, &csize);
+	if(cls == -1) {
+		struct mr_large *large = (struct mr_large *)
+			((char *)ptr - MR_HDR(struct mr_large));
+		if(large->prev)
+			large->prev->next = large->next;
+		else
+			mr->large = large->next;
+		if(large->next)
+			large->next->prev = large->prev;
+		free(large);
+		mr->size -= size;
+		return;
+	}
+
+	fr = ptr;
+	fr->next = mr->free_list[cls];
+	mr->free_list[cls] = fr;
+}
+
+void *
+_ncnf_mr_realloc(void *mrp, void *ptr, size_t old_size, size_t new_size) {
+	struct ncnf_mr *mr = mrp;
+	size_t old_csize, new_csize;
+	int old_cls, new_cls;
+	void *p;
+
+	if(mr == NULL)
+		return realloc(ptr, new_size);
+
+	if(ptr == NULL)
+		return _ncnf_mr_alloc(mr, new_size);
+
+	old_cls = _ncnf_mr_class(old_size, &old_csize);
+	new_cls = _ncnf_mr_class(new_size, &new_csize);
+
+	if(old_cls == -1 && new_cls == -1) {
+		/* Both are large: resize in place */
+		struct mr_large *large = (struct mr_large *)
+			((char *)ptr - MR_HDR(struct mr_large));
+		struct mr_large *nl;
+
+		nl = realloc(large, MR_HDR(struct mr_large) + new_size);
+		if(nl == NULL)
+			return NULL;
+		if(nl->prev)
+			nl->prev->next = nl;
+		else
+			mr->large = nl;
+		if(nl->next)
+			nl->next->prev = nl;
+		mr->size += new_size - old_size;
+		return (char *)nl + MR_HDR(struct mr_large);
+	}
+
+	if(old_cls == new_cls && old_cls != -1)
+		/* Fits into the same block */
+		return ptr;
+
+	p = _ncnf_mr_alloc(mr, new_size);
+	if(p == NULL)
+		return NULL;
+	memcpy(p, ptr, old_size < new_size ? old_size : new_size);
+	_ncnf_mr_free(mr, ptr, old_size);
+
+	return p;
+}
+
+bstr_t
+_ncnf_mr_str(void *mrp, const char *str, int len) {
+	struct ncnf_mr *mr = mrp;
+
+	if(mr && (mr->flags & NMR_STRINGS))
+		return str2bstr_a(&mr->bstr_alloc, str, len);
+
+	return str2bstr(str, len);
+}
+
+bstr_t
+_ncnf_mr_strref(void *mrp, bstr_t str) {
+	struct ncnf_mr *mr = mrp;
+	bstr_allocator_t *target;
+
+	if(str == NULL)
+		return NULL;
+
+	target = (mr && (mr->flags & NMR_STRINGS)) ? &mr->bstr_alloc : NULL;
+
+	if(bstr_allocator(str) == target)
+		return bstr_ref(str);
+
+	return str2bstr_a(target, str, bstr_len(str));
+}
+
+int
+_ncnf_mr_attach_image(void *mrp, void *base, size_t size) {
+	struct ncnf_mr *mr = mrp;
+
+	if(mr == NULL || mr->image) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	mr->image = base;
+	mr->image_size = size;
+
+	return 0;
+}
+
+bstr_t
+_ncnf_mr_str_place(void *mrp, void *mem, int len) {
+	struct ncnf_mr *mr = mrp;
+
+	assert(mr && (mr->flags & NMR_STRINGS));
+	assert((char *)mem >= mr->image
+		&& (char *)mem + len < mr->image + mr->image_size);
+
+	return bstr_place(&mr->bstr_alloc, mem, len);
+}
+
+void
+_ncnf_mr_set_owner(void *mrp, struct ncnf_obj_s *owner) {
+	struct ncnf_mr *mr = mrp;
+	if(mr) mr->owner = owner;
+}
+
+struct ncnf_obj_s *
+_ncnf_mr_owner(void *mrp) {
+	struct ncnf_mr *mr = mrp;
+	return mr ? mr->owner : NULL;
+}
+
+size_t
+_ncnf_mr_size(void *mrp) {
+	struct ncnf_mr *mr = mrp;
+	return mr ? mr->size : 0;
+}
+
+void
+_ncnf_mr_set_notified(void *mrp) {
+	struct ncnf_mr *mr = mrp;
+	if(mr) mr->notified = 1;
+}
+
+int
+_ncnf_mr_notified(void *mrp) {
+	struct ncnf_mr *mr = mrp;
+	return mr ? mr->notified : 1;
+}
+
+/*
+ * Allocator interface for the basic strings.
+ */
+
+static void *
+_ncnf_mr_bstr_alloc(bstr_allocator_t *alloc, int size) {
+	return _ncnf_mr_alloc((struct ncnf_mr *)alloc, size);
+}
+
+static void
+_ncnf_mr_bstr_release(bstr_allocator_t *alloc, void *mem, int size) {
+	struct ncnf_mr *mr = (struct ncnf_mr *)alloc;
+
+	/* Strings placed inside the image are not ours to recycle */
+	if((char *)mem >= mr->image
+	&& (char *)mem < mr->image + mr->image_size)
+		return;
+
+	_ncnf_mr_free(mr, mem, size);
+}
+
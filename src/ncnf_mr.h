@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2001, 2002, 2003, 2004, 2005  Netli, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * $Id$
+ */
+/*
+ * Memory region: a simple chunked allocator used to place the whole
+ * configuration tree (objects, collections and, optionally, strings)
+ * into a handful of large memory blocks.
+ */
+#ifndef	__NCNF_MR_H__
+#define	__NCNF_MR_H__
+
+#include <bstr.h>
+
+struct ncnf_obj_s;	/* Forward declaration */
+
+enum ncnf_mr_flags {
+	NMR_DISABLED	= 0,	/* Do not use memory region at all */
+	NMR_ENABLED	= 1,	/* Objects and collections go to the region */
+	NMR_STRINGS	= 2,	/* Strings are also placed into the region */
+};
+
+/*
+ * Create a new memory region.
+ * Returns NULL if (flags == NMR_DISABLED) or memory is exhausted.
+ */
+void *_ncnf_mr_new(enum ncnf_mr_flags flags);
+
+/*
+ * Get the flags the region was created with.
+ */
+enum ncnf_mr_flags _ncnf_mr_flags(void *mr);
+
+/*
+ * Destroy the region, releasing all its memory at once.
+ * Objects and strings allocated in the region become invalid.
+ */
+void _ncnf_mr_destroy(void *mr);
+
+/*
+ * Allocate zeroed memory from the region, or calloc(3) it if mr is NULL.
+ */
+void *_ncnf_mr_alloc(void *mr, size_t size);
+
+/*
+ * Return the memory back to the region (or free(3) it if mr is NULL).
+ * The size must be the same as was given to _ncnf_mr_alloc().
+ */
+void _ncnf_mr_free(void *mr, void *ptr, size_t size);
+
+/*
+ * Resize the previously allocated block.
+ * Newly added space is NOT zeroed.
+ */
+void *_ncnf_mr_realloc(void *mr, void *ptr, size_t old_size, size_t new_size);
+
+/*
+ * Create a new string suitable to be stored inside the region's object.
+ */
+bstr_t _ncnf_mr_str(void *mr, const char *str, int len);
+
+/*
+ * Obtain a reference to the string for storing it inside the region's
+ * object. Strings belonging to other regions are copied, so no region
+ * ever refers to memory of another one.
+ */
+bstr_t _ncnf_mr_strref(void *mr, bstr_t str);
+
+/*
+ * Make the region responsible for the mmap(2)'ed image memory:
+ * it is unmapped when the region is destroyed.
+ * Only one image may be attached to the region.
+ */
+int _ncnf_mr_attach_image(void *mr, void *base, size_t size);
+
+/*
+ * Turn the string stored inside the attached image into the
+ * region's string, without copying (see bstr_place()).
+ * The region must have been created with NMR_STRINGS.
+ */
+bstr_t _ncnf_mr_str_place(void *mr, void *mem, int len);
+
+/*
+ * The object which is responsible for the region's lifetime.
+ * Destruction of the owner destroys the whole region.
+ */
+void _ncnf_mr_set_owner(void *mr, struct ncnf_obj_s *owner);
+struct ncnf_obj_s *_ncnf_mr_owner(void *mr);
+
+/*
+ * The amount of memory the region has obtained from the system,
+ * not counting the attached image.
+ */
+size_t _ncnf_mr_size(void *mr);
+
+/*
+ * Mark the region as having objects with notificators attached.
+ * Such trees must be walked upon destruction to deliver the events.
+ */
+void _ncnf_mr_set_notified(void *mr);
+int _ncnf_mr_notified(void *mr);
+
+#endif	/* __NCNF_MR_H__ */
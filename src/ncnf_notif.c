@@ -33,8 +33,9 @@ static int
 _ncnf_notify_callback(struct ncnf_obj_s *obj, void *eventp) {
 	enum ncnf_notify_event event = *(enum ncnf_notify_event *)eventp;
 
-	if(obj->notify)
-		obj->notify((ncnf_obj *)obj, event, obj->notify_key);
+	if(obj->cold && obj->cold->notify)
+		obj->cold->notify((ncnf_obj *)obj, event,
+			obj->cold->notify_key);
 
 	return 0;
 }
@@ -60,6 +61,7 @@ _ncnf_lazy_notificator(struct ncnf_obj_s *obj, const char *watchfor,
 		void *key) {
 	collection_t *coll;
 	struct ncnf_obj_s *ln;
+	struct ncnf_obj_cold_s *cold;
 	int (*old_notify)(ncnf_obj *, enum ncnf_notify_event, void *);
 	void *old_notify_key;
 	int adding = 0;
@@ -79,9 +81,9 @@ _ncnf_lazy_notificator(struct ncnf_obj_s *obj, const char *watchfor,
 
 	wf = str2bstr(watchfor, -1);
 	if(!wf) return -1;
-	ln = _ncnf_coll_get(coll, 0, wf, NULL, NULL);
+	ln = _ncnf_coll_get(obj->mr, coll, 0, wf, NULL, NULL);
 	if(ln == NULL) {
-		ln = _ncnf_obj_new(0, NOBJ_LAZY_NOTIF, wf, NULL, 0);
+		ln = _ncnf_obj_new(obj->mr, NOBJ_LAZY_NOTIF, wf, NULL, 0);
 		bstr_free(wf);
 		if(ln == NULL)
 			return -1;
@@ -90,16 +92,23 @@ _ncnf_lazy_notificator(struct ncnf_obj_s *obj, const char *watchfor,
 		bstr_free(wf);
 	}
 
-	old_notify = ln->notify;
-	old_notify_key = ln->notify_key;
-	ln->notify = NULL;
+	cold = _ncnf_obj_cold(ln);
+	if(cold == NULL) {
+		if(adding)
+			_ncnf_obj_destroy(ln);
+		return -1;
+	}
+
+	old_notify = cold->notify;
+	old_notify_key = cold->notify_key;
+	cold->notify = NULL;
 
 	/* Report detach to the old function */
 	if(old_notify) {
 		if(old_notify((ncnf_obj *)obj,
 			NCNF_NOTIF_DETACH, old_notify_key) == -1) {
-			ln->notify = old_notify;
-			ln->notify_key = old_notify_key;
+			cold->notify = old_notify;
+			cold->notify_key = old_notify_key;
 			if(adding)
 				_ncnf_obj_destroy(ln);
 			errno = EPERM;
@@ -107,15 +116,17 @@ _ncnf_lazy_notificator(struct ncnf_obj_s *obj, const char *watchfor,
 		}
 	}
 
-	ln->notify = notify;
-	ln->notify_key = key;
+	cold->notify = notify;
+	cold->notify_key = key;
+	if(notify)
+		_ncnf_mr_set_notified(obj->mr);
 
 	/* Report attach to the new one */
-	if(ln->notify) {
+	if(cold->notify) {
 		if(notify((ncnf_obj *)obj,
 			NCNF_NOTIF_ATTACH, key) == -1) {
-			obj->notify = NULL;
-			obj->notify_key = NULL;
+			cold->notify = NULL;
+			cold->notify_key = NULL;
 			if(adding)
 				_ncnf_obj_destroy(ln);
 			errno = EPERM;
@@ -139,7 +150,7 @@ _ncnf_lazy_notificator(struct ncnf_obj_s *obj, const char *watchfor,
 
 
 void
-_ncnf_check_lazy_filters(struct ncnf_obj_s *obj, int only_mark_value) {
+_ncnf_check_lazy_filters(struct ncnf_obj_s *obj, int only_dmark_value) {
 	collection_t *coll;
 	collection_t *ncoll;
 	int i, j;
@@ -151,15 +162,15 @@ _ncnf_check_lazy_filters(struct ncnf_obj_s *obj, int only_mark_value) {
 
 	coll = &obj->m_collection[COLLECTION_LAZY_NOTIF];
 	for(i = 0; i < coll->entries; i++) {
-		char *watchfor = NULL;
+		ncnf_atom_t watchfor = NULL;
 		struct ncnf_obj_s *o = coll->entry[i].object;
 
 		/* Lazy notificator has no notificator function */
-		if(o->notify == NULL)
+		if(_NOBJ_COLD(o, notify, NULL) == NULL)
 			continue;
 
 		if(strcmp(o->type, MASK_ALL_OBJECTS))
-			watchfor = o->type;
+			watchfor = o->type_atom;
 
 		/* Check objects */
 
@@ -168,16 +179,17 @@ _ncnf_check_lazy_filters(struct ncnf_obj_s *obj, int only_mark_value) {
 			struct ncnf_obj_s *child
 				= ncoll->entry[j].object;
 
-			if(child->mark != only_mark_value
-				&& only_mark_value != -1)
+			if(child->dmark != only_dmark_value
+				&& only_dmark_value != -1)
 				continue;
 
-			if(watchfor && strcmp(child->type, watchfor))
+			if(watchfor && child->type_atom != watchfor)
 				continue;
 
-			if(_ncnf_real_object(child)->notify == NULL)
-				o->notify((ncnf_obj *)child, NCNF_OBJ_ADD,
-					o->notify_key);
+			if(_NOBJ_COLD(_ncnf_real_object(child),
+					notify, NULL) == NULL)
+				o->cold->notify((ncnf_obj *)child,
+					NCNF_OBJ_ADD, o->cold->notify_key);
 		}
 
 		/* Check attributes */
@@ -187,16 +199,17 @@ _ncnf_check_lazy_filters(struct ncnf_obj_s *obj, int only_mark_value) {
 			struct ncnf_obj_s *child
 				= ncoll->entry[j].object;
 
-			if(child->mark != only_mark_value
-				&& only_mark_value != -1)
+			if(child->dmark != only_dmark_value
+				&& only_dmark_value != -1)
 				continue;
 
-			if(watchfor && strcmp(child->type, watchfor))
+			if(watchfor && child->type_atom != watchfor)
 				continue;
 
-			if(_ncnf_real_object(child)->notify == NULL)
-				o->notify((ncnf_obj *)child, NCNF_OBJ_ADD,
-					o->notify_key);
+			if(_NOBJ_COLD(_ncnf_real_object(child),
+					notify, NULL) == NULL)
+				o->cold->notify((ncnf_obj *)child,
+					NCNF_OBJ_ADD, o->cold->notify_key);
 		}
 
 	}
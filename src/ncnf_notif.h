@@ -34,6 +34,6 @@ int _ncnf_lazy_notificator(struct ncnf_obj_s *obj, const char *watchfor,
         int (*notify)(ncnf_obj *obj, enum ncnf_notify_event, void *key),
 	void *key);
 
-void _ncnf_check_lazy_filters(struct ncnf_obj_s *obj, int only_mark_value);
+void _ncnf_check_lazy_filters(struct ncnf_obj_s *obj, int only_dmark_value);
 
 #endif	/* __NCNF_NOTIF_H__ */
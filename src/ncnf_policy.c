@@ -32,52 +32,286 @@
 #define	_INSIDE_POLICY_C
 #include "ncnf_policy.h"
 
+#define	POLICIES	(sizeof(policy_descriptors) / sizeof(policy_descriptors[0]))
+
+/*
+ * Accumulated over all the runs, see ncnf_policy_stats().
+ */
+static struct policy_totals {
+	unsigned long runs;
+	unsigned long failures;
+	uint64_t nsec;
+} policy_totals[POLICIES];
+
+struct policy_nameset {
+	struct policy_name {
+		unsigned int hash;
+		unsigned int generation;	/* Current if in use */
+		size_t key;		/* Offset within the keys */
+		struct ncnf_obj_s *obj;
+	} *slot;
+	unsigned int size;		/* Power of two */
+	unsigned int count;
+	unsigned int generation;
+	char *keys;
+	size_t keys_len;
+	size_t keys_size;
+};
+
+static uint64_t
+_policy_now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+struct policy_nameset *
+_ncnf_policy_names(policy_run_t *run) {
+	struct policy_nameset *ns = run->names;
+
+	if(ns == NULL) {
+		ns = calloc(1, sizeof(*ns));
+		if(ns == NULL)
+			return NULL;
+		run->names = ns;
+	}
+
+	/* Clear the set, the stale slots are told by the generation */
+	if(++ns->generation == 0) {
+		if(ns->slot)
+			memset(ns->slot, 0, ns->size * sizeof(ns->slot[0]));
+		ns->generation = 1;
+	}
+	ns->count = 0;
+	ns->keys_len = 0;
+
+	return ns;
+}
+
+static void
+_policy_names_free(struct policy_nameset *ns) {
+	if(ns) {
+		free(ns->slot);
+		free(ns->keys);
+		free(ns);
+	}
+}
+
+char *
+_ncnf_policy_names_key(struct policy_nameset *ns, size_t len) {
+	if(ns->keys_size - ns->keys_len <= len) {
+		size_t size = ns->keys_size ? ns->keys_size : 256;
+		char *keys;
+
+		while(size - ns->keys_len <= len)
+			size <<= 1;
+		keys = realloc(ns->keys, size);
+		if(keys == NULL)
+			return NULL;
+		ns->keys = keys;
+		ns->keys_size = size;
+	}
+
+	return ns->keys + ns->keys_len;
+}
+
+static int
+_policy_names_grow(struct policy_nameset *ns) {
+	struct policy_name *slot;
+	unsigned int size;
+	unsigned int i;
+
+	size = ns->size ? ns->size << 1 : 16;
+	slot = calloc(size, sizeof(slot[0]));
+	if(slot == NULL)
+		return -1;
+
+	for(i = 0; i < ns->size; i++) {
+		struct policy_name *old = &ns->slot[i];
+		unsigned int h;
+
+		if(old->generation != ns->generation)
+			continue;
+		for(h = old->hash;
+			slot[h & (size - 1)].generation == ns->generation;
+			h++);
+		slot[h & (size - 1)] = *old;
+	}
+
+	free(ns->slot);
+	ns->slot = slot;
+	ns->size = size;
+
+	return 0;
+}
+
+int
+_ncnf_policy_names_add(struct policy_nameset *ns, struct ncnf_obj_s *obj,
+		struct ncnf_obj_s **dup) {
+	struct policy_name *slot;
+	char *key = ns->keys + ns->keys_len;
+	unsigned int hash = 2166136261U;	/* FNV-1a */
+	size_t len;
+	unsigned int h;
+
+	for(len = 0; key[len]; len++)
+		hash = (hash ^ (unsigned char)key[len]) * 16777619;
+
+	if(2 * (ns->count + 1) > ns->size && _policy_names_grow(ns))
+		return -1;
+
+	for(h = hash;; h++) {
+		slot = &ns->slot[h & (ns->size - 1)];
+		if(slot->generation != ns->generation)
+			break;
+		if(slot->hash == hash
+		&& strcmp(ns->keys + slot->key, key) == 0) {
+			*dup = slot->obj;
+			return 1;
+		}
+	}
+
+	slot->hash = hash;
+	slot->generation = ns->generation;
+	slot->key = ns->keys_len;
+	slot->obj = obj;
+	ns->keys_len += len + 1;
+	ns->count++;
+
+	return 0;
+}
+
+static void
+_policy_failed(policy_run_t *run, int line) {
+	if(line > 0) {
+		_ncnf_debug_print(1,
+			"Configuration policy \"%s\" failed at line %d",
+			run->pd->policy_description, line);
+		errno = EINVAL;
+	} else {
+		_ncnf_debug_print(1,
+			"Configuration policy \"%s\" failed",
+			run->pd->policy_description);
+	}
+	run->failures++;
+}
+
+/*
+ * Invoke all the visitors for the container, and go down the tree.
+ */
+static void
+_policy_walk(struct ncnf_obj_s *obj, struct ncnf_obj_s *baseline,
+		policy_run_t *runs, int nruns, int *errno_of_last_failure) {
+	collection_t *coll;
+	int i;
+
+	/* Checked already */
+	if(_ncnf_diff_unchanged(obj, baseline))
+		return;
+
+	for(i = 0; i < nruns; i++) {
+		policy_run_t *run = &runs[i];
+		uint64_t started;
+		int line;
+
+		if(run->pd->policy_visit == NULL)
+			continue;
+
+		started = _policy_now();
+		line = run->pd->policy_visit(obj, run);
+		run->nsec += _policy_now() - started;
+		if(line) {
+			_policy_failed(run, line);
+			*errno_of_last_failure = errno;
+		}
+	}
+
+	coll = &obj->m_collection[COLLECTION_OBJECTS];
+	for(i = 0; i < coll->entries; i++) {
+		struct ncnf_obj_s *child = coll->entry[i].object;
+		assert(child->obj_class != NOBJ_INVALID);
+		if(child->obj_class == NOBJ_COMPLEX)
+			_policy_walk(child,
+				_ncnf_diff_counterpart(baseline, child),
+				runs, nruns, errno_of_last_failure);
+	}
+}
+
 /*
  * Iterate trough defined policies.
  * For information on how to add a policy, see the ncnf_policy.h file.
  */
 int
-ncnf_policy(struct ncnf_obj_s *root) {
+ncnf_policy(struct ncnf_obj_s *root, struct ncnf_obj_s *baseline) {
 	char policy_disable_attr_name[64];
+	policy_run_t runs[POLICIES];
+	int policy_of_run[POLICIES];
 	policy_descriptor_t *pd;
-	int i;
+	int nruns = 0;
+	int visitors = 0;
 	int failures_found = 0;
 	int errno_of_last_failure = 0;
-	int policies = sizeof(policy_descriptors) / sizeof(pd);
+	unsigned int i;
+	int r;
 
-	for(i = 0; i < policies; i++) {
-		int line;
+	/* Nothing has changed since the last check */
+	if(_ncnf_diff_unchanged(root, baseline))
+		return 0;
 
+	for(i = 0; i < POLICIES; i++) {
 		pd = policy_descriptors[i];
 
 		snprintf(policy_disable_attr_name,
 			sizeof(policy_disable_attr_name),
-			"_validator-policy-%d-disable", i + 1);
+			"_validator-policy-%d-disable", pd->policy_number);
 
 		if(ncnf_get_obj(root, policy_disable_attr_name, "yes",
 				NCNF_FIRST_ATTRIBUTE)) {
 			_ncnf_debug_print(0,
 				"Validator policy %d disabled on request",
-				i + 1);
+				pd->policy_number);
 			continue;
 		}
 
-		line = pd->policy_function(root);
-		if(line == 0) {
-			continue;
-		} else if(line > 0) {
-			_ncnf_debug_print(1,
-				"Configuration policy \"%s\" failed at line %d",
-				pd->policy_description, line);
-			errno = EINVAL;
-		} else if(line < 0) {
-			_ncnf_debug_print(1,
-				"Configuration policy \"%s\" failed",
-				pd->policy_description);
+		memset(&runs[nruns], 0, sizeof(runs[nruns]));
+		runs[nruns].pd = pd;
+		policy_of_run[nruns++] = i;
+		if(pd->policy_visit)
+			visitors++;
+	}
+
+	/* A single walk for all the visitors */
+	if(visitors)
+		_policy_walk(root, baseline, runs, nruns,
+			&errno_of_last_failure);
+
+	for(r = 0; r < nruns; r++) {
+		policy_run_t *run = &runs[r];
+		struct policy_totals *pt = &policy_totals[policy_of_run[r]];
+
+		if(run->pd->policy_function) {
+			uint64_t started = _policy_now();
+			int line;
+
+			line = run->pd->policy_function((ncnf_obj *)root,
+				(ncnf_obj *)baseline);
+			run->nsec += _policy_now() - started;
+			if(line) {
+				_policy_failed(run, line);
+				errno_of_last_failure = errno;
+			}
 		}
 
-		failures_found = 1;
-		errno_of_last_failure = errno;
+		if(run->failures)
+			failures_found = 1;
+
+		_policy_names_free(run->names);
+
+		/* Several trees may be read at once */
+		__atomic_add_fetch(&pt->runs, 1, __ATOMIC_RELAXED);
+		__atomic_add_fetch(&pt->failures, run->failures,
+			__ATOMIC_RELAXED);
+		__atomic_add_fetch(&pt->nsec, run->nsec, __ATOMIC_RELAXED);
 	}
 
 	if(failures_found) {
@@ -87,3 +321,157 @@ ncnf_policy(struct ncnf_obj_s *root) {
 
 	return 0;
 }
+
+int
+ncnf_policy_stats(struct ncnf_policy_stats *stats, int max) {
+	int i;
+
+	for(i = 0; i < (int)POLICIES && i < max; i++) {
+		struct policy_totals *pt = &policy_totals[i];
+
+		stats[i].number = policy_descriptors[i]->policy_number;
+		stats[i].description =
+			policy_descriptors[i]->policy_description;
+		stats[i].runs = __atomic_load_n(&pt->runs, __ATOMIC_RELAXED);
+		stats[i].failures = __atomic_load_n(&pt->failures,
+			__ATOMIC_RELAXED);
+		stats[i].usec = __atomic_load_n(&pt->nsec,
+			__ATOMIC_RELAXED) / 1000;
+	}
+
+	return POLICIES;
+}
+
+
+#ifdef	MODULE_TEST
+
+/*
+ * The entity names must be unique case-insensitively.
+ */
+NCNF_POLICY_VISITOR(99, "99. Case-insensitive uniqueness") {
+	struct policy_nameset *names;
+	collection_t *coll;
+	int failed = 0;
+	int i;
+
+	names = _ncnf_policy_names(run);
+	if(names == NULL)
+		return -1;
+
+	coll = &container->m_collection[COLLECTION_OBJECTS];
+	for(i = 0; i < coll->entries; i++) {
+		struct ncnf_obj_s *obj = coll->entry[i].object;
+		struct ncnf_obj_s *dup;
+		char *buf;
+		char *p;
+
+		buf = _ncnf_policy_names_key(names, strlen(obj->value));
+		if(buf == NULL)
+			return -1;
+		for(p = obj->value; *p; p++)
+			*buf++ = tolower((unsigned char)*p);
+		*buf = '\0';
+
+		switch(_ncnf_policy_names_add(names, obj, &dup)) {
+		case 0:
+			break;
+		case 1:
+			assert(dup != obj);
+			assert(dup->config_line < obj->config_line);
+			if(failed == 0)
+				failed = obj->config_line;
+			break;
+		default:
+			return -1;
+		}
+	}
+
+	return failed;
+}
+
+static const char *test_config =
+	"server \"Alpha\" { port \"1\"; }\n"
+	"server \"alpha\" { port \"2\"; }\n"	/* Duplicate, line 2 */
+	"server \"beta\" {\n"
+	"	host \"alpha\" { port \"3\"; }\n"	/* Another container */
+	"	host \"h\" { port \"4\"; }\n"
+	"	host \"H\" { port \"5\"; }\n"	/* Duplicate, line 6 */
+	"}\n"
+	"server \"gamma\" {\n"
+	"	host \"h\" { port \"6\"; }\n"	/* The set is cleared */
+	"}\n";
+
+int
+main(int ac, char **av) {
+	struct ncnf_obj_s objs[100];
+	struct ncnf_obj_s *dup;
+	struct ncnf_policy_stats ps[POLICIES];
+	struct policy_nameset *ns;
+	policy_run_t run;
+	ncnf_obj *root;
+	int failed = 0;
+	int i;
+
+	(void)ac;
+	(void)av;
+
+	/* Enough names to grow the set a few times */
+	memset(&run, 0, sizeof(run));
+	run.pd = &_ncnf_policy_99_description;
+	for(i = 0; i < 3; i++) {
+		int n;
+
+		ns = _ncnf_policy_names(&run);
+		assert(ns && ns == run.names);
+		for(n = 0; n < 100; n++) {
+			char *key = _ncnf_policy_names_key(ns, 8);
+			assert(key);
+			snprintf(key, 9, "n%d", n);
+			assert(_ncnf_policy_names_add(ns, &objs[n], &dup) == 0);
+		}
+		for(n = 99; n >= 0; n--) {
+			char *key = _ncnf_policy_names_key(ns, 8);
+			assert(key);
+			snprintf(key, 9, "n%d", n);
+			dup = NULL;
+			assert(_ncnf_policy_names_add(ns, &objs[0], &dup) == 1);
+			assert(dup == &objs[n]);
+		}
+	}
+
+	/* The same generation must not be mistaken for a stale one */
+	ns->generation = (unsigned int)-1;
+	assert(_ncnf_policy_names(&run) == ns);
+	assert(ns->generation == 1);
+	strcpy(_ncnf_policy_names_key(ns, 2), "n1");
+	assert(_ncnf_policy_names_add(ns, &objs[1], &dup) == 0);
+	_policy_names_free(run.names);
+
+	root = ncnf_Read(test_config, NCNF_ST_TEXT | NCNF_FL_RELNS);
+	assert(root);
+
+	memset(&run, 0, sizeof(run));
+	run.pd = &_ncnf_policy_99_description;
+	_policy_walk(root, NULL, &run, 1, &failed);
+	assert(run.failures == 2);
+	assert(failed == EINVAL);
+	_policy_names_free(run.names);
+
+	/* Nothing is checked within the unchanged tree */
+	memset(&run, 0, sizeof(run));
+	run.pd = &_ncnf_policy_99_description;
+	failed = 0;
+	_policy_walk(root, root, &run, 1, &failed);
+	assert(run.failures == 0);
+	assert(run.names == NULL);
+
+	ncnf_destroy(root);
+
+	assert(ncnf_policy_stats(ps, POLICIES) == (int)POLICIES);
+	for(i = 0; i < (int)POLICIES; i++)
+		assert(ps[i].number == policy_descriptors[i]->policy_number);
+
+	return 0;
+}
+
+#endif	/* MODULE_TEST */
@@ -35,22 +35,53 @@
 
 /*
  * Check the tree against hardcoded policies.
+ * The baseline is the configuration checked before, or NULL;
+ * the policies need not check the subtrees unchanged since.
  */
-int ncnf_policy(struct ncnf_obj_s *root);
+int ncnf_policy(struct ncnf_obj_s *root, struct ncnf_obj_s *baseline);
 
-typedef int (ncnf_policy_function_f)(ncnf_obj *);
+typedef int (ncnf_policy_function_f)(ncnf_obj *, ncnf_obj *);
+
+/*
+ * The state of the policy within a single ncnf_policy() run.
+ */
+typedef struct policy_run_s {
+	struct policy_descriptor_s *pd;
+	struct policy_nameset *names;	/* See _ncnf_policy_names() */
+	unsigned long failures;
+	uint64_t nsec;			/* Time spent in the policy */
+} policy_run_t;
+
+typedef int (ncnf_policy_visit_f)(struct ncnf_obj_s *, policy_run_t *);
 
 typedef struct policy_descriptor_s {
-	ncnf_policy_function_f *policy_function;
+	ncnf_policy_function_f *policy_function;	/* Or NULL */
 	char *policy_description;
+	ncnf_policy_visit_f *policy_visit;	/* Or NULL */
+	int policy_number;	/* As in "_validator-policy-N-disable" */
 } policy_descriptor_t;
 
+/*
+ * The set of names unique under some normalization, cleared
+ * for every container visited.
+ * To add a name, normalize it into the buffer returned by
+ * _ncnf_policy_names_key(), large enough for len characters
+ * and the terminating '\0', and call _ncnf_policy_names_add().
+ * The latter returns 0 if the name is new, 1 if it was added before
+ * (the object it was added with is returned in *dup), or -1 if
+ * memory is exhausted.
+ */
+struct policy_nameset *_ncnf_policy_names(policy_run_t *);
+char *_ncnf_policy_names_key(struct policy_nameset *, size_t len);
+int _ncnf_policy_names_add(struct policy_nameset *, struct ncnf_obj_s *obj,
+	struct ncnf_obj_s **dup);
+
 
 #ifdef	_INSIDE_POLICY_C
 
 extern policy_descriptor_t _ncnf_policy_1_description;
 
-policy_descriptor_t *policy_descriptors[] = {
+static policy_descriptor_t *policy_descriptors[] = {
 	&_ncnf_policy_1_description
 };
 
@@ -63,8 +94,19 @@ policy_descriptor_t *policy_descriptors[] = {
 #define	NCNF_POLICY(number, policy_description)				\
 	static ncnf_policy_function_f policy##number;			\
 	policy_descriptor_t _ncnf_policy_ ## number ## _description =	\
-	{ policy##number, policy_description };				\
-	static int policy##number(struct ncnf_obj_s *root)
+	{ policy##number, policy_description, NULL, number };		\
+	static int policy##number(struct ncnf_obj_s *root,		\
+		struct ncnf_obj_s *baseline)
+
+/*
+ * Same, for the policy checking every container on its own.
+ */
+#define	NCNF_POLICY_VISITOR(number, policy_description)			\
+	static ncnf_policy_visit_f policy##number;			\
+	policy_descriptor_t _ncnf_policy_ ## number ## _description =	\
+	{ NULL, policy_description, policy##number, number };		\
+	static int policy##number(struct ncnf_obj_s *container,		\
+		policy_run_t *run)
 
 
 /*
@@ -106,9 +148,23 @@ NCNF_POLICY(X, "X. Short description of this policy") {
  * failure with description in errno) or positive configuration line number.
  * The configuration root will be accessible as the `root` local variable.
  * This function is defined as
- * 	int policyX(struct ncnf_obj_s *root);
- * and may be used recursively.
+ * 	int policyX(struct ncnf_obj_s *root, struct ncnf_obj_s *baseline);
+ * and may be used recursively. The `baseline` is the counterpart of the
+ * `root` within the configuration which has passed the policy before,
+ * or NULL. A policy which only looks inside the given subtree may return
+ * 0 if _ncnf_diff_unchanged(root, baseline), and pass
+ * _ncnf_diff_counterpart(baseline, obj) down along with the obj.
  * 
+ * Most policies only check the contents of every container on its own.
+ * Such a policy is better defined with NCNF_POLICY_VISITOR(X, ...),
+ * as
+ * 	int policyX(struct ncnf_obj_s *container, policy_run_t *run);
+ * All these policies are invoked within a single walk down the tree,
+ * for the root and every complex object, except for the subtrees
+ * unchanged since the baseline. The return value is the same as above;
+ * the walk goes on after the failure, so all of them are reported.
+ * For the uniqueness checks, see _ncnf_policy_names().
+ *
  * In case of any questions, refer to existing ncnf_policy_X.c files.
  *
  */
@@ -53,47 +53,31 @@ and certain other) are the special case.
 
  */
 
-NCNF_POLICY(1, "1. Entity length, uniqueness and character set") {
-	struct ncnf_obj_s *iter;
-	struct ncnf_obj_s *obj;
-	ncnf_sf_svect *sv;
-	int buf_size = -1;
-	char *buf = NULL;
-	int ret = -1;
+NCNF_POLICY_VISITOR(1, "1. Entity length, uniqueness and character set") {
+	struct policy_nameset *names;
+	collection_t *coll;
+	int i;
 
 	/* THIS IS JUST AN EXAMPLE! SUBSTITUTE IT WITH YOUR OWN POLICY! */
 	return 0;
 
-	sv = ncnf_sf_sinit();
-	if(sv == NULL)
+	names = _ncnf_policy_names(run);
+	if(names == NULL)
 		return -1;
 
-	iter = _ncnf_get_obj(root, NULL, NULL,
-		NCNF_CHAIN_OBJECTS, _NGF_NOFLAGS);
-	if(iter == NULL) {
-		ncnf_sf_sfree(sv);
-		return 0;
-	}
-
-	while((obj = _ncnf_iter_next(iter))) {
-		int len;
+	coll = &container->m_collection[COLLECTION_OBJECTS];
+	for(i = 0; i < coll->entries; i++) {
+		struct ncnf_obj_s *obj = coll->entry[i].object;
+		struct ncnf_obj_s *dup;
+		char *buf;
 		char *p;
 		char *c;
 
 		assert(obj->obj_class != NOBJ_INVALID);
 
-		/* Should we fail, the line will be our exit code */
-		ret = obj->config_line;
-
-		/*
-		 * Checking the size of a name.
-		 */
-		len = strlen(obj->value);
-
-		if(buf_size <= len) {
-			buf_size = len + 1;
-			buf = alloca(buf_size);
-		}
+		buf = _ncnf_policy_names_key(names, strlen(obj->value));
+		if(buf == NULL)
+			return -1;
 
 		for(p = buf, c = obj->value; *c; c++) {
 
@@ -119,61 +103,27 @@ NCNF_POLICY(1, "1. Entity length, uniqueness and character set") {
 					"invalid character set",
 					obj->value
 				);
-				goto fail;
+				return obj->config_line;
 			}
 		}
 		*p = '\0';
 
-		/* Check presense */
-		if(ncnf_sf_sfind(sv, buf) != -1) {
+		/* Check presense, add if not already present */
+		switch(_ncnf_policy_names_add(names, obj, &dup)) {
+		case 0:
+			break;
+		case 1:
 			_ncnf_debug_print(1,
-				"Wrong name \"%s\" (\"%s\"): %s "
-				"is not unique",
-				obj->value,
-				buf, ncnf_sf_sjoin(sv, ", ")
+				"Wrong name \"%s\" (\"%s\"): "
+				"is not unique, see \"%s\" at line %d",
+				obj->value, buf,
+				dup->value, dup->config_line
 			);
-			goto fail;
-		}
-
-		/* Add if not already present */
-		if(ncnf_sf_sadd(sv, buf) == -1) {
-			ret = -1;
-			goto fail;
-		}
-	}
-
-	ncnf_sf_sfree(sv);
-
-	/*
-	 * Do the same thing down the tree.
-	 */
-	if(root->obj_class == NOBJ_ROOT || root->obj_class == NOBJ_COMPLEX) {
-		collection_t *coll;
-		int i;
-
-		coll = &root->m_collection[COLLECTION_OBJECTS];
-		for(i = 0; i < coll->entries; i++) {
-			obj = coll->entry[i].object;
-			assert(obj->obj_class != NOBJ_INVALID);
-			if(obj->obj_class != NOBJ_REFERENCE) {
-				ret = policy1(obj);
-				if(ret) return ret;
-			}
+			return obj->config_line;
+		default:
+			return -1;
 		}
 	}
 
-
 	return 0;
-
-fail:
-
-	if(ret == 0) {
-		errno = EINVAL;
-		ret = -1;
-	}
-
-	ncnf_sf_sfree(sv);
-	return ret;
 }
-
-
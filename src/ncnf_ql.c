@@ -37,6 +37,7 @@
 #include "ncnf.h"
 #include "ncnf_int.h"
 #include "ncnf_ql.h"
+#include "ncnf_re.h"
 
 #define	QERROR(fmt, args...)	do {				\
 	if(nq) ncnf_delete_query(nq);				\
@@ -56,22 +57,35 @@
  */
 typedef struct ncnf_attrreq_s {
 	char *Name;
+	ncnf_atom_t name_atom;	/* Name, resolved up front */
 	char *Value;
-	sed_t *value_expression;/* If not given, use literal value */
+	struct ncnf_re *value_expression;/* If not given, use literal value */
+	int any_value;		/* "*", the value is not looked at */
 } ncnf_attrreq_t;
 
 static void ncnf_attrreq_free(ncnf_attrreq_t *ar) {
 	if(ar) {
 		if(ar->Name) free(ar->Name);
 		if(ar->Value) free(ar->Value);
-		if(ar->value_expression) sed_free(ar->value_expression);
+		if(ar->value_expression) _ncnf_re_free(ar->value_expression);
+		free(ar);
 	}
 }
 
+/*
+ * The _select answers, by the type atom.
+ */
+struct nq_select_cache {
+	ncnf_atom_t *type;
+	unsigned char *selected;
+	unsigned int size;	/* Power of two, or 0 */
+	unsigned int count;
+};
+
 struct ncnf_query_s {
 	ncnf_attrreq_t object_filter;	/* Filter on object name */
 	A_SET_OF(ncnf_attrreq_t) required_attributes;
-	A_SET_OF(sed_t) _select;/* _select "/type-name/i" [{ ... }]; */
+	A_SET_OF(struct ncnf_re) _select;/* _select "/type-name/i" [{ ... }]; */
 	enum {
 		NQSC_DEFAULT,	/* Semantically same as NQSC_NONE */
 		NQSC_NONE,	/* No child objects are selected */
@@ -79,8 +93,18 @@ struct ncnf_query_s {
 		NQSC_ALL,	/* Select all underlying levels */
 	} _select_children;
 	A_SET_OF(struct ncnf_query_s) level_deeper;
+
+	/*
+	 * Execution plan, see _nq_plan().
+	 */
+	int scan_children;	/* Every child is to be looked at */
+	struct nq_select_cache select_cache;
+	struct ncnf_query_stats *stats;	/* The topmost query's ones */
+	struct ncnf_query_stats own_stats;
 };
 
+static void _nq_plan(ncnf_query_t *nq, struct ncnf_query_stats *stats);
+
 ncnf_query_t *
 ncnf_compile_query(ncnf_obj *qroot, char *errbuf, size_t *errlen) {
 	ncnf_query_t *nq = NULL;
@@ -91,7 +115,7 @@ ncnf_compile_query(ncnf_obj *qroot, char *errbuf, size_t *errlen) {
 	nq = calloc(1, sizeof(*nq));
 	if(nq) {
 		nq->required_attributes.free = ncnf_attrreq_free;
-		nq->_select.free = sed_free;
+		nq->_select.free = _ncnf_re_free;
 		nq->level_deeper.free = ncnf_delete_query;
 	} else {
 		QERROR("%s", strerror(errno));
@@ -101,16 +125,17 @@ ncnf_compile_query(ncnf_obj *qroot, char *errbuf, size_t *errlen) {
 		char *type = ncnf_obj_type(qroot);
 		char *value = ncnf_obj_name(qroot);
 
-		if(strcmp(value, "*") == 0) value = "/.*/";
-
+		nq->object_filter.any_value = (strcmp(value, "*") == 0);
 		nq->object_filter.Name = strdup(type);
+		nq->object_filter.name_atom = ncnf_atom(type);
 		nq->object_filter.Value = strdup(value);
 		if(!nq->object_filter.Name
+		|| !nq->object_filter.name_atom
 		|| !nq->object_filter.Value)
 			QERROR("%s", strerror(errno));
 
 		if(*value == '/') {
-			sed_t *se = sed_compile(value);
+			struct ncnf_re *se = _ncnf_re_compile(value);
 			if(!se) QERROR("Cannot compile \"%s\" "
 				"at line %d: %s",
 				value, ncnf_obj_line(qroot),
@@ -130,7 +155,7 @@ ncnf_compile_query(ncnf_obj *qroot, char *errbuf, size_t *errlen) {
 		char *value = ncnf_obj_name(attr);
 		if(*type == '_') {
 			if(strcmp(type, "_select") == 0) {
-				sed_t *se;
+				struct ncnf_re *se;
 				if(*value != '/') {
 					errno = EINVAL;
 					QERROR("%s \"%s\" "
@@ -138,13 +163,13 @@ ncnf_compile_query(ncnf_obj *qroot, char *errbuf, size_t *errlen) {
 					"at line %d",
 					type, value, ncnf_obj_line(attr));
 				}
-				se = sed_compile(value);
+				se = _ncnf_re_compile(value);
 				if(!se) QERROR("Cannot compile \"%s\" "
 					"at line %d: %s",
 					value, ncnf_obj_line(attr),
 					strerror(errno));
 				if(ASN_SET_ADD(&nq->_select, se)) {
-					sed_free(se);
+					_ncnf_re_free(se);
 					QERROR("%s", strerror(errno));
 				}
 				continue;
@@ -175,8 +200,6 @@ ncnf_compile_query(ncnf_obj *qroot, char *errbuf, size_t *errlen) {
 		} else {
 			ncnf_attrreq_t *ar;
 
-			if(strcmp(value, "*") == 0) value = "/.*/";
-
 			ar = calloc(1, sizeof(*ar));
 			if(ASN_SET_ADD(&nq->required_attributes, ar)) {
 				if(ar) free(ar);
@@ -184,12 +207,14 @@ ncnf_compile_query(ncnf_obj *qroot, char *errbuf, size_t *errlen) {
 			}
 
 			ar->Name = strdup(type);
+			ar->name_atom = ncnf_atom(type);
 			ar->Value = strdup(value);
-			if(!ar->Name || !ar->Value)
+			ar->any_value = (strcmp(value, "*") == 0);
+			if(!ar->Name || !ar->name_atom || !ar->Value)
 				QERROR("%s", strerror(errno));
 
 			if(*value == '/') {
-				sed_t *se = sed_compile(value);
+				struct ncnf_re *se = _ncnf_re_compile(value);
 				if(!se) QERROR("Cannot compile \"%s\" "
 					"at line %d: %s",
 					value, ncnf_obj_line(attr),
@@ -214,61 +239,365 @@ ncnf_compile_query(ncnf_obj *qroot, char *errbuf, size_t *errlen) {
 		}
 	}
 
+	_nq_plan(nq, &nq->own_stats);
+
 	return nq;
 }
 
+/*
+ * Decide how the query is to be executed,
+ * and make the subqueries account into the given statistics.
+ */
+static void
+_nq_plan(ncnf_query_t *nq, struct ncnf_query_stats *stats) {
+	int i;
+
+	nq->stats = stats;
+
+	/*
+	 * The children are all looked at when some of them are to be
+	 * selected by their types. Otherwise, the subqueries fetch their
+	 * own candidates from the per-type index, and only those
+	 * are matched against the value expressions.
+	 */
+	nq->scan_children = (nq->_select_children == NQSC_SINGLE
+		|| nq->_select_children == NQSC_ALL
+		|| nq->_select.count);
+
+	for(i = 0; i < nq->level_deeper.count; i++)
+		_nq_plan(nq->level_deeper.array[i], stats);
+}
+
 void
 ncnf_delete_query(ncnf_query_t *nq) {
 	if(nq) {
 		if(nq->object_filter.Name) free(nq->object_filter.Name);
 		if(nq->object_filter.Value) free(nq->object_filter.Value);
 		if(nq->object_filter.value_expression)
-			sed_free(nq->object_filter.value_expression);
+			_ncnf_re_free(nq->object_filter.value_expression);
 		asn_set_empty(&nq->required_attributes);
 		asn_set_empty(&nq->_select);
 		asn_set_empty(&nq->level_deeper);
+		free(nq->select_cache.type);
+		free(nq->select_cache.selected);
+		free(nq);
 	}
 }
 
 static int set_mark_func(ncnf_obj *obj, void *markv)
 	{ obj->mark = (int)markv; return 0; }
 
-static void Mark(ncnf_obj *obj, int recurseDown) {
-	if(!obj) return;
+void
+ncnf_clear_query(ncnf_obj *qroot) {
+	if(qroot) {
+		ncnf_walk_tree(qroot, set_mark_func, 0);
+	}
+}
+
+static unsigned int
+_nq_hash(const void *ptr) {
+	return (unsigned int)(((uintptr_t)ptr >> 4) * 2654435761U);
+}
+
+/*
+ * The result set is the vector of objects, in the order they were added,
+ * and the open addressing hash of their positions in the vector.
+ */
+struct ncnf_qresult_s {
+	struct ncnf_obj_s **obj;
+	unsigned char *state;	/* QR_* for every obj[] */
+	unsigned int count;
+	unsigned int size;	/* Allocated obj[] and state[] */
+	int *slot;		/* Position in obj[] + 1, or 0 */
+	unsigned int slots;	/* Power of two, or 0 */
+};
+enum {
+	QR_SELECTED	= 1,	/* The object and the path to it */
+	QR_SUBTREE	= 2,	/* Along with everything underneath */
+};
+
+ncnf_qresult_t *
+ncnf_qresult_new() {
+	return calloc(1, sizeof(struct ncnf_qresult_s));
+}
+
+void
+ncnf_qresult_clear(ncnf_qresult_t *res) {
+	if(res) {
+		res->count = 0;
+		if(res->slots)
+			memset(res->slot, 0, res->slots * sizeof(res->slot[0]));
+	}
+}
+
+void
+ncnf_qresult_free(ncnf_qresult_t *res) {
+	if(res) {
+		free(res->obj);
+		free(res->state);
+		free(res->slot);
+		free(res);
+	}
+}
+
+/*
+ * Position of the object in the result set, or -1.
+ */
+static int
+_qr_find(ncnf_qresult_t *res, struct ncnf_obj_s *obj) {
+	unsigned int h;
+
+	if(res->slots == 0)
+		return -1;
+
+	for(h = _nq_hash(obj) & (res->slots - 1); res->slot[h];
+			h = (h + 1) & (res->slots - 1)) {
+		if(res->obj[res->slot[h] - 1] == obj)
+			return res->slot[h] - 1;
+	}
+
+	return -1;
+}
 
-	if(!obj->mark) {
-		obj->mark = 1;
+/*
+ * Hash the obj[] positions from scratch.
+ */
+static void
+_qr_rehash(ncnf_qresult_t *res) {
+	unsigned int i, h;
+
+	memset(res->slot, 0, res->slots * sizeof(res->slot[0]));
+	for(i = 0; i < res->count; i++) {
+		for(h = _nq_hash(res->obj[i]) & (res->slots - 1);
+			res->slot[h]; h = (h + 1) & (res->slots - 1));
+		res->slot[h] = i + 1;
+	}
+}
+
+/*
+ * Add the object which is not in the result set yet.
+ * Returns its position, or -1 (ENOMEM).
+ */
+static int
+_qr_add(ncnf_qresult_t *res, struct ncnf_obj_s *obj, int state) {
+	unsigned int h;
+
+	if(res->count == res->size) {
+		unsigned int size = res->size ? 2 * res->size : 64;
+		void *p;
+
+		p = realloc(res->obj, size * sizeof(res->obj[0]));
+		if(p == NULL) return -1;
+		res->obj = p;
+		p = realloc(res->state, size);
+		if(p == NULL) return -1;
+		res->state = p;
+		res->size = size;
+	}
+
+	if(2 * (res->count + 1) > res->slots) {
+		unsigned int slots = res->slots ? 2 * res->slots : 128;
+		int *slot = calloc(slots, sizeof(slot[0]));
+		if(slot == NULL) return -1;
+		free(res->slot);
+		res->slot = slot;
+		res->slots = slots;
+		_qr_rehash(res);
+	}
+
+	res->obj[res->count] = obj;
+	res->state[res->count] = state;
+	for(h = _nq_hash(obj) & (res->slots - 1); res->slot[h];
+		h = (h + 1) & (res->slots - 1));
+	res->slot[h] = ++res->count;
+
+	return res->count - 1;
+}
+
+/*
+ * Add the object to the result set, along with the path to the root
+ * and the reference's path to the root, and optionally the whole subtree.
+ */
+static int Mark(ncnf_qresult_t *res, ncnf_obj *obj, int recurseDown) {
+	int pos;
+
+	if(!obj) return 0;
+
+	pos = _qr_find(res, obj);
+	if(pos == -1) {
+		if((pos = _qr_add(res, obj, QR_SELECTED)) == -1)
+			return -1;
 		/* Mark the path to the root in the tree */
-		Mark(ncnf_obj_parent(obj), 0);
+		if(Mark(res, ncnf_obj_parent(obj), 0))
+			return -1;
 		/* Mark the reference's path to the root */
-		if(ncnf_obj_real(obj) != obj)
-			Mark(ncnf_obj_real(obj), 0);
+		if(ncnf_obj_real(obj) != obj
+		&& Mark(res, ncnf_obj_real(obj), 0))
+			return -1;
 	}
 
-	if(recurseDown && obj->mark != 2) {
+	if(recurseDown && res->state[pos] != QR_SUBTREE) {
+		coll_cursor cursor;
 		ncnf_obj *o;
-		ncnf_obj *iter;
 
 		if(ncnf_obj_real(obj) != obj)
-			return;
-		obj->mark = 2;
+			return 0;
+		res->state[pos] = QR_SUBTREE;
 
-		iter = ncnf_get_obj(obj, NULL, NULL,
-			NCNF_CHAIN_ATTRIBUTES);
-		while((o = ncnf_iter_next(iter))) o->mark = 1;
-		iter = ncnf_get_obj(obj, NULL, NULL,
-			NCNF_ITER_OBJECTS);
-		assert(iter || errno == ESRCH);
-		while((o = ncnf_iter_next(iter))) Mark(o, recurseDown);
-		ncnf_destroy(iter);
+		_ncnf_coll_cursor(obj->mr,
+			&obj->m_collection[COLLECTION_ATTRIBUTES],
+			&cursor, NULL, NULL);
+		while((o = _ncnf_coll_cursor_next(&cursor))) {
+			if(_qr_find(res, o) == -1
+			&& _qr_add(res, o, QR_SELECTED) == -1)
+				return -1;
+		}
+		_ncnf_coll_cursor(obj->mr,
+			&obj->m_collection[COLLECTION_OBJECTS],
+			&cursor, NULL, NULL);
+		while((o = _ncnf_coll_cursor_next(&cursor))) {
+			if(Mark(res, o, recurseDown))
+				return -1;
+		}
 	}
+
+	return 0;
 }
 
-void
-ncnf_clear_query(ncnf_obj *qroot) {
-	if(!qroot) {
-		ncnf_walk_tree(qroot, set_mark_func, 0);
+int
+ncnf_qresult_count(ncnf_qresult_t *res) {
+	if(res == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	return res->count;
+}
+
+int
+ncnf_qresult_contains(ncnf_qresult_t *res, ncnf_obj *obj) {
+	if(res == NULL || obj == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	return (_qr_find(res, obj) != -1);
+}
+
+ncnf_obj *
+ncnf_qresult_iter(ncnf_qresult_t *res) {
+	struct ncnf_obj_s *iter;
+	unsigned int i;
+
+	if(res == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	if(res->count == 0) {
+		errno = ESRCH;
+		return NULL;
 	}
+
+	iter = _ncnf_obj_new(0, NOBJ_ITERATOR, NULL, NULL, 0);
+	if(iter == NULL)
+		return NULL;
+
+	for(i = 0; i < res->count; i++) {
+		if(_ncnf_coll_insert(iter->mr, &iter->m_iterator_collection,
+				res->obj[i], MERGE_NOFLAGS)) {
+			_ncnf_obj_destroy(iter);
+			return NULL;
+		}
+	}
+
+	return iter;
+}
+
+int
+ncnf_qresult_union(ncnf_qresult_t *res, ncnf_qresult_t *other) {
+	unsigned int i;
+	int pos;
+
+	if(res == NULL || other == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	for(i = 0; i < other->count; i++) {
+		pos = _qr_find(res, other->obj[i]);
+		if(pos == -1) {
+			if(_qr_add(res, other->obj[i], other->state[i]) == -1)
+				return -1;
+		} else if(res->state[pos] < other->state[i]) {
+			res->state[pos] = other->state[i];
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Keep the objects which are (intersect) or are not (subtract)
+ * in the other result set.
+ */
+static int
+_qr_filter(ncnf_qresult_t *res, ncnf_qresult_t *other, int intersect) {
+	unsigned int i, kept;
+	int pos;
+
+	if(res == NULL || other == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	for(i = 0, kept = 0; i < res->count; i++) {
+		pos = _qr_find(other, res->obj[i]);
+		if((pos != -1) != intersect)
+			continue;
+		res->obj[kept] = res->obj[i];
+		/* The subtrees might have lost some objects */
+		res->state[kept] = intersect
+			? (res->state[i] < other->state[pos]
+				? res->state[i] : other->state[pos])
+			: QR_SELECTED;
+		kept++;
+	}
+
+	if(kept != res->count) {
+		res->count = kept;
+		_qr_rehash(res);
+	}
+
+	return 0;
+}
+
+int
+ncnf_qresult_intersect(ncnf_qresult_t *res, ncnf_qresult_t *other) {
+	return _qr_filter(res, other, 1);
+}
+
+int
+ncnf_qresult_subtract(ncnf_qresult_t *res, ncnf_qresult_t *other) {
+	return _qr_filter(res, other, 0);
+}
+
+static int
+_qr_dump_filter(struct ncnf_obj_s *obj, void *key) {
+	return (_qr_find((ncnf_qresult_t *)key, obj) != -1);
+}
+
+void
+ncnf_qresult_dump(FILE *f, ncnf_obj *obj, ncnf_qresult_t *res,
+		const char *flatten_type, int verbose, int indent) {
+	int recursive_size = 0;
+	if(obj == NULL || res == NULL)
+		return;
+	if(f == NULL)
+		f = stdout;
+	_ncnf_obj_dump_recursive(f, (struct ncnf_obj_s *)obj,
+		flatten_type, _qr_dump_filter, res,
+		verbose, 0, indent, 0, &recursive_size);
+	if(verbose)
+		fprintf(f, "# TOTAL RSIZE=%d\n", recursive_size);
 }
 
 #undef	DEBUG
@@ -277,152 +606,723 @@ ncnf_clear_query(ncnf_obj *qroot) {
 	fprintf(stderr, fmt "\n", ##args);	\
 } while(0)
 
-int
-ncnf_exec_query(ncnf_obj *qroot, ncnf_query_t *nq, int debug) {
-	ncnf_obj *iter, *obj;
+static void
+_nq_remember(struct nq_select_cache *sc, ncnf_atom_t type, int selected) {
+	unsigned int h;
+
+	if(2 * (sc->count + 1) > sc->size) {
+		struct nq_select_cache grown;
+		unsigned int i;
+
+		grown.size = sc->size ? 2 * sc->size : 16;
+		grown.count = 0;
+		grown.type = calloc(grown.size, sizeof(grown.type[0]));
+		grown.selected = malloc(grown.size);
+		if(grown.type == NULL || grown.selected == NULL) {
+			free(grown.type);
+			free(grown.selected);
+			return;	/* Will be evaluated again */
+		}
+
+		for(i = 0; i < sc->size; i++) {
+			if(sc->type[i])
+				_nq_remember(&grown, sc->type[i],
+					sc->selected[i]);
+		}
+		free(sc->type);
+		free(sc->selected);
+		*sc = grown;
+	}
+
+	for(h = _nq_hash(type) & (sc->size - 1); sc->type[h];
+		h = (h + 1) & (sc->size - 1));
+	sc->type[h] = type;
+	sc->selected[h] = selected;
+	sc->count++;
+}
+
+/*
+ * Whether the type of the object is matched by any of the _select
+ * expressions. The answers only depend on the type, so they are
+ * remembered. Returns -1 (ENOMEM) if the expression can't be matched.
+ */
+static int
+_nq_selected(ncnf_query_t *nq, ncnf_obj *obj) {
+	struct nq_select_cache *sc = &nq->select_cache;
+	ncnf_atom_t type = ncnf_obj_type_atom(obj);
+	int selected = 0;
+	unsigned int h;
 	int i;
 
-	if(!qroot || !nq) {
-		errno = EINVAL;
-		return -1;
+	if(nq->_select.count == 0 || type == NULL)
+		return 0;
+
+	if(sc->size) {
+		for(h = _nq_hash(type) & (sc->size - 1); sc->type[h];
+				h = (h + 1) & (sc->size - 1)) {
+			if(sc->type[h] == type) {
+				nq->stats->regex_cached++;
+				return sc->selected[h];
+			}
+		}
 	}
 
-	DEBUG("Entering %s \"%s\"",
-		ncnf_obj_type(qroot), ncnf_obj_name(qroot));
+	for(i = 0; i < nq->_select.count && !selected; i++) {
+		nq->stats->regex_evals++;
+		selected = _ncnf_re_match(nq->_select.array[i],
+			ncnf_atom_name(type));
+		if(selected == -1)
+			return -1;	/* ENOMEM */
+	}
 
-	/*
-	 * Check the object filter on entry.
-	 */
-	if(nq->object_filter.Name) {
-		char *type = ncnf_obj_type(qroot);
-		char *value = ncnf_obj_name(qroot);
+	_nq_remember(sc, type, selected);
 
-		DEBUG("Filtering against %s %s",
-			nq->object_filter.Name, nq->object_filter.Value);
+	return selected;
+}
 
-		if(strcmp(nq->object_filter.Name, type))
-			/* Name filter does not match */
-			return 0;
+/*
+ * Whether the object passes the object filter of the query,
+ * or -1 (ENOMEM).
+ */
+static int
+_nq_accept(ncnf_query_t *nq, ncnf_obj *obj) {
+	ncnf_attrreq_t *of = &nq->object_filter;
+	char *value;
 
-		if(nq->object_filter.value_expression) {
-			if(!sed_exec(nq->object_filter.value_expression, value))
-				/* Expression is not satisfied */
-				return 0;
-		} else {
-			if(strcmp(nq->object_filter.Value, value))
-				/* Value filter does not match */
-				return 0;
-		}
-	} else {
-		/* This is supposed to be a root object. */
+	if(ncnf_obj_type_atom(obj) != of->name_atom)
+		/* Name filter does not match */
+		return 0;
+
+	if(of->any_value)
+		return 1;
+
+	value = ncnf_obj_name(obj);
+	if(value == NULL) value = "";
+
+	if(of->value_expression) {
+		nq->stats->regex_evals++;
+		return _ncnf_re_match(of->value_expression, value);
 	}
 
-	DEBUG("Enter confirmed");
+	return (strcmp(of->Value, value) == 0);
+}
 
+/*
+ * Check that no required_attributes result in a mismatch.
+ * Returns -1 (ENOMEM) if the value expression can't be matched.
+ */
+static int
+_nq_required(ncnf_query_t *nq, ncnf_obj *container) {
+	collection_t *attrs = &container->m_collection[COLLECTION_ATTRIBUTES];
+	coll_cursor cursor;
+	ncnf_obj *attr;
+	int i;
 
-	/*
-	 * Check that no required_attributes result in a mismatch.
-	 */
 	for(i = 0; i < nq->required_attributes.count; i++) {
 		ncnf_attrreq_t *ar = nq->required_attributes.array[i];
-		DEBUG("Against %s \"%s\"", ar->Name, ar->Value);
-		if(ar->value_expression) {
-			ncnf_obj *attr;
-			iter = ncnf_get_obj(qroot, NULL, NULL,
-				NCNF_CHAIN_ATTRIBUTES);
-			while((attr = ncnf_iter_next(iter))) {
-				char *value = ncnf_obj_name(attr);
-				if(sed_exec(ar->value_expression, value))
-					break;
-			}
-			if(!attr) {
-				/* This attribute shall be present */
-				return 0;
-			}
-		} else if(*ar->Value) {
-			ncnf_obj *attr = ncnf_get_obj(qroot,
-				ar->Name, ar->Value,
-					NCNF_CHAIN_ATTRIBUTES);
-			if(!attr) {
-				/* This attribute shall be present */
-				return 0;
+		int literal = !ar->any_value && !ar->value_expression;
+
+		nq->stats->lookups += _ncnf_coll_cursor(container->mr, attrs,
+			&cursor, ar->name_atom,
+			(literal && *ar->Value) ? ar->Value : NULL);
+		while((attr = _ncnf_coll_cursor_next(&cursor))) {
+			nq->stats->visited++;
+			if(ar->value_expression == NULL)
+				break;
+			nq->stats->regex_evals++;
+			switch(_ncnf_re_match(ar->value_expression,
+					attr->value ? attr->value : "")) {
+			case -1:
+				return -1;
+			case 0:
+				continue;
 			}
-		} else {
-			ncnf_obj *attr = ncnf_get_obj(qroot,
-				ar->Name, NULL, NCNF_FIRST_ATTRIBUTE);
+			break;
+		}
+
+		if(literal && *ar->Value == '\0') {
 			if(attr) {
 				/* This attribute should not be present */
 				return 0;
 			}
+		} else if(attr == NULL) {
+			/* This attribute shall be present */
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * The query being executed, with its own results.
+ */
+struct nq_active {
+	ncnf_query_t *nq;
+	ncnf_qresult_t *res;
+};
+
+/*
+ * The subqueries of all the active queries at some level,
+ * sorted by the type and then by the literal value, see _nq_sub_cmp().
+ */
+struct nq_sub {
+	ncnf_atom_t type;
+	const char *literal;	/* NULL for "*" and regular expressions */
+	struct nq_active act;
+};
+
+static int
+_nq_sub_cmp(const void *ap, const void *bp) {
+	const struct nq_sub *a = ap;
+	const struct nq_sub *b = bp;
+
+	if(a->type != b->type)
+		return ((uintptr_t)a->type < (uintptr_t)b->type) ? -1 : 1;
+	if(a->literal == NULL || b->literal == NULL)
+		/* The literals go first */
+		return (a->literal ? -1 : 0) + (b->literal ? 1 : 0);
+	return strcmp(a->literal, b->literal);
+}
+
+/*
+ * Find the subqueries of the given type, [*lo, *hi).
+ */
+static int
+_nq_group(struct nq_sub *sub, int nsubs, ncnf_atom_t type, int *lo, int *hi) {
+	int l = 0, h = nsubs;
+
+	while(l < h) {
+		int m = (l + h) / 2;
+		if((uintptr_t)sub[m].type < (uintptr_t)type)
+			l = m + 1;
+		else
+			h = m;
+	}
+
+	for(h = l; h < nsubs && sub[h].type == type; h++);
+
+	*lo = l;
+	*hi = h;
+	return (h > l);
+}
+
+/*
+ * Collect the subqueries from the [lo, hi) group
+ * whose object filters pass the given child.
+ * Returns their number, or -1 (ENOMEM).
+ */
+static int
+_nq_dispatch(ncnf_obj *child, struct nq_sub *sub, int lo, int hi,
+		struct nq_active *next) {
+	const char *value = ncnf_obj_name(child);
+	int lit_end, l, h;
+	int n = 0;
+
+	if(value == NULL) value = "";
+
+	/* The literal values are found by the binary search */
+	for(l = lo, h = hi; l < h;) {
+		int m = (l + h) / 2;
+		if(sub[m].literal)
+			l = m + 1;
+		else
+			h = m;
+	}
+	lit_end = l;
+	for(l = lo, h = lit_end; l < h;) {
+		int m = (l + h) / 2;
+		if(strcmp(sub[m].literal, value) < 0)
+			l = m + 1;
+		else
+			h = m;
+	}
+	for(; l < lit_end && strcmp(sub[l].literal, value) == 0; l++)
+		next[n++] = sub[l].act;
+
+	/* The rest is looked at one by one */
+	for(l = lit_end; l < hi; l++) {
+		switch(_nq_accept(sub[l].act.nq, child)) {
+		case -1:
+			return -1;
+		case 0:
+			break;
+		default:
+			next[n++] = sub[l].act;
+		}
+	}
+
+	return n;
+}
+
+/*
+ * Select the attribute of the object the query is executed against.
+ */
+static int
+_nq_select_attribute(struct nq_active *act, ncnf_obj *attr) {
+	switch(act->nq->_select_children) {
+	case NQSC_ALL:
+	case NQSC_SINGLE:
+		break;
+	default:
+		switch(_nq_selected(act->nq, attr)) {
+		case -1:
+			return -1;
+		case 0:
+			return 0;
+		}
+	}
+	return Mark(act->res, attr, 0);
+}
+
+/*
+ * Select the child entity of the object the query is executed against.
+ */
+static int
+_nq_select_object(struct nq_active *act, ncnf_obj *child, int debug) {
+	ncnf_query_t *nq = act->nq;
+
+	switch(nq->_select_children) {
+	case NQSC_ALL:
+	case NQSC_SINGLE:
+		if(ncnf_obj_real(child) == child) {
+			coll_cursor attrs;
+			ncnf_obj *attr;
+			DEBUG("Marking %s \"%s\"",
+				ncnf_obj_type(child),
+				ncnf_obj_name(child));
+			/* Mark this single level, or all levels */
+			if(Mark(act->res, child,
+				nq->_select_children == NQSC_ALL))
+				return -1;
+			/* Select this level's attributes */
+			_ncnf_coll_cursor(child->mr,
+				&child->m_collection[COLLECTION_ATTRIBUTES],
+				&attrs, NULL, NULL);
+			while((attr = _ncnf_coll_cursor_next(&attrs))) {
+				if(Mark(act->res, attr, 0))
+					return -1;
+			}
+			return 0;
 		}
+		return Mark(act->res, child, 0);
+	default:
+		DEBUG("Marking selected in %s \"%s\" against %s \"%s\"",
+			ncnf_obj_type(child),
+			ncnf_obj_name(child),
+			nq->object_filter.Name,
+			nq->object_filter.Value);
+		switch(_nq_selected(nq, child)) {
+		case -1:
+			return -1;
+		case 0:
+			return 0;
+		}
+		return Mark(act->res, child, 0);
+	}
+}
+
+/*
+ * Execute the queries against the object which passed their object
+ * filters. The children are only walked once for all of the queries:
+ * either looked up in the index by the types (and the literal values)
+ * of the subqueries, or scanned and dispatched to the subqueries
+ * by their types.
+ */
+static int
+_nq_walk(ncnf_obj *obj, struct nq_active *act, int nact, int debug) {
+	ncnf_obj *container = ncnf_obj_real(obj);
+	struct ncnf_query_stats *stats;
+	struct nq_sub sub_buf[8], *sub = sub_buf;
+	struct nq_active next_buf[8], *next = next_buf;
+	collection_t *objects;
+	coll_cursor cursor;
+	ncnf_obj *child;
+	int scan = 0;
+	int nsubs = 0;
+	int lo, hi, vlo, vhi;
+	int i, j, n;
+
+	DEBUG("Enter confirmed");
+
+	if(container == NULL || !_NOBJ_CONTAINER(container))
+		return 0;
+
+	/* Drop the queries whose attribute requirements are not met */
+	for(i = 0, j = 0; i < nact; i++) {
+		switch(_nq_required(act[i].nq, container)) {
+		case -1:
+			return -1;
+		case 0:
+			break;
+		default:
+			act[j++] = act[i];
+		}
+	}
+	if((nact = j) == 0)
+		return 0;
+
+	stats = act[0].nq->stats;
+
+	for(i = 0; i < nact; i++) {
+		scan |= act[i].nq->scan_children;
+		nsubs += act[i].nq->level_deeper.count;
 	}
 
 	/*
 	 * Mark the attributes described by _select.
 	 * NCNF entities will be selected separately.
 	 */
-	iter = ncnf_get_obj(qroot, NULL, NULL, NCNF_ITER_ATTRIBUTES);
-	while((obj = ncnf_iter_next(iter))) {
-		switch(nq->_select_children) {
-		case NQSC_ALL:
-		case NQSC_SINGLE:
-			Mark(obj, 0);
-			continue;
-		default:
-			break;
+	if(scan) {
+		_ncnf_coll_cursor(container->mr,
+			&container->m_collection[COLLECTION_ATTRIBUTES],
+			&cursor, NULL, NULL);
+		while((child = _ncnf_coll_cursor_next(&cursor))) {
+			stats->visited++;
+			for(i = 0; i < nact; i++) {
+				if(act[i].nq->scan_children
+				&& _nq_select_attribute(&act[i], child))
+					return -1;
+			}
 		}
-		for(i = 0; i < nq->_select.count; i++)
-			if(sed_exec(nq->_select.array[i], ncnf_obj_type(obj)))
-				Mark(obj, 0);
+	} else if(nsubs == 0) {
+		return 0;
 	}
 
+	/*
+	 * Gather the subqueries of all the active queries.
+	 */
+	if(nsubs > (int)(sizeof(sub_buf) / sizeof(sub_buf[0]))) {
+		sub = malloc(nsubs * (sizeof(*sub) + sizeof(*next)));
+		if(sub == NULL)
+			return -1;
+		next = (struct nq_active *)(sub + nsubs);
+	}
+	for(i = 0, n = 0; i < nact; i++) {
+		for(j = 0; j < act[i].nq->level_deeper.count; j++, n++) {
+			ncnf_query_t *nq = act[i].nq->level_deeper.array[j];
+			ncnf_attrreq_t *of = &nq->object_filter;
+			sub[n].type = of->name_atom;
+			sub[n].literal = (of->any_value || of->value_expression)
+				? NULL : of->Value;
+			sub[n].act.nq = nq;
+			sub[n].act.res = act[i].res;
+		}
+	}
+	if(nsubs > 1)
+		qsort(sub, nsubs, sizeof(*sub), _nq_sub_cmp);
+
 	/*
 	 * Process the rest of the nesting levels.
 	 */
-	iter = ncnf_get_obj(qroot, NULL, NULL, NCNF_CHAIN_OBJECTS);
-	while((obj = ncnf_iter_next(iter))) {
-		/*
-		 * Execute the _select statements.
-		 */
-		switch(nq->_select_children) {
-		case NQSC_ALL:
-		case NQSC_SINGLE:
-			if(ncnf_obj_real(obj) == obj) {
-				ncnf_obj *attr;
-				ncnf_obj *chain;
-				chain = ncnf_get_obj(obj, NULL, NULL,
-					NCNF_CHAIN_ATTRIBUTES);
-				DEBUG("Marking %s \"%s\"",
-					ncnf_obj_type(obj), ncnf_obj_name(obj));
-				/* Mark this single level, or all levels */
-				Mark(obj, nq->_select_children == NQSC_ALL);
-				/* Select this level's attributes */
-				while((attr = ncnf_iter_next(chain)))
-					Mark(attr, 0);
-			} else {
-				Mark(obj, 0);
+	objects = &container->m_collection[COLLECTION_OBJECTS];
+
+	if(scan) {
+		_ncnf_coll_cursor(container->mr, objects, &cursor, NULL, NULL);
+		while((child = _ncnf_coll_cursor_next(&cursor))) {
+			stats->visited++;
+
+			/*
+			 * Execute the _select statements.
+			 */
+			for(i = 0; i < nact; i++) {
+				if(act[i].nq->scan_children
+				&& _nq_select_object(&act[i], child, debug))
+					goto fail;
 			}
-			break;
-		default:
-			DEBUG("Marking selected in %s \"%s\" against %s \"%s\"",
-				ncnf_obj_type(obj),
-				ncnf_obj_name(obj),
+
+			/*
+			 * Process with deeper object levels,
+			 * the ones of the child's type.
+			 */
+			if(!_nq_group(sub, nsubs, ncnf_obj_type_atom(child),
+					&lo, &hi))
+				continue;
+			n = _nq_dispatch(child, sub, lo, hi, next);
+			if(n == -1)
+				goto fail;
+			if(n == 0)
+				continue;
+			DEBUG("Entering %s \"%s\"",
+				ncnf_obj_type(child), ncnf_obj_name(child));
+			if(_nq_walk(child, next, n, debug))
+				goto fail;
+		}
+	} else {
+		/* The subqueries fetch their candidates from the index */
+		for(lo = 0; lo < nsubs; lo = hi) {
+			for(hi = lo + 1; hi < nsubs
+				&& sub[hi].type == sub[lo].type; hi++);
+			for(vlo = lo; vlo < hi; vlo = vhi) {
+				if(sub[hi - 1].literal) {
+					/* All literals, look up by value too */
+					for(vhi = vlo + 1; vhi < hi
+						&& !strcmp(sub[vhi].literal,
+							sub[vlo].literal);
+						vhi++);
+				} else {
+					vhi = hi;
+				}
+				stats->lookups += _ncnf_coll_cursor(
+					container->mr, objects, &cursor,
+					sub[vlo].type,
+					sub[hi - 1].literal
+					? sub[vlo].literal : NULL);
+				while((child = _ncnf_coll_cursor_next(&cursor))) {
+					stats->visited++;
+					n = _nq_dispatch(child, sub,
+						vlo, vhi, next);
+					if(n == -1)
+						goto fail;
+					if(n == 0)
+						continue;
+					DEBUG("Entering %s \"%s\"",
+						ncnf_obj_type(child),
+						ncnf_obj_name(child));
+					if(_nq_walk(child, next, n, debug))
+						goto fail;
+				}
+			}
+		}
+	}
+
+	if(sub != sub_buf)
+		free(sub);
+	return 0;
+fail:
+	if(sub != sub_buf)
+		free(sub);
+	return -1;
+}
+
+/*
+ * Check the object filters on entry, and walk the tree.
+ */
+static int
+_nq_enter(ncnf_obj *qroot, struct nq_active *act, int nact, int debug) {
+	int i, j;
+
+	DEBUG("Entering %s \"%s\"",
+		ncnf_obj_type(qroot), ncnf_obj_name(qroot));
+
+	for(i = 0, j = 0; i < nact; i++) {
+		ncnf_query_t *nq = act[i].nq;
+
+		nq->stats->visited++;
+
+		if(nq->object_filter.Name) {
+			DEBUG("Filtering against %s %s",
 				nq->object_filter.Name,
 				nq->object_filter.Value);
-			for(i = 0; i < nq->_select.count; i++)
-				if(sed_exec(nq->_select.array[i], ncnf_obj_type(obj)))
-					Mark(obj, 0);
+			switch(_nq_accept(nq, qroot)) {
+			case -1:
+				return -1;
+			case 0:
+				continue;
+			}
+		} else {
+			/* This is supposed to be a root object. */
 		}
 
-		/*
-		 * Process with deeper object levels.
-		 */
-		for(i = 0; i < nq->level_deeper.count; i++)
-			if(ncnf_exec_query(obj, nq->level_deeper.array[i],
-					debug))
-				return -1;
+		act[j++] = act[i];
 	}
 
-	return 0;
+	return j ? _nq_walk(qroot, act, j, debug) : 0;
+}
+
+int
+ncnf_exec_query_ex(ncnf_obj *qroot, ncnf_query_t *nq, ncnf_qresult_t *res,
+		int debug) {
+	struct nq_active act;
+
+	if(!qroot || !nq || !res) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	act.nq = nq;
+	act.res = res;
+
+	return _nq_enter(qroot, &act, 1, debug);
+}
+
+int
+ncnf_exec_query(ncnf_obj *qroot, ncnf_query_t *nq, int debug) {
+	ncnf_qresult_t *res;
+	unsigned int i;
+	int ret;
+
+	res = ncnf_qresult_new();
+	if(res == NULL)
+		return -1;
+
+	ret = ncnf_exec_query_ex(qroot, nq, res, debug);
+
+	/* Color the tree with whatever has been found */
+	for(i = 0; i < res->count; i++) {
+		if(res->obj[i]->mark < res->state[i])
+			res->obj[i]->mark = res->state[i];
+	}
+
+	ncnf_qresult_free(res);
+
+	return ret;
+}
+
+void
+ncnf_query_stats(ncnf_query_t *nq, struct ncnf_query_stats *stats) {
+	if(nq && stats)
+		*stats = *nq->stats;
+}
+
+struct ncnf_query_set_s {
+	A_SET_OF(struct ncnf_query_s) queries;
+	struct ncnf_query_stats stats;	/* Shared by all the queries */
+};
+
+ncnf_query_set_t *
+ncnf_query_set_new() {
+	ncnf_query_set_t *qs;
+
+	qs = calloc(1, sizeof(*qs));
+	if(qs)
+		qs->queries.free = ncnf_delete_query;
+
+	return qs;
+}
+
+int
+ncnf_query_set_add(ncnf_query_set_t *qs, ncnf_query_t *nq) {
+
+	if(qs == NULL || nq == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if(ASN_SET_ADD(&qs->queries, nq))
+		return -1;
+
+	/* Account into the set's statistics */
+	qs->stats.visited += nq->own_stats.visited;
+	qs->stats.lookups += nq->own_stats.lookups;
+	qs->stats.regex_evals += nq->own_stats.regex_evals;
+	qs->stats.regex_cached += nq->own_stats.regex_cached;
+	_nq_plan(nq, &qs->stats);
+
+	return qs->queries.count - 1;
+}
+
+int
+ncnf_exec_query_set(ncnf_obj *qroot, ncnf_query_set_t *qs,
+		ncnf_qresult_t **results, int debug) {
+	struct nq_active *act;
+	int ret;
+	int i;
+
+	if(!qroot || !qs || !results) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if(qs->queries.count == 0)
+		return 0;
+
+	act = malloc(qs->queries.count * sizeof(*act));
+	if(act == NULL)
+		return -1;
+
+	for(i = 0; i < qs->queries.count; i++) {
+		if(results[i] == NULL) {
+			free(act);
+			errno = EINVAL;
+			return -1;
+		}
+		act[i].nq = qs->queries.array[i];
+		act[i].res = results[i];
+	}
+
+	ret = _nq_enter(qroot, act, qs->queries.count, debug);
+
+	free(act);
+
+	return ret;
 }
 
+void
+ncnf_query_set_stats(ncnf_query_set_t *qs, struct ncnf_query_stats *stats) {
+	if(qs && stats)
+		*stats = qs->stats;
+}
+
+void
+ncnf_query_set_free(ncnf_query_set_t *qs) {
+	if(qs) {
+		asn_set_empty(&qs->queries);
+		free(qs);
+	}
+}
+
+static const char *
+_nq_access(ncnf_attrreq_t *ar, int indexed) {
+	if(ar->any_value)
+		return indexed ? "index by type" : "type compared";
+	if(ar->value_expression)
+		return indexed ? "index by type, then regex"
+			: "type compared, then regex";
+	if(*ar->Value == '\0')
+		return indexed ? "index by type, must be absent"
+			: "type and value compared";
+	return indexed ? "index by type and value" : "type and value compared";
+}
+
+static void
+_nq_explain(ncnf_query_t *nq, FILE *f, int indent, const char *access) {
+	int i;
+
+	if(nq->object_filter.Name)
+		fprintf(f, "%*s%s \"%s\": %s\n", indent, "",
+			nq->object_filter.Name, nq->object_filter.Value,
+			access);
+	else
+		fprintf(f, "%*s(root)\n", indent, "");
+	indent += 4;
+
+	for(i = 0; i < nq->required_attributes.count; i++) {
+		ncnf_attrreq_t *ar = nq->required_attributes.array[i];
+		fprintf(f, "%*srequire %s \"%s\": %s\n", indent, "",
+			ar->Name, ar->Value, _nq_access(ar, 1));
+	}
+
+	for(i = 0; i < nq->_select.count; i++)
+		fprintf(f, "%*s_select #%d: regex on the type, once per type\n",
+			indent, "", i + 1);
+
+	switch(nq->_select_children) {
+	case NQSC_SINGLE:
+		fprintf(f, "%*s_select-children one\n", indent, "");
+		break;
+	case NQSC_ALL:
+		fprintf(f, "%*s_select-children all\n", indent, "");
+		break;
+	default:
+		break;
+	}
+
+	if(nq->level_deeper.count)
+		fprintf(f, "%*schildren: %s\n", indent, "",
+			nq->scan_children
+			? "scanned once, dispatched by type"
+			: "looked up by each subquery");
+
+	for(i = 0; i < nq->level_deeper.count; i++) {
+		ncnf_query_t *sub = nq->level_deeper.array[i];
+		_nq_explain(sub, f, indent,
+			_nq_access(&sub->object_filter, !nq->scan_children));
+	}
+}
+
+void
+ncnf_explain_query(ncnf_query_t *nq, FILE *f) {
+	if(nq && f)
+		_nq_explain(nq, f, 0, "");
+}
@@ -59,17 +59,118 @@ ncnf_query_t *ncnf_compile_query(ncnf_obj *ncnf_query,
 void ncnf_delete_query(ncnf_query_t *);
 
 /*
- * Unmark the tree before or after query.
+ * The query result set: the objects selected by the query, along with
+ * the objects on the path from the root to each of them. The results
+ * are kept aside from the tree, which is not modified by the queries.
+ */
+typedef struct ncnf_qresult_s ncnf_qresult_t;	/* Forward declaration */
+ncnf_qresult_t *ncnf_qresult_new(void);
+void ncnf_qresult_clear(ncnf_qresult_t *);	/* Remove all objects */
+void ncnf_qresult_free(ncnf_qresult_t *);
+
+/*
+ * Execute the compiled NCNF query, adding the NCNF objects satisfying
+ * the query to the result set. Results from multiple ncnf_exec_query_ex()
+ * invocations are combined unless ncnf_qresult_clear() is invoked.
+ *
+ * Several threads may run their queries over the same tree at once,
+ * each with its own compiled query and result set, as long as the tree
+ * is not modified and its lookup index is prepared (the trees published
+ * with ncnf_vroot_publish() are).
+ * Returns -1 (errno is set) if the result set could not be grown.
+ */
+int ncnf_exec_query_ex(ncnf_obj *root, ncnf_query_t *query,
+	ncnf_qresult_t *result, int debug);
+
+/*
+ * Number of objects in the result set, and whether the given
+ * object is there (0 or 1; -1 and EINVAL for the NULL arguments).
+ */
+int ncnf_qresult_count(ncnf_qresult_t *);
+int ncnf_qresult_contains(ncnf_qresult_t *, ncnf_obj *obj);
+
+/*
+ * Iterate over the result set, in the order the objects were added.
+ * The iterator is used with ncnf_iter_next() and is to be disposed with
+ * ncnf_destroy(). Returns NULL and ESRCH if the result set is empty.
+ */
+ncnf_obj *ncnf_qresult_iter(ncnf_qresult_t *);
+
+/*
+ * Combine the result sets, leaving the outcome in the first one:
+ * the objects from either set, from both sets, or only from the first.
+ * Returns -1 (errno is set) upon error.
+ */
+int ncnf_qresult_union(ncnf_qresult_t *, ncnf_qresult_t *);
+int ncnf_qresult_intersect(ncnf_qresult_t *, ncnf_qresult_t *);
+int ncnf_qresult_subtract(ncnf_qresult_t *, ncnf_qresult_t *);
+
+/*
+ * Dump the part of the tree contained in the result set, see ncnf_dump().
+ * An object is only printed if its enclosing objects are contained too,
+ * which is always the case for the results of the queries and their unions.
+ */
+void ncnf_qresult_dump(FILE *, ncnf_obj *obj, ncnf_qresult_t *,
+	const char *flatten_type, int verbose, int indent);
+
+/*
+ * Unmark the tree before or after ncnf_exec_query().
  */
 void ncnf_clear_query(ncnf_obj *root);
 
 /*
  * Execute the compiled NCNF query,
- * marking (coloring) the NCNF objects satisfying the query.
+ * marking (coloring) the NCNF objects satisfying the query,
+ * to be used with ncnf_dump(..., marked_only = 1, ...).
  * 
  * Results from multiple ncnf_exec_query() functions are combined
- * unless ncnf_clear_query() is invoked.
+ * unless ncnf_clear_query() is invoked. The marks are shared with
+ * the rest of the library, prefer ncnf_exec_query_ex().
  */
 int ncnf_exec_query(ncnf_obj *root, ncnf_query_t *query, int debug);
 
+/*
+ * The compiled query is planned up front: the children are fetched
+ * by their types (and the literal values) from the lookup index,
+ * and the regular expressions are only run on what is left. The
+ * _select expressions are evaluated once per type name.
+ */
+
+/*
+ * Statistics of the query, accumulated over all ncnf_exec_query() runs.
+ * Since the compiled query keeps these and the _select answers,
+ * it should only be executed by one thread at a time.
+ */
+struct ncnf_query_stats {
+	unsigned long visited;		/* Objects looked at */
+	unsigned long lookups;		/* Index lookups by type or value */
+	unsigned long regex_evals;	/* Regular expressions evaluated */
+	unsigned long regex_cached;	/* _select answers reused */
+};
+void ncnf_query_stats(ncnf_query_t *, struct ncnf_query_stats *);
+
+/*
+ * The set of queries evaluated together, in a single walk of the tree.
+ * ncnf_query_set_add() takes over the compiled query, which is deleted
+ * along with the set, and returns its number in the set (0, 1, ...)
+ * or -1 (errno is set).
+ *
+ * ncnf_exec_query_set() adds the results of every query to its own result
+ * set, results[number]. The statistics of the queries in the set are
+ * accumulated together, see ncnf_query_set_stats().
+ * Returns -1 (errno is set) if the result sets could not be grown.
+ */
+typedef struct ncnf_query_set_s ncnf_query_set_t;	/* Forward declaration */
+ncnf_query_set_t *ncnf_query_set_new(void);
+int ncnf_query_set_add(ncnf_query_set_t *, ncnf_query_t *);
+int ncnf_exec_query_set(ncnf_obj *root, ncnf_query_set_t *,
+	ncnf_qresult_t **results, int debug);
+void ncnf_query_set_stats(ncnf_query_set_t *, struct ncnf_query_stats *);
+void ncnf_query_set_free(ncnf_query_set_t *);
+
+/*
+ * Print the execution plan of the compiled query.
+ */
+void ncnf_explain_query(ncnf_query_t *, FILE *);
+
 #endif	/* NCNF_QL_H */
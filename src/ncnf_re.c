@@ -0,0 +1,1700 @@
+/*
+ * Copyright (c) 2001, 2002, 2003, 2004, 2005  Netli, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * $Id$
+ */
+/*
+ * Built-in regular expressions.
+ */
+#include "headers.h"
+#include "ncnf_int.h"
+#include "ncnf_re.h"
+
+#ifdef	HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif	/* HAVE_LIBPTHREAD */
+
+#define	RE_PROG_MAX	4096	/* Instructions of the compiled program */
+#define	RE_DUP_LIMIT	255	/* The largest {m,n} */
+#define	RE_DFA_MAX	1024	/* DFA states, before falling back to NFA */
+#define	RE_GROUPS	10	/* \0 to \9 */
+
+typedef struct { uint32_t bit[8]; } re_set_t;
+#define	RE_HAS(s, c)	((s)->bit[(c) >> 5] & (1U << ((c) & 31)))
+#define	RE_ADD(s, c)	((s)->bit[(c) >> 5] |= (1U << ((c) & 31)))
+
+#define	BIT_HAS(bs, n)	((bs)[(n) >> 5] & (1U << ((n) & 31)))
+#define	BIT_ADD(bs, n)	((bs)[(n) >> 5] |= (1U << ((n) & 31)))
+
+/*
+ * Parse tree.
+ */
+enum re_node_type {
+	RN_EMPTY,
+	RN_SET,		/* Any byte of the set */
+	RN_CAT,
+	RN_ALT,
+	RN_REPEAT,
+	RN_GROUP,
+	RN_BOL,		/* ^ */
+	RN_EOL,		/* $ */
+};
+
+struct re_node {
+	enum re_node_type type;
+	int l, r;	/* Subnodes */
+	int min, max;	/* RN_REPEAT, max is -1 if unlimited */
+	int arg;	/* RN_SET: the set, RN_GROUP: the group */
+};
+
+struct re_parser {
+	const unsigned char *p;
+	int extended;
+	int icase;
+	struct re_node *node;
+	int nnodes;
+	int nodes_size;
+	re_set_t *set;
+	int nsets;
+	int sets_size;
+	int ngroups;
+};
+
+/*
+ * Program, Thompson style.
+ */
+enum re_op {
+	RO_CHAR,	/* Consume a byte of the set */
+	RO_SPLIT,	/* Go to both x and y, x is preferred */
+	RO_JMP,
+	RO_BOL,		/* Go on if at the beginning of the value */
+	RO_EOL,		/* Go on if at the end of the value */
+	RO_SAVE,	/* Record the position in the capture slot */
+	RO_MATCH,
+};
+
+struct re_inst {
+	enum re_op op;
+	int x;		/* Next instruction */
+	int y;		/* RO_SPLIT alternative */
+	int arg;	/* RO_CHAR: the set, RO_SAVE: the slot */
+};
+
+struct re_dfa {
+	int *trans;		/* [state * nclasses + class], -1 if dead */
+	unsigned char *accept;	/* RA_* flags of the states */
+	int nstates;
+	int start[2];		/* Not at the beginning, at the beginning */
+};
+#define	RA_NOW	1	/* Matched */
+#define	RA_END	2	/* Matched, if at the end of the value */
+
+struct ncnf_re {
+	char *text;		/* The expression, as compiled */
+	int refs;
+	struct ncnf_re *next;	/* Within the cache */
+
+	enum { RE_MATCH, RE_SUBST, RE_TRANSLATE } kind;
+	int global;		/* "g" */
+
+	struct re_inst *prog;
+	int nprog;
+	int prog_size;
+	re_set_t *sets;
+	int words;		/* Of the bit set of instructions */
+
+	unsigned char classof[256];	/* Bytes, by the sets they are in */
+	int nclasses;
+	int nfa_only;		/* The DFA would be too large */
+	int matches_empty;	/* Matches the empty value, ^ and $ at once */
+	struct re_dfa search;	/* Matching anywhere */
+	struct re_dfa anchored;	/* Matching at the position, RE_SUBST */
+
+	char *replacement;	/* RE_SUBST */
+	int refers;		/* The replacement refers to \1 to \9 */
+	unsigned char tr[256];	/* RE_TRANSLATE */
+};
+
+static struct ncnf_re *re_cache;
+#ifdef	HAVE_LIBPTHREAD
+static pthread_mutex_t re_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif	/* HAVE_LIBPTHREAD */
+
+/*
+ * Parsing.
+ */
+
+static int
+_re_node(struct re_parser *rp, enum re_node_type type, int l, int r) {
+	struct re_node *n;
+
+	if(rp->nnodes == rp->nodes_size) {
+		int size = rp->nodes_size ? 2 * rp->nodes_size : 32;
+		n = realloc(rp->node, size * sizeof(n[0]));
+		if(n == NULL)
+			return -1;
+		rp->node = n;
+		rp->nodes_size = size;
+	}
+
+	n = &rp->node[rp->nnodes];
+	memset(n, 0, sizeof(*n));
+	n->type = type;
+	n->l = l;
+	n->r = r;
+
+	return rp->nnodes++;
+}
+
+/*
+ * Add the other case of the characters, if the case is ignored.
+ */
+static void
+_re_fold(struct re_parser *rp, re_set_t *s) {
+	int c;
+
+	if(rp->icase) {
+		for(c = 0; c < 256; c++) {
+			if(RE_HAS(s, c)) {
+				RE_ADD(s, tolower(c));
+				RE_ADD(s, toupper(c));
+			}
+		}
+	}
+}
+
+static int
+_re_set_node(struct re_parser *rp, re_set_t *s) {
+	int n;
+
+	if(rp->nsets == rp->sets_size) {
+		int size = rp->sets_size ? 2 * rp->sets_size : 16;
+		re_set_t *set = realloc(rp->set, size * sizeof(set[0]));
+		if(set == NULL)
+			return -1;
+		rp->set = set;
+		rp->sets_size = size;
+	}
+	rp->set[rp->nsets] = *s;
+
+	n = _re_node(rp, RN_SET, 0, 0);
+	if(n >= 0)
+		rp->node[n].arg = rp->nsets++;
+	return n;
+}
+
+static int
+_re_char_node(struct re_parser *rp, int c) {
+	re_set_t s;
+	memset(&s, 0, sizeof(s));
+	RE_ADD(&s, c);
+	_re_fold(rp, &s);
+	return _re_set_node(rp, &s);
+}
+
+static int
+_re_at_close(struct re_parser *rp) {
+	if(rp->extended)
+		return rp->p[0] == ')';
+	return rp->p[0] == '\\' && rp->p[1] == ')';
+}
+
+static int
+_re_at_bar(struct re_parser *rp) {
+	if(rp->extended)
+		return rp->p[0] == '|';
+	return rp->p[0] == '\\' && rp->p[1] == '|';
+}
+
+static int
+_re_class(re_set_t *s, const unsigned char *name, size_t len) {
+	static const char *names[] = { "alpha", "digit", "alnum", "upper",
+		"lower", "space", "blank", "punct", "print", "graph",
+		"cntrl", "xdigit" };
+	unsigned int i;
+	int c;
+
+	for(i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+		if(strlen(names[i]) == len
+		&& memcmp(names[i], name, len) == 0)
+			break;
+	}
+
+	for(c = 0; c < 256; c++) {
+		int in;
+		switch(i) {
+		case 0: in = isalpha(c); break;
+		case 1: in = isdigit(c); break;
+		case 2: in = isalnum(c); break;
+		case 3: in = isupper(c); break;
+		case 4: in = islower(c); break;
+		case 5: in = isspace(c); break;
+		case 6: in = (c == ' ' || c == '\t'); break;
+		case 7: in = ispunct(c); break;
+		case 8: in = isprint(c); break;
+		case 9: in = isgraph(c); break;
+		case 10: in = iscntrl(c); break;
+		case 11: in = isxdigit(c); break;
+		default:
+			return -1;	/* Unknown class */
+		}
+		if(in) RE_ADD(s, c);
+	}
+
+	return 0;
+}
+
+/*
+ * Single character of the bracket expression, [.c.] and [=c=] included.
+ */
+static int
+_re_bracket_char(const unsigned char **pp) {
+	const unsigned char *p = *pp;
+
+	if(p[0] == '[' && (p[1] == '.' || p[1] == '=')) {
+		if(p[2] == '\0' || p[3] != p[1] || p[4] != ']')
+			return -1;	/* Only the single characters */
+		*pp = p + 5;
+		return p[2];
+	}
+
+	*pp = p + 1;
+	return p[0];
+}
+
+static int
+_re_bracket(struct re_parser *rp) {
+	const unsigned char *p = rp->p + 1;
+	int negate = 0;
+	int first = 1;
+	re_set_t s;
+	int c;
+
+	memset(&s, 0, sizeof(s));
+
+	if(*p == '^') {
+		negate = 1;
+		p++;
+	}
+
+	for(;; first = 0) {
+		int lo, hi;
+
+		if(*p == '\0')
+			return -1;
+		if(*p == ']' && !first) {
+			p++;
+			break;
+		}
+
+		if(p[0] == '[' && p[1] == ':') {
+			const unsigned char *e;
+			for(e = p + 2; *e && !(e[0] == ':' && e[1] == ']'); e++);
+			if(*e == '\0' || _re_class(&s, p + 2, e - (p + 2)))
+				return -1;
+			p = e + 2;
+			continue;
+		}
+
+		lo = _re_bracket_char(&p);
+		if(lo == -1)
+			return -1;
+
+		if(p[0] == '-' && p[1] != ']' && p[1] != '\0') {
+			p++;
+			hi = _re_bracket_char(&p);
+			if(hi == -1 || hi < lo)
+				return -1;
+		} else {
+			hi = lo;
+		}
+
+		for(c = lo; c <= hi; c++)
+			RE_ADD(&s, c);
+	}
+
+	/* [^a] excludes A as well */
+	_re_fold(rp, &s);
+
+	if(negate) {
+		for(c = 0; c < 8; c++)
+			s.bit[c] = ~s.bit[c];
+	}
+
+	rp->p = p;
+	return _re_set_node(rp, &s);
+}
+
+static int _re_alt(struct re_parser *rp, int depth);
+
+static int
+_re_atom(struct re_parser *rp, int depth, int *at_start) {
+	const unsigned char *p = rp->p;
+	int was_start = *at_start;
+	re_set_t s;
+	int c;
+
+	*at_start = 0;
+	memset(&s, 0, sizeof(s));
+
+	if(rp->extended ? p[0] == '(' : (p[0] == '\\' && p[1] == '(')) {
+		int group = rp->ngroups++;
+		int sub;
+		int n;
+
+		rp->p += rp->extended ? 1 : 2;
+		sub = _re_alt(rp, depth + 1);
+		if(sub < 0)
+			return -1;
+		if(!_re_at_close(rp))
+			return -1;	/* Unmatched parenthesis */
+		rp->p += rp->extended ? 1 : 2;
+
+		n = _re_node(rp, RN_GROUP, sub, 0);
+		if(n >= 0)
+			rp->node[n].arg = group;
+		return n;
+	}
+
+	switch(p[0]) {
+	case '^':
+		if(!rp->extended && was_start != 1)
+			break;	/* Ordinary character within BRE */
+		rp->p++;
+		/* The star following the anchor is ordinary in BRE */
+		*at_start = rp->extended ? 0 : 2;
+		return _re_node(rp, RN_BOL, 0, 0);
+	case '$':
+		if(!rp->extended && !(p[1] == '\0'
+			|| (p[1] == '\\' && (p[2] == ')' || p[2] == '|'))))
+			break;	/* Ordinary character within BRE */
+		rp->p++;
+		return _re_node(rp, RN_EOL, 0, 0);
+	case '.':
+		rp->p++;
+		for(c = 1; c < 256; c++)
+			RE_ADD(&s, c);
+		return _re_set_node(rp, &s);
+	case '[':
+		return _re_bracket(rp);
+	case '\\':
+		c = p[1];
+		rp->p += 2;
+		switch(c) {
+		case '\0':
+			return -1;	/* Trailing backslash */
+		case '1': case '2': case '3': case '4': case '5':
+		case '6': case '7': case '8': case '9':
+		case 'b': case 'B': case '<': case '>': case '`': case '\'':
+			return -1;	/* Not regular */
+		case 'w': case 'W':
+		case 's': case 'S':
+			for(c = 0; c < 256; c++) {
+				int in = (p[1] == 'w' || p[1] == 'W')
+					? (isalnum(c) || c == '_') : isspace(c);
+				if(in == (p[1] == 'w' || p[1] == 's'))
+					RE_ADD(&s, c);
+			}
+			return _re_set_node(rp, &s);
+		default:
+			return _re_char_node(rp, c);
+		}
+	}
+
+	rp->p++;
+	return _re_char_node(rp, p[0]);
+}
+
+/*
+ * {m}, {m,} or {m,n}, BRE ones escaped.
+ */
+static int
+_re_interval(struct re_parser *rp, int *min, int *max) {
+	const unsigned char *p = rp->p + (rp->extended ? 1 : 2);
+
+	if(!isdigit(*p))
+		return -1;
+	for(*min = 0; isdigit(*p) && *min <= RE_DUP_LIMIT; p++)
+		*min = *min * 10 + (*p - '0');
+
+	if(*p == ',') {
+		p++;
+		if(isdigit(*p)) {
+			for(*max = 0; isdigit(*p) && *max <= RE_DUP_LIMIT; p++)
+				*max = *max * 10 + (*p - '0');
+		} else {
+			*max = -1;
+		}
+	} else {
+		*max = *min;
+	}
+
+	if(!rp->extended && *p++ != '\\')
+		return -1;
+	if(*p++ != '}')
+		return -1;
+	if(*min > RE_DUP_LIMIT || *max > RE_DUP_LIMIT
+	|| (*max != -1 && *max < *min))
+		return -1;
+
+	rp->p = p;
+	return 0;
+}
+
+static int
+_re_repeat(struct re_parser *rp, int depth, int *at_start) {
+	int atom;
+
+	/* The leading star is ordinary */
+	if(*at_start && rp->p[0] == '*') {
+		rp->p++;
+		*at_start = 0;
+		atom = _re_char_node(rp, '*');
+	} else {
+		atom = _re_atom(rp, depth, at_start);
+		if(*at_start)
+			return atom;	/* BRE ^, the star is next */
+	}
+
+	while(atom >= 0) {
+		const unsigned char *p = rp->p;
+		int min, max;
+
+		if(p[0] == '*') {
+			min = 0, max = -1;
+			rp->p++;
+		} else if(rp->extended ? p[0] == '+'
+				: (p[0] == '\\' && p[1] == '+')) {
+			min = 1, max = -1;
+			rp->p += rp->extended ? 1 : 2;
+		} else if(rp->extended ? p[0] == '?'
+				: (p[0] == '\\' && p[1] == '?')) {
+			min = 0, max = 1;
+			rp->p += rp->extended ? 1 : 2;
+		} else if(rp->extended ? (p[0] == '{' && isdigit(p[1]))
+				: (p[0] == '\\' && p[1] == '{')) {
+			if(_re_interval(rp, &min, &max))
+				return -1;
+		} else {
+			break;
+		}
+
+		atom = _re_node(rp, RN_REPEAT, atom, 0);
+		if(atom >= 0) {
+			rp->node[atom].min = min;
+			rp->node[atom].max = max;
+		}
+	}
+
+	return atom;
+}
+
+static int
+_re_cat(struct re_parser *rp, int depth) {
+	int at_start = 1;	/* 2 right after the BRE ^ */
+	int cat = -1;
+
+	while(rp->p[0] && !_re_at_bar(rp) && !(depth && _re_at_close(rp))) {
+		int atom = _re_repeat(rp, depth, &at_start);
+		if(atom < 0)
+			return -1;
+		cat = (cat == -1) ? atom : _re_node(rp, RN_CAT, cat, atom);
+		if(cat < 0)
+			return -1;
+	}
+
+	if(cat == -1)
+		cat = _re_node(rp, RN_EMPTY, 0, 0);
+
+	return cat;
+}
+
+static int
+_re_alt(struct re_parser *rp, int depth) {
+	int alt;
+
+	alt = _re_cat(rp, depth);
+	while(alt >= 0 && _re_at_bar(rp)) {
+		int r;
+		rp->p += rp->extended ? 1 : 2;
+		r = _re_cat(rp, depth);
+		if(r < 0)
+			return -1;
+		alt = _re_node(rp, RN_ALT, alt, r);
+	}
+
+	return alt;
+}
+
+/*
+ * Code generation.
+ */
+
+static int
+_re_emit(struct ncnf_re *re, enum re_op op, int arg) {
+	struct re_inst *inst;
+
+	if(re->nprog == re->prog_size) {
+		int size = re->prog_size ? 2 * re->prog_size : 32;
+		if(re->nprog >= RE_PROG_MAX) {
+			errno = EINVAL;	/* Too large */
+			return -1;
+		}
+		inst = realloc(re->prog, size * sizeof(inst[0]));
+		if(inst == NULL)
+			return -1;
+		re->prog = inst;
+		re->prog_size = size;
+	}
+
+	inst = &re->prog[re->nprog];
+	inst->op = op;
+	inst->x = re->nprog + 1;
+	inst->y = -1;
+	inst->arg = arg;
+
+	return re->nprog++;
+}
+
+static int
+_re_gen(struct ncnf_re *re, struct re_node *node, int n) {
+	struct re_node *nd = &node[n];
+	int splits[RE_DUP_LIMIT];
+	int s, j, k;
+
+	switch(nd->type) {
+	case RN_EMPTY:
+		return 0;
+	case RN_SET:
+		return (_re_emit(re, RO_CHAR, nd->arg) < 0) ? -1 : 0;
+	case RN_BOL:
+		return (_re_emit(re, RO_BOL, 0) < 0) ? -1 : 0;
+	case RN_EOL:
+		return (_re_emit(re, RO_EOL, 0) < 0) ? -1 : 0;
+	case RN_CAT:
+		if(_re_gen(re, node, nd->l))
+			return -1;
+		return _re_gen(re, node, nd->r);
+	case RN_ALT:
+		if((s = _re_emit(re, RO_SPLIT, 0)) < 0
+		|| _re_gen(re, node, nd->l)
+		|| (j = _re_emit(re, RO_JMP, 0)) < 0)
+			return -1;
+		re->prog[s].y = re->nprog;
+		if(_re_gen(re, node, nd->r))
+			return -1;
+		re->prog[j].x = re->nprog;
+		return 0;
+	case RN_GROUP:
+		/* Only the groups the replacement may refer to */
+		if(nd->arg < RE_GROUPS
+		&& _re_emit(re, RO_SAVE, 2 * nd->arg) < 0)
+			return -1;
+		if(_re_gen(re, node, nd->l))
+			return -1;
+		if(nd->arg < RE_GROUPS
+		&& _re_emit(re, RO_SAVE, 2 * nd->arg + 1) < 0)
+			return -1;
+		return 0;
+	case RN_REPEAT:
+		for(k = 0; k < nd->min; k++) {
+			if(_re_gen(re, node, nd->l))
+				return -1;
+		}
+		if(nd->max == -1) {
+			if((s = _re_emit(re, RO_SPLIT, 0)) < 0
+			|| _re_gen(re, node, nd->l)
+			|| (j = _re_emit(re, RO_JMP, 0)) < 0)
+				return -1;
+			re->prog[j].x = s;
+			re->prog[s].y = re->nprog;
+		} else {
+			for(k = 0; k < nd->max - nd->min; k++) {
+				if((splits[k] = _re_emit(re, RO_SPLIT, 0)) < 0
+				|| _re_gen(re, node, nd->l))
+					return -1;
+			}
+			while(k--)
+				re->prog[splits[k]].y = re->nprog;
+		}
+		return 0;
+	}
+
+	return -1;
+}
+
+/*
+ * Group the bytes no instruction tells apart.
+ */
+static void
+_re_classes(struct ncnf_re *re, int nsets) {
+	int remap[256][2];
+	int i, c, n;
+
+	memset(re->classof, 0, sizeof(re->classof));
+	re->nclasses = 1;
+
+	for(i = 0; i < nsets; i++) {
+		memset(remap, -1, sizeof(remap));
+		for(n = 0, c = 0; c < 256; c++) {
+			int *r = &remap[re->classof[c]][RE_HAS(&re->sets[i], c) ? 1 : 0];
+			if(*r == -1)
+				*r = n++;
+			re->classof[c] = *r;
+		}
+		re->nclasses = n;
+	}
+}
+
+/*
+ * Automata over the sets of instructions.
+ */
+
+struct re_scratch {
+	uint32_t *seen;
+	int *stack;
+	uint32_t *tmp;
+};
+
+static int
+_re_scratch_init(struct ncnf_re *re, struct re_scratch *sc) {
+	sc->seen = malloc(2 * re->words * sizeof(uint32_t));
+	sc->stack = malloc(re->nprog * sizeof(int));
+	if(sc->seen == NULL || sc->stack == NULL) {
+		free(sc->seen);
+		free(sc->stack);
+		return -1;
+	}
+	sc->tmp = sc->seen + re->words;
+	return 0;
+}
+
+static void
+_re_scratch_free(struct re_scratch *sc) {
+	free(sc->seen);
+	free(sc->stack);
+}
+
+/*
+ * Add the instructions reachable from pc without consuming anything.
+ * The seen set is to be cleared before the set is built.
+ */
+static void
+_re_closure(struct ncnf_re *re, struct re_scratch *sc, uint32_t *set,
+		int pc, int bol, int eol) {
+	int sp = 0;
+
+	sc->stack[sp++] = pc;
+	while(sp) {
+		struct re_inst *inst;
+
+		pc = sc->stack[--sp];
+		if(BIT_HAS(sc->seen, pc))
+			continue;
+		BIT_ADD(sc->seen, pc);
+
+		inst = &re->prog[pc];
+		switch(inst->op) {
+		case RO_SPLIT:
+			sc->stack[sp++] = inst->y;
+			/* Fall through */
+		case RO_JMP:
+		case RO_SAVE:
+			sc->stack[sp++] = inst->x;
+			break;
+		case RO_BOL:
+			if(bol) sc->stack[sp++] = inst->x;
+			break;
+		case RO_EOL:
+			if(eol) {
+				sc->stack[sp++] = inst->x;
+				break;
+			}
+			/* Fall through */
+		case RO_CHAR:
+		case RO_MATCH:
+			BIT_ADD(set, pc);
+			break;
+		}
+	}
+}
+
+static void
+_re_start(struct ncnf_re *re, struct re_scratch *sc, uint32_t *set, int bol) {
+	memset(set, 0, re->words * sizeof(uint32_t));
+	memset(sc->seen, 0, re->words * sizeof(uint32_t));
+	_re_closure(re, sc, set, 0, bol, 0);
+}
+
+/*
+ * Consume the byte. Returns 0 if nothing is left.
+ */
+static int
+_re_step(struct ncnf_re *re, struct re_scratch *sc, uint32_t *from,
+		uint32_t *to, int c, int search) {
+	int w, pc;
+	int left = 0;
+
+	memset(to, 0, re->words * sizeof(uint32_t));
+	memset(sc->seen, 0, re->words * sizeof(uint32_t));
+
+	for(w = 0; w < re->words; w++) {
+		uint32_t bits = from[w];
+		while(bits) {
+			struct re_inst *inst;
+			pc = w * 32 + __builtin_ctz(bits);
+			bits &= bits - 1;
+			inst = &re->prog[pc];
+			if(inst->op == RO_CHAR && RE_HAS(&re->sets[inst->arg], c))
+				_re_closure(re, sc, to, inst->x, 0, 0);
+		}
+	}
+
+	if(search)
+		_re_closure(re, sc, to, 0, 0, 0);
+
+	for(w = 0; w < re->words; w++)
+		left |= (to[w] != 0);
+	return left;
+}
+
+static int
+_re_accept(struct ncnf_re *re, struct re_scratch *sc, uint32_t *set) {
+	int flags = 0;
+	int pc;
+
+	memset(sc->tmp, 0, re->words * sizeof(uint32_t));
+	memset(sc->seen, 0, re->words * sizeof(uint32_t));
+
+	for(pc = 0; pc < re->nprog; pc++) {
+		if(!BIT_HAS(set, pc))
+			continue;
+		if(re->prog[pc].op == RO_MATCH)
+			flags |= RA_NOW | RA_END;
+		else if(re->prog[pc].op == RO_EOL)
+			_re_closure(re, sc, sc->tmp, re->prog[pc].x, 0, 1);
+	}
+
+	for(pc = 0; !(flags & RA_END) && pc < re->nprog; pc++) {
+		if(BIT_HAS(sc->tmp, pc) && re->prog[pc].op == RO_MATCH)
+			flags |= RA_END;
+	}
+
+	return flags;
+}
+
+static void
+_re_dfa_free(struct re_dfa *d) {
+	free(d->trans);
+	free(d->accept);
+	memset(d, 0, sizeof(*d));
+}
+
+/*
+ * Subset construction.
+ * Returns 0 if built, 1 if the DFA is too large, -1 if out of memory.
+ */
+static int
+_re_dfa(struct ncnf_re *re, struct re_dfa *d, int search) {
+	struct re_scratch sc;
+	uint32_t *states = NULL;	/* Instruction sets of the states */
+	uint32_t *next = NULL;
+	int *hash = NULL;
+	int hash_size = 2 * RE_DFA_MAX;
+	int size = RE_DFA_MAX;
+	int words = re->words;
+	int ret = -1;
+	int s, c, b;
+
+	if(_re_scratch_init(re, &sc))
+		return -1;
+
+	states = malloc((size_t)size * words * sizeof(uint32_t));
+	next = malloc(words * sizeof(uint32_t));
+	hash = malloc(hash_size * sizeof(int));
+	d->trans = malloc((size_t)size * re->nclasses * sizeof(int));
+	d->accept = malloc(size);
+	if(!states || !next || !hash || !d->trans || !d->accept)
+		goto finish;
+	memset(hash, -1, hash_size * sizeof(int));
+	d->nstates = 0;
+
+	for(s = -2; s < d->nstates; s++) {
+		for(c = 0; c < (s < 0 ? 1 : re->nclasses); c++) {
+			unsigned int h = 0;
+			int found;
+			int w;
+
+			if(s < 0) {
+				/* Start states, s + 2 is the bol */
+				_re_start(re, &sc, next, s + 2);
+			} else {
+				for(b = 0; re->classof[b] != c; b++);
+				if(!_re_step(re, &sc, &states[s * words], next,
+						b, search)) {
+					d->trans[s * re->nclasses + c] = -1;
+					continue;
+				}
+			}
+
+			for(w = 0; w < words; w++)
+				h = (h ^ next[w]) * 16777619;
+			for(h &= hash_size - 1; (found = hash[h]) != -1;
+					h = (h + 1) & (hash_size - 1)) {
+				if(memcmp(&states[found * words], next,
+					words * sizeof(uint32_t)) == 0)
+					break;
+			}
+
+			if(found == -1) {
+				if(d->nstates == size) {
+					ret = 1;	/* Too large */
+					goto finish;
+				}
+				found = d->nstates++;
+				memcpy(&states[found * words], next,
+					words * sizeof(uint32_t));
+				hash[h] = found;
+				d->accept[found] = _re_accept(re, &sc, next);
+			}
+
+			if(s < 0)
+				d->start[s + 2] = found;
+			else
+				d->trans[s * re->nclasses + c] = found;
+		}
+	}
+
+	/* Give back the unused states */
+	if(d->nstates < size) {
+		int *trans = realloc(d->trans,
+			(size_t)d->nstates * re->nclasses * sizeof(int));
+		unsigned char *accept = realloc(d->accept, d->nstates);
+		if(trans) d->trans = trans;
+		if(accept) d->accept = accept;
+	}
+
+	ret = 0;
+finish:
+	if(ret)
+		_re_dfa_free(d);
+	free(states);
+	free(next);
+	free(hash);
+	_re_scratch_free(&sc);
+	return ret;
+}
+
+/*
+ * Matching.
+ */
+
+/*
+ * Whether the value matches anywhere.
+ * Returns -1 (ENOMEM) if the NFA simulation runs out of memory.
+ */
+static int
+_re_search(struct ncnf_re *re, const unsigned char *s, size_t len) {
+	struct re_scratch sc;
+	uint32_t *mem, *cur, *next;
+	size_t i;
+	int found = 0;
+
+	if(len == 0)
+		return re->matches_empty;
+
+	if(!re->nfa_only) {
+		struct re_dfa *d = &re->search;
+		int st = d->start[1];
+		for(i = 0; i < len; i++) {
+			if(d->accept[st] & RA_NOW)
+				return 1;
+			st = d->trans[st * re->nclasses + re->classof[s[i]]];
+			if(st == -1)
+				return 0;
+		}
+		return (d->accept[st] & RA_END) ? 1 : 0;
+	}
+
+	/* Simulate the NFA */
+	if(_re_scratch_init(re, &sc)) {
+		errno = ENOMEM;
+		return -1;
+	}
+	mem = cur = malloc(2 * re->words * sizeof(uint32_t));
+	if(mem == NULL) {
+		_re_scratch_free(&sc);
+		errno = ENOMEM;
+		return -1;
+	}
+	next = cur + re->words;
+
+	_re_start(re, &sc, cur, 1);
+	for(i = 0; i < len; i++) {
+		uint32_t *t;
+		if(_re_accept(re, &sc, cur) & RA_NOW)
+			break;
+		_re_step(re, &sc, cur, next, s[i], 1);
+		t = cur, cur = next, next = t;
+	}
+	found = (_re_accept(re, &sc, cur) & RA_END) ? 1 : 0;
+
+	free(mem);
+	_re_scratch_free(&sc);
+	return found;
+}
+
+/*
+ * The end of the longest match starting at the position, or -1.
+ * Returns -2 (ENOMEM) if the NFA simulation runs out of memory.
+ */
+static ssize_t
+_re_longest(struct ncnf_re *re, const unsigned char *s, size_t len,
+		size_t start) {
+	struct re_scratch sc;
+	uint32_t *mem, *cur, *next;
+	ssize_t last = -1;
+	size_t i;
+
+	if(len == 0)
+		return re->matches_empty ? 0 : -1;
+
+	if(!re->nfa_only) {
+		struct re_dfa *d = &re->anchored;
+		int st = d->start[start == 0];
+		for(i = start; i < len; i++) {
+			if(d->accept[st] & RA_NOW)
+				last = i;
+			st = d->trans[st * re->nclasses + re->classof[s[i]]];
+			if(st == -1)
+				return last;
+		}
+		return (d->accept[st] & RA_END) ? (ssize_t)len : last;
+	}
+
+	if(_re_scratch_init(re, &sc)) {
+		errno = ENOMEM;
+		return -2;
+	}
+	mem = cur = malloc(2 * re->words * sizeof(uint32_t));
+	if(mem == NULL) {
+		_re_scratch_free(&sc);
+		errno = ENOMEM;
+		return -2;
+	}
+	next = cur + re->words;
+
+	_re_start(re, &sc, cur, start == 0);
+	for(i = start; i <= len; i++) {
+		uint32_t *t;
+		int flags = _re_accept(re, &sc, cur);
+		if(i == len) {
+			if(flags & RA_END)
+				last = len;
+			break;
+		}
+		if(flags & RA_NOW)
+			last = i;
+		if(!_re_step(re, &sc, cur, next, s[i], 0))
+			break;
+		t = cur, cur = next, next = t;
+	}
+
+	free(mem);
+	_re_scratch_free(&sc);
+	return last;
+}
+
+/*
+ * Find the subexpressions of the known match, the leftmost-first way
+ * (Pike's VM).
+ */
+struct re_thread {
+	int pc;
+	int *caps;
+};
+
+struct re_pike {
+	struct ncnf_re *re;
+	const unsigned char *s;
+	size_t len;
+	int *mark;
+	int stamp;
+	int ncaps;
+};
+
+static void
+_re_addthread(struct re_pike *vm, struct re_thread *list, int *n,
+		int pc, int *caps, size_t pos) {
+	struct re_inst *inst = &vm->re->prog[pc];
+	int saved;
+
+	if(vm->mark[pc] == vm->stamp)
+		return;
+	vm->mark[pc] = vm->stamp;
+
+	switch(inst->op) {
+	case RO_JMP:
+		_re_addthread(vm, list, n, inst->x, caps, pos);
+		break;
+	case RO_SPLIT:
+		_re_addthread(vm, list, n, inst->x, caps, pos);
+		_re_addthread(vm, list, n, inst->y, caps, pos);
+		break;
+	case RO_SAVE:
+		saved = caps[inst->arg];
+		caps[inst->arg] = pos;
+		_re_addthread(vm, list, n, inst->x, caps, pos);
+		caps[inst->arg] = saved;
+		break;
+	case RO_BOL:
+		if(pos == 0)
+			_re_addthread(vm, list, n, inst->x, caps, pos);
+		break;
+	case RO_EOL:
+		if(pos == vm->len)
+			_re_addthread(vm, list, n, inst->x, caps, pos);
+		break;
+	case RO_CHAR:
+	case RO_MATCH:
+		list[*n].pc = pc;
+		memcpy(list[*n].caps, caps, vm->ncaps * sizeof(int));
+		(*n)++;
+		break;
+	}
+}
+
+static int
+_re_groups(struct ncnf_re *re, const unsigned char *s, size_t len,
+		size_t start, size_t end, int *caps) {
+	struct re_thread *list[2];
+	struct re_pike vm;
+	int *memory;
+	int *scratch;
+	int count[2];
+	int ncaps = 2 * RE_GROUPS;
+	int cur = 0;
+	int found = 0;
+	size_t pos;
+	int i;
+
+	memory = malloc((re->nprog + (2 * re->nprog + 1) * ncaps)
+		* sizeof(int));
+	list[0] = malloc(2 * re->nprog * sizeof(struct re_thread));
+	if(memory == NULL || list[0] == NULL) {
+		free(memory);
+		free(list[0]);
+		return -1;
+	}
+	list[1] = list[0] + re->nprog;
+	vm.mark = memory;
+	scratch = memory + re->nprog;
+	for(i = 0; i < 2 * re->nprog; i++)
+		list[0][i].caps = scratch + (i + 1) * ncaps;
+	memset(vm.mark, -1, re->nprog * sizeof(int));
+
+	vm.re = re;
+	vm.s = s;
+	vm.len = len;
+	vm.stamp = 0;
+	vm.ncaps = ncaps;
+
+	for(i = 0; i < ncaps; i++)
+		scratch[i] = -1;
+	count[cur] = 0;
+	_re_addthread(&vm, list[cur], &count[cur], 0, scratch, start);
+
+	for(pos = start; count[cur]; pos++) {
+		int nxt = !cur;
+
+		vm.stamp++;
+		count[nxt] = 0;
+		for(i = 0; i < count[cur]; i++) {
+			struct re_thread *t = &list[cur][i];
+			struct re_inst *inst = &re->prog[t->pc];
+
+			if(inst->op == RO_MATCH) {
+				if(pos == end) {
+					memcpy(caps, t->caps, ncaps * sizeof(int));
+					found = 1;
+					break;	/* Lower priority ones are cut */
+				}
+				continue;
+			}
+
+			if(pos < end && RE_HAS(&re->sets[inst->arg], s[pos])) {
+				memcpy(scratch, t->caps, ncaps * sizeof(int));
+				_re_addthread(&vm, list[nxt], &count[nxt],
+					inst->x, scratch, pos + 1);
+			}
+		}
+		if(found || pos == end)
+			break;
+		cur = nxt;
+	}
+
+	free(memory);
+	free(list[0]);
+
+	caps[0] = start;
+	caps[1] = end;
+	return found ? 0 : -1;
+}
+
+/*
+ * Growing string.
+ */
+struct re_buf {
+	char *buf;
+	size_t len;
+	size_t size;
+};
+
+static int
+_re_append(struct re_buf *b, const char *s, size_t n) {
+	if(b->len + n + 1 > b->size) {
+		size_t size = b->size ? b->size : 64;
+		char *p;
+		while(size < b->len + n + 1)
+			size <<= 1;
+		p = realloc(b->buf, size);
+		if(p == NULL)
+			return -1;
+		b->buf = p;
+		b->size = size;
+	}
+	memcpy(b->buf + b->len, s, n);
+	b->len += n;
+	b->buf[b->len] = '\0';
+	return 0;
+}
+
+static int
+_re_replace(struct ncnf_re *re, struct re_buf *b, const char *s,
+		size_t len, size_t start, size_t end) {
+	int caps[2 * RE_GROUPS];
+	const char *r;
+
+	if(re->refers
+	&& _re_groups(re, (const unsigned char *)s, len, start, end, caps))
+		return -1;
+	caps[0] = start;
+	caps[1] = end;
+
+	for(r = re->replacement; *r; r++) {
+		int g;
+
+		if(*r == '&') {
+			g = 0;
+		} else if(r[0] == '\\' && r[1] >= '0' && r[1] <= '9') {
+			g = *++r - '0';
+		} else {
+			char c = *r;
+			if(r[0] == '\\' && r[1]) {
+				c = *++r;
+				if(c == 'n') c = '\n';
+			}
+			if(_re_append(b, &c, 1))
+				return -1;
+			continue;
+		}
+
+		if(caps[2 * g] != -1 && caps[2 * g + 1] != -1
+		&& _re_append(b, s + caps[2 * g],
+				caps[2 * g + 1] - caps[2 * g]))
+			return -1;
+	}
+
+	return 0;
+}
+
+char *
+_ncnf_re_rewrite(struct ncnf_re *re, const char *value) {
+	struct re_buf b = { NULL, 0, 0 };
+	const unsigned char *s = (const unsigned char *)value;
+	size_t len = strlen(value);
+	ssize_t prev_end = -1;
+	size_t i;
+
+	switch(re->kind) {
+	case RE_MATCH:
+		return strdup(value);
+	case RE_TRANSLATE:
+		if(_re_append(&b, value, len))
+			return NULL;
+		for(i = 0; i < len; i++)
+			b.buf[i] = re->tr[s[i]];
+		return b.buf;
+	case RE_SUBST:
+		break;
+	}
+
+	switch(_re_search(re, s, len)) {
+	case -1:
+		return NULL;
+	case 0:
+		return strdup(value);
+	}
+
+	for(i = 0; i <= len;) {
+		ssize_t end = _re_longest(re, s, len, i);
+
+		if(end == -2)
+			goto fail;
+
+		/* No empty match right after the previous one */
+		if(end == -1 || (end == (ssize_t)i && prev_end == (ssize_t)i)) {
+			if(i < len && _re_append(&b, value + i, 1))
+				goto fail;
+			i++;
+			continue;
+		}
+
+		if(_re_replace(re, &b, value, len, i, end))
+			goto fail;
+		prev_end = end;
+
+		if(end == (ssize_t)i) {
+			if(i < len && _re_append(&b, value + i, 1))
+				goto fail;
+			i++;
+		} else {
+			i = end;
+		}
+
+		if(!re->global) {
+			if(i < len && _re_append(&b, value + i, len - i))
+				goto fail;
+			break;
+		}
+	}
+
+	if(b.buf == NULL)
+		return strdup("");
+	return b.buf;
+fail:
+	free(b.buf);
+	return NULL;
+}
+
+int
+_ncnf_re_match(struct ncnf_re *re, const char *value) {
+	if(re->kind != RE_MATCH)
+		return 1;
+	return _re_search(re, (const unsigned char *)value, strlen(value));
+}
+
+int
+_ncnf_re_rewrites(struct ncnf_re *re) {
+	return re->kind != RE_MATCH;
+}
+
+/*
+ * Compilation.
+ */
+
+/*
+ * Copy the field up to the unescaped delimiter.
+ */
+static char *
+_re_field(const char **pp, int delim) {
+	const char *p = *pp;
+	char *field;
+	char *f;
+
+	field = malloc(strlen(p) + 1);
+	if(field == NULL)
+		return NULL;
+
+	for(f = field; *p != delim; p++) {
+		if(*p == '\0') {
+			free(field);
+			errno = EINVAL;
+			return NULL;
+		}
+		if(p[0] == '\\' && p[1] == delim) {
+			*f++ = *++p;
+			continue;
+		}
+		if(p[0] == '\\' && p[1])
+			*f++ = *p++;
+		*f++ = *p;
+	}
+	*f = '\0';
+
+	*pp = p + 1;
+	return field;
+}
+
+static void
+_re_destroy(struct ncnf_re *re) {
+	if(re) {
+		_re_dfa_free(&re->search);
+		_re_dfa_free(&re->anchored);
+		free(re->prog);
+		free(re->sets);
+		free(re->replacement);
+		free(re->text);
+		free(re);
+	}
+}
+
+/*
+ * Single character of the y expression, with \n for the newline.
+ */
+static int
+_re_tr_char(const unsigned char **pp) {
+	const unsigned char *p = *pp;
+
+	if(p[0] == '\\' && p[1]) {
+		*pp = p + 2;
+		return (p[1] == 'n') ? '\n' : p[1];
+	}
+
+	*pp = p + 1;
+	return p[0];
+}
+
+static int
+_re_translation(struct ncnf_re *re, const char *src, const char *dst) {
+	const unsigned char *s = (const unsigned char *)src;
+	const unsigned char *d = (const unsigned char *)dst;
+	int c;
+
+	for(c = 0; c < 256; c++)
+		re->tr[c] = c;
+
+	while(*s && *d) {
+		c = _re_tr_char(&s);
+		re->tr[c] = _re_tr_char(&d);
+	}
+
+	return (*s || *d) ? -1 : 0;	/* Different lengths */
+}
+
+static struct ncnf_re *
+_re_compile(const char *expr) {
+	struct re_parser rp;
+	struct re_scratch sc;
+	struct ncnf_re *re;
+	const char *p = expr;
+	char *regex = NULL;
+	int root;
+	int delim = 0;
+	int ret;
+
+	re = calloc(1, sizeof(*re));
+	if(re == NULL)
+		return NULL;
+	memset(&rp, 0, sizeof(rp));
+
+	re->text = strdup(expr);
+	if(re->text == NULL)
+		goto fail;
+
+	if((p[0] == 's' || p[0] == 'y') && p[1] && ispunct((unsigned char)p[1])
+	&& p[1] != '\\') {
+		re->kind = (p[0] == 's') ? RE_SUBST : RE_TRANSLATE;
+		delim = p[1];
+		p += 2;
+	} else if(p[0] == '/') {
+		delim = '/';
+		p++;
+	}
+
+	if(delim) {
+		regex = _re_field(&p, delim);
+		if(regex == NULL)
+			goto fail;
+		if(re->kind != RE_MATCH) {
+			re->replacement = _re_field(&p, delim);
+			if(re->replacement == NULL)
+				goto fail;
+		}
+		for(; *p; p++) {
+			switch(*p) {
+			case 'e': rp.extended = 1; break;
+			case 'i': rp.icase = 1; break;
+			case 'g': re->global = 1; break;
+			}
+		}
+	} else {
+		/* Bare regex */
+		regex = strdup(p);
+		if(regex == NULL)
+			goto fail;
+	}
+
+	if(re->kind == RE_TRANSLATE) {
+		if(_re_translation(re, regex, re->replacement)) {
+			errno = EINVAL;
+			goto fail;
+		}
+		free(regex);
+		return re;
+	}
+
+	if(re->replacement) {
+		for(p = re->replacement; *p; p++) {
+			if(p[0] == '\\' && p[1] >= '1' && p[1] <= '9')
+				re->refers = 1;
+			if(p[0] == '\\' && p[1])
+				p++;
+		}
+	}
+
+	/*
+	 * Parse, and generate the program.
+	 */
+	rp.p = (const unsigned char *)regex;
+	rp.ngroups = 1;
+	errno = EINVAL;
+	root = _re_alt(&rp, 0);
+	if(root < 0 || *rp.p)
+		goto fail;
+
+	re->sets = rp.set;
+	rp.set = NULL;
+	if(_re_gen(re, rp.node, root) || _re_emit(re, RO_MATCH, 0) < 0)
+		goto fail;
+	re->words = (re->nprog + 31) / 32;
+	_re_classes(re, rp.nsets);
+
+	/* The only position where both ^ and $ hold */
+	if(_re_scratch_init(re, &sc))
+		goto fail;
+	memset(sc.seen, 0, re->words * sizeof(uint32_t));
+	memset(sc.tmp, 0, re->words * sizeof(uint32_t));
+	_re_closure(re, &sc, sc.tmp, 0, 1, 1);
+	re->matches_empty = BIT_HAS(sc.tmp, re->nprog - 1) ? 1 : 0;
+	_re_scratch_free(&sc);
+
+	ret = _re_dfa(re, &re->search, 1);
+	if(ret == 0 && re->kind == RE_SUBST)
+		ret = _re_dfa(re, &re->anchored, 0);
+	if(ret == -1)
+		goto fail;
+	if(ret == 1) {
+		/* Too large, simulate the NFA instead */
+		_re_dfa_free(&re->search);
+		_re_dfa_free(&re->anchored);
+		re->nfa_only = 1;
+	}
+
+	free(rp.node);
+	free(regex);
+	return re;
+fail:
+	free(rp.node);
+	free(rp.set);
+	free(regex);
+	_re_destroy(re);
+	return NULL;
+}
+
+static void
+_re_cache_lock(void) {
+#ifdef	HAVE_LIBPTHREAD
+	pthread_mutex_lock(&re_cache_lock);
+#endif	/* HAVE_LIBPTHREAD */
+}
+
+static void
+_re_cache_unlock(void) {
+#ifdef	HAVE_LIBPTHREAD
+	pthread_mutex_unlock(&re_cache_lock);
+#endif	/* HAVE_LIBPTHREAD */
+}
+
+static struct ncnf_re *
+_re_cache_find(const char *expr) {
+	struct ncnf_re *re;
+
+	for(re = re_cache; re; re = re->next) {
+		if(strcmp(re->text, expr) == 0) {
+			re->refs++;
+			return re;
+		}
+	}
+
+	return NULL;
+}
+
+struct ncnf_re *
+_ncnf_re_compile(const char *expr) {
+	struct ncnf_re *cached;
+	struct ncnf_re *re;
+
+	if(expr == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	_re_cache_lock();
+	re = _re_cache_find(expr);
+	_re_cache_unlock();
+	if(re)
+		return re;
+
+	/* Compile outside the lock; the others may do the same */
+	re = _re_compile(expr);
+	if(re == NULL)
+		return NULL;
+	re->refs = 1;
+
+	_re_cache_lock();
+	cached = _re_cache_find(expr);
+	if(cached == NULL) {
+		re->next = re_cache;
+		re_cache = re;
+	}
+	_re_cache_unlock();
+
+	if(cached) {
+		_re_destroy(re);
+		re = cached;
+	}
+
+	return re;
+}
+
+void
+_ncnf_re_free(struct ncnf_re *re) {
+	struct ncnf_re **rep;
+	int last;
+
+	if(re == NULL)
+		return;
+
+	_re_cache_lock();
+	last = (--re->refs == 0);
+	if(last) {
+		for(rep = &re_cache; *rep != re; rep = &(*rep)->next);
+		*rep = re->next;
+	}
+	_re_cache_unlock();
+
+	if(last)
+		_re_destroy(re);
+}
+
+#ifdef	MODULE_TEST
+
+static struct {
+	const char *expr;
+	const char *value;
+	const char *result;	/* Rewritten value, or NULL if no match */
+} tests[] = {
+	{ "/0|1|on|off/e", "on", "on" },
+	{ "/0|1|on|off/e", "yes", NULL },
+	{ "/^[0-9]\\+$/", "12345", "12345" },
+	{ "/^[0-9]\\+$/", "123a", NULL },
+	{ "/^a\\{2,3\\}$/", "aaa", "aaa" },
+	{ "/^a\\{2,3\\}$/", "aaaa", NULL },
+	{ "/^(ab|cd){2}$/e", "abcd", "abcd" },
+	{ "/^(ab|cd){2}$/e", "abc", NULL },
+	{ "/^HELLO$/i", "hello", "hello" },
+	{ "/^[^a]$/i", "A", NULL },
+	{ "/^[[:digit:]]\\w*$/", "1a_b", "1a_b" },
+	{ "/a|b/", "a|b", "a|b" },
+	{ "/a|b/", "a", NULL },
+	{ "/^*x/", "*x", "*x" },
+	{ "/x$/", "ax", "ax" },
+	{ "/x$/", "xa", NULL },
+	{ "s|a\\|b|-|", "a|b", "-" },
+	{ "s,a\\,b,-\\,,", "a,b", "-," },
+	{ "^[a-z]+$", "abc", NULL },	/* Bare BRE */
+	{ "^[a-z]\\+$", "abc", "abc" },
+	{ "s/fail/FAIL/", "a fail fail", "a FAIL fail" },
+	{ "s/fail/FAIL/g", "a fail fail", "a FAIL FAIL" },
+	{ "s/x*/-/g", "abc", "-a-b-c-" },
+	{ "s/a*/x/g", "baaac", "xbxcx" },
+	{ "s/\\([a-z]*\\)=\\([0-9]*\\)/\\2=\\1/", "key=42", "42=key" },
+	{ "s,(a+)(b+),[&:\\2\\1],e", "xaabbby", "x[aabbb:bbbaa]y" },
+	{ "s/O/0/gi", "foo", "f00" },
+	{ "s/$/!/", "hey", "hey!" },
+	{ "y/abc/xyz/", "aabbcc", "xxyyzz" },
+};
+
+int
+main(int ac, char **av) {
+	struct ncnf_re *re;
+	struct ncnf_re *re2;
+	unsigned int i;
+	char *s;
+
+	(void)ac;
+	(void)av;
+
+	for(i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+		re = _ncnf_re_compile(tests[i].expr);
+		assert(re);
+		if(_ncnf_re_rewrites(re)) {
+			s = _ncnf_re_rewrite(re, tests[i].value);
+			assert(s);
+			if(strcmp(s, tests[i].result)) {
+				fprintf(stderr, "%s on \"%s\": \"%s\"\n",
+					tests[i].expr, tests[i].value, s);
+				assert(!"rewrite");
+			}
+			free(s);
+		} else if(_ncnf_re_match(re, tests[i].value)
+				!= (tests[i].result != NULL)) {
+			fprintf(stderr, "%s on \"%s\"\n",
+				tests[i].expr, tests[i].value);
+			assert(!"match");
+		}
+		_ncnf_re_free(re);
+	}
+
+	/* Shared by the same text */
+	re = _ncnf_re_compile("/^[a-z]+$/e");
+	re2 = _ncnf_re_compile("/^[a-z]+$/e");
+	assert(re && re == re2);
+	_ncnf_re_free(re2);
+	assert(_ncnf_re_match(re, "abc"));
+	_ncnf_re_free(re);
+
+	/* Too large for the DFA */
+	re = _ncnf_re_compile("/[ab]*a[ab]{12}$/e");
+	assert(re && re->nfa_only);
+	assert(_ncnf_re_match(re, "bbbabbbbbbbbbbbb"));
+	assert(!_ncnf_re_match(re, "bbbbbbbbbbbbbbbb"));
+	_ncnf_re_free(re);
+
+	/* Invalid or unsupported */
+	errno = 0;
+	assert(_ncnf_re_compile("/(a/e") == NULL && errno == EINVAL);
+	assert(_ncnf_re_compile("/\\(a\\)\\1/") == NULL);
+	assert(_ncnf_re_compile("/a[b/") == NULL);
+	assert(_ncnf_re_compile("s/a/b") == NULL);
+	assert(_ncnf_re_compile("y/ab/c/") == NULL);
+
+	assert(re_cache == NULL);
+
+	return 0;
+}
+
+#endif	/* MODULE_TEST */
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2001, 2002, 2003, 2004, 2005  Netli, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * $Id$
+ */
+/*
+ * Built-in regular expressions, for the .vr types and NCQL.
+ *
+ * The expressions are written the sed(1) way:
+ *	/regex/flags		matches the value anywhere
+ *	s/regex/replacement/flags	rewrites the value
+ *	y/source/destination/	transliterates the value
+ * The s and y expressions may use any punctuation character as the
+ * delimiter instead of '/'. Anything else is taken as a bare regex.
+ * Regular expressions are POSIX basic ones (with the GNU \| \+ \?
+ * and \w \W \s \S), or extended ones with the "e" flag.
+ * Back references and word boundaries are not supported.
+ * The "i" flag ignores case, the "g" one replaces every occurrence.
+ * The replacement may refer to the match with & or \0,
+ * and to the subexpressions with \1 to \9.
+ *
+ * The expressions are compiled into DFAs, falling back to the NFA
+ * simulation for the extremely large ones. Compiled expressions
+ * are shared by all the users of the same text, and may be used
+ * by several threads at once.
+ */
+#ifndef	__NCNF_RE_H__
+#define	__NCNF_RE_H__
+
+/*
+ * Returns NULL (errno is set to EINVAL if the expression is invalid).
+ */
+struct ncnf_re *_ncnf_re_compile(const char *expr);
+void _ncnf_re_free(struct ncnf_re *);
+
+/*
+ * Whether the value matches the /regex/.
+ * The values always "match" the rewriting (s and y) expressions.
+ * Returns -1 (ENOMEM) if there's no memory to run the match.
+ */
+int _ncnf_re_match(struct ncnf_re *, const char *value);
+
+/*
+ * Whether the expression rewrites the values.
+ */
+int _ncnf_re_rewrites(struct ncnf_re *);
+
+/*
+ * Apply the s or y expression to the value.
+ * Returns the new string, to be free()'d, or NULL if memory is exhausted.
+ */
+char *_ncnf_re_rewrite(struct ncnf_re *, const char *value);
+
+#endif	/* __NCNF_RE_H__ */
@@ -350,7 +350,7 @@ ncnf_sf_split(const char *msg, const char *delim, int flags) {
 	return sl;
 }
 
-static char *_sf_sjoin_buf = NULL;
+static __thread char *_sf_sjoin_buf = NULL;	/* Per thread */
 
 char *
 ncnf_sf_sjoin(ncnf_sf_svect *s, const char *delimiter) {
@@ -0,0 +1,783 @@
+/*
+ * Copyright (c) 2001, 2002, 2003, 2004, 2005  Netli, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * $Id$
+ */
+/*
+ * Compiled configuration snapshots.
+ *
+ * Layout of the image (all offsets are relative to the image start):
+ *
+ * 	struct snap_header
+ * 	struct snap_node	nodes[nodes]	Node 0 is the root
+ * 	struct snap_entry	entries[entries]
+ * 	strings
+ *
+ * Nodes are numbered breadth-first, so the children of every node
+ * occupy a contiguous range of entries, and every child has a greater
+ * number than its parent. References are stored as node numbers.
+ *
+ * Strings are identified by their slot: the offset from the start of
+ * the strings area in SNAP_ALIGN units. Every string occupies a
+ * SNAP_STR_HDR bytes long header (holding the length in the image)
+ * followed by the characters and the terminating '\0'. The header
+ * space is where bstr_place() puts the basic string's shadow when the
+ * strings are used right from the mapped image. Slot 0 is never used
+ * and stands for the absent string.
+ */
+#include "headers.h"
+#include "ncnf_int.h"
+#include "ncnf_snap.h"
+
+#define	SNAP_MAGIC	"NCNFSNAP"
+#define	SNAP_VERSION	1
+#define	SNAP_ENDIAN	0x01020304
+#define	SNAP_ALIGN	16
+#define	SNAP_STR_HDR	16
+#define	SNAP_ROUND(n)	(((n) + SNAP_ALIGN - 1) & ~((uint64_t)SNAP_ALIGN - 1))
+
+struct snap_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t endian;	/* SNAP_ENDIAN, as seen by the writer */
+	uint32_t nodes;		/* Number of nodes */
+	uint32_t entries;	/* Number of children entries */
+	uint64_t nodes_off;
+	uint64_t entries_off;
+	uint64_t strings_off;
+	uint64_t strings_size;
+};
+
+struct snap_node {
+	uint8_t  obj_class;	/* enum obj_class */
+	uint8_t  reserved;
+	uint16_t flags;		/* Class-specific flags */
+	uint32_t config_line;
+	uint32_t type;		/* String slots */
+	uint32_t value;
+	uint32_t ref_type;	/* NOBJ_REFERENCE only */
+	uint32_t ref_value;
+	uint32_t target;	/* Referenced node */
+	uint32_t first;		/* Children entries */
+	uint32_t count;
+};
+
+struct snap_entry {
+	uint32_t node;
+	uint8_t  collection;	/* enum collections_e */
+	uint8_t  ignore_in_search;
+	uint16_t reserved;
+};
+
+/*
+ * Collections which make up the saved tree.
+ * Lazy notificators are the run-time matter.
+ */
+static enum collections_e _snap_colls[] = {
+	COLLECTION_ATTRIBUTES, COLLECTION_OBJECTS, COLLECTION_INSERTS
+};
+#define	SNAP_COLLS	(sizeof(_snap_colls) / sizeof(_snap_colls[0]))
+
+
+/*
+ * Writer state.
+ */
+struct snap_wctx {
+	struct ncnf_obj_s **obj;	/* Nodes in breadth-first order */
+	struct snap_node *node;
+	size_t nodes;
+	size_t nodes_size;		/* Allocated for obj and node */
+
+	struct snap_entry *entry;
+	size_t entries;
+	size_t entries_size;
+
+	char *str;			/* Strings area */
+	size_t str_len;
+	size_t str_size;
+
+	genhash_t *obj_idx;		/* Object -> node number + 1 */
+	genhash_t *str_slot;		/* String -> slot */
+};
+
+static int
+_snap_grow(void **ptr, size_t *size, size_t need, size_t elsize) {
+	size_t new_size = *size ? *size : 64;
+	void *p;
+
+	if(need <= *size)
+		return 0;
+
+	while(new_size < need)
+		new_size <<= 1;
+
+	p = realloc(*ptr, new_size * elsize);
+	if(p == NULL)
+		return -1;
+
+	*ptr = p;
+	*size = new_size;
+	return 0;
+}
+
+static int
+_snap_add_str(struct snap_wctx *wc, bstr_t str, uint32_t *slot) {
+	size_t len, need;
+	void *p;
+
+	if(str == NULL) {
+		*slot = 0;
+		return 0;
+	}
+
+	p = genhash_get(wc->str_slot, str);
+	if(p) {
+		*slot = (uintptr_t)p;
+		return 0;
+	}
+
+	len = bstr_len(str);
+	need = SNAP_ROUND(wc->str_len + SNAP_STR_HDR + len + 1);
+	if(need / SNAP_ALIGN > UINT32_MAX) {
+		errno = EFBIG;
+		return -1;
+	}
+	if(_snap_grow((void **)&wc->str, &wc->str_size, need, 1))
+		return -1;
+
+	memset(wc->str + wc->str_len, 0, need - wc->str_len);
+	*(uint32_t *)(wc->str + wc->str_len) = len;
+	memcpy(wc->str + wc->str_len + SNAP_STR_HDR, str, len);
+
+	*slot = wc->str_len / SNAP_ALIGN;
+	wc->str_len = need;
+
+	return genhash_add(wc->str_slot, str, (void *)(uintptr_t)*slot);
+}
+
+static int
+_snap_add_node(struct snap_wctx *wc, struct ncnf_obj_s *obj) {
+	size_t size = wc->nodes_size;
+
+	if(_snap_grow((void **)&wc->obj, &size, wc->nodes + 1,
+			sizeof(*wc->obj))
+	|| _snap_grow((void **)&wc->node, &wc->nodes_size, wc->nodes + 1,
+			sizeof(*wc->node)))
+		return -1;
+
+	wc->obj[wc->nodes] = obj;
+	memset(&wc->node[wc->nodes], 0, sizeof(*wc->node));
+	wc->nodes++;
+
+	return genhash_add(wc->obj_idx, obj, (void *)(uintptr_t)wc->nodes);
+}
+
+/*
+ * Describe the node and enlist its children.
+ */
+static int
+_snap_fill(struct snap_wctx *wc, size_t n) {
+	struct ncnf_obj_s *obj = wc->obj[n];
+	uint32_t first;
+	unsigned c;
+	int i;
+
+	wc->node[n].obj_class = obj->obj_class;
+	wc->node[n].config_line = obj->config_line;
+	if(_snap_add_str(wc, obj->type, &wc->node[n].type)
+	|| _snap_add_str(wc, obj->value, &wc->node[n].value))
+		return -1;
+
+	switch(obj->obj_class) {
+	case NOBJ_ROOT:
+	case NOBJ_COMPLEX:
+		first = wc->entries;
+		for(c = 0; c < SNAP_COLLS; c++) {
+			collection_t *coll = &obj->m_collection[_snap_colls[c]];
+			for(i = 0; i < coll->entries; i++) {
+				struct snap_entry *se;
+
+				if(_snap_grow((void **)&wc->entry,
+						&wc->entries_size,
+						wc->entries + 1, sizeof(*se)))
+					return -1;
+				se = &wc->entry[wc->entries++];
+				memset(se, 0, sizeof(*se));
+				se->node = wc->nodes;
+				se->collection = _snap_colls[c];
+				se->ignore_in_search
+					= coll->entry[i].ignore_in_search;
+				/* May move wc->node */
+				if(_snap_add_node(wc, coll->entry[i].object))
+					return -1;
+			}
+		}
+		wc->node[n].first = first;
+		wc->node[n].count = wc->entries - first;
+		break;
+	case NOBJ_ATTRIBUTE:
+		wc->node[n].flags = obj->m_attr_flags;
+		break;
+	case NOBJ_REFERENCE:
+		wc->node[n].flags = obj->m_ref_flags;
+		if(_snap_add_str(wc, obj->m_ref_type, &wc->node[n].ref_type)
+		|| _snap_add_str(wc, obj->m_ref_value, &wc->node[n].ref_value))
+			return -1;
+		/* Target is filled in later, when all nodes are known */
+		break;
+	case NOBJ_INSERTION:
+		wc->node[n].flags = obj->m_insert_flags;
+		break;
+	default:
+		/* Iterators and such are not the part of the tree */
+		errno = EINVAL;
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+_snap_out(FILE *fp, const void *data, size_t size) {
+	static const char zero[SNAP_ALIGN];
+
+	if(data == NULL) {
+		assert(size <= sizeof(zero));
+		data = zero;
+	}
+
+	if(size && fwrite(data, size, 1, fp) != 1)
+		return -1;
+
+	return 0;
+}
+
+static int
+_snap_save(struct snap_wctx *wc, FILE *fp) {
+	struct snap_header hdr;
+	size_t nodes_size = wc->nodes * sizeof(struct snap_node);
+	size_t entries_size = wc->entries * sizeof(struct snap_entry);
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, SNAP_MAGIC, sizeof(hdr.magic));
+	hdr.version = SNAP_VERSION;
+	hdr.endian = SNAP_ENDIAN;
+	hdr.nodes = wc->nodes;
+	hdr.entries = wc->entries;
+	hdr.nodes_off = SNAP_ROUND(sizeof(hdr));
+	hdr.entries_off = SNAP_ROUND(hdr.nodes_off + nodes_size);
+	hdr.strings_off = SNAP_ROUND(hdr.entries_off + entries_size);
+	hdr.strings_size = wc->str_len;
+
+	if(_snap_out(fp, &hdr, sizeof(hdr))
+	|| _snap_out(fp, NULL, hdr.nodes_off - sizeof(hdr))
+	|| _snap_out(fp, wc->node, nodes_size)
+	|| _snap_out(fp, NULL, hdr.entries_off - hdr.nodes_off - nodes_size)
+	|| _snap_out(fp, wc->entry, entries_size)
+	|| _snap_out(fp, NULL,
+		hdr.strings_off - hdr.entries_off - entries_size)
+	|| _snap_out(fp, wc->str, wc->str_len)
+	|| fflush(fp))
+		return -1;
+
+	return 0;
+}
+
+int
+_ncnf_snap_write(struct ncnf_obj_s *root, const char *filename) {
+	struct snap_wctx wc;
+	char *tmpname;
+	FILE *fp;
+	size_t n;
+	int fd;
+	int ret = -1;
+
+	if(root == NULL || filename == NULL
+	|| root->obj_class != NOBJ_ROOT) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	memset(&wc, 0, sizeof(wc));
+	wc.obj_idx = genhash_new(cmpf_void, hashf_void, NULL, NULL);
+	wc.str_slot = genhash_new(cmpf_string, hashf_string, NULL, NULL);
+	/* Slot 0 stands for the absent string */
+	wc.str_len = SNAP_ALIGN;
+	wc.str_size = SNAP_ALIGN;
+	wc.str = calloc(1, wc.str_size);
+	if(wc.obj_idx == NULL || wc.str_slot == NULL || wc.str == NULL
+	|| _snap_add_node(&wc, root))
+		goto finish;
+
+	/*
+	 * Breadth-first numbering of the nodes.
+	 */
+	for(n = 0; n < wc.nodes; n++) {
+		if(_snap_fill(&wc, n))
+			goto finish;
+	}
+
+	/*
+	 * Resolve the references into node numbers.
+	 */
+	for(n = 0; n < wc.nodes; n++) {
+		struct ncnf_obj_s *obj = wc.obj[n];
+		void *p;
+
+		if(obj->obj_class != NOBJ_REFERENCE)
+			continue;
+
+		p = obj->m_direct_reference
+			? genhash_get(wc.obj_idx, obj->m_direct_reference)
+			: NULL;
+		if(p == NULL) {
+			/* Unresolved or pointing outside of the tree */
+			_ncnf_debug_print(1,
+				"Reference `%s \"%s\"' at line %d "
+				"points outside of the tree",
+				obj->type, obj->value, obj->config_line);
+			errno = EINVAL;
+			goto finish;
+		}
+		wc.node[n].target = (uintptr_t)p - 1;
+	}
+
+	/*
+	 * Write into the temporary file, then rename it over.
+	 */
+	tmpname = alloca(strlen(filename) + sizeof(".XXXXXX"));
+	strcpy(tmpname, filename);
+	strcat(tmpname, ".XXXXXX");
+	fd = mkstemp(tmpname);
+	if(fd == -1)
+		goto finish;
+	fp = fdopen(fd, "w");
+	if(fp == NULL) {
+		close(fd);
+		unlink(tmpname);
+		goto finish;
+	}
+
+	if(_snap_save(&wc, fp) || fchmod(fd, 0644)) {
+		int save_errno = errno;
+		fclose(fp);
+		unlink(tmpname);
+		errno = save_errno;
+		goto finish;
+	}
+
+	if(fclose(fp)) {
+		int save_errno = errno;
+		unlink(tmpname);
+		errno = save_errno;
+		goto finish;
+	}
+
+	if(rename(tmpname, filename)) {
+		int save_errno = errno;
+		unlink(tmpname);
+		errno = save_errno;
+		goto finish;
+	}
+
+	ret = 0;
+
+finish:
+	genhash_destroy(wc.obj_idx);
+	genhash_destroy(wc.str_slot);
+	free(wc.obj);
+	free(wc.node);
+	free(wc.entry);
+	free(wc.str);
+
+	return ret;
+}
+
+
+/*
+ * Reader state.
+ */
+struct snap_rctx {
+	void *mr;
+	int in_place;			/* Strings are used from the image */
+
+	char *strings;
+	uint64_t slots;			/* Size of the strings area in slots */
+	unsigned char *valid;		/* Bitmap of string starts */
+
+	uint32_t adopted;		/* Nodes linked to their parents */
+};
+
+/*
+ * Check the strings area and, if needed, turn every string
+ * into the basic string right inside the image.
+ */
+static int
+_snap_scan_strings(struct snap_rctx *rc) {
+	uint64_t slot;
+
+	rc->valid = calloc(1, (rc->slots + 7) / 8);
+	if(rc->valid == NULL)
+		return -1;
+
+	for(slot = 1; slot < rc->slots;) {
+		char *hdr = rc->strings + slot * SNAP_ALIGN;
+		uint64_t len = *(uint32_t *)hdr;
+		uint64_t next = slot
+			+ SNAP_ROUND(SNAP_STR_HDR + len + 1) / SNAP_ALIGN;
+
+		if(next > rc->slots || hdr[SNAP_STR_HDR + len] != '\0') {
+			errno = EINVAL;
+			return -1;
+		}
+
+		if(rc->in_place) {
+			/*
+			 * The image holds one reference to each string,
+			 * so they are never released back.
+			 */
+			(void)_ncnf_mr_str_place(rc->mr,
+				hdr + SNAP_STR_HDR - bstr_header_size(), len);
+		}
+
+		rc->valid[slot >> 3] |= 1 << (slot & 7);
+		slot = next;
+	}
+
+	return 0;
+}
+
+/*
+ * Get the new reference to the string in the given slot.
+ */
+static int
+_snap_str(struct snap_rctx *rc, uint32_t slot, bstr_t *str) {
+	char *s;
+
+	*str = NULL;
+
+	if(slot == 0)
+		return 0;
+
+	if(slot >= rc->slots || !(rc->valid[slot >> 3] & (1 << (slot & 7)))) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	s = rc->strings + (uint64_t)slot * SNAP_ALIGN + SNAP_STR_HDR;
+	if(rc->in_place)
+		*str = bstr_ref(s);
+	else
+		*str = _ncnf_mr_str(rc->mr, s, *(uint32_t *)(s - SNAP_STR_HDR));
+
+	return *str ? 0 : -1;
+}
+
+static struct ncnf_obj_s *
+_snap_new_obj(struct snap_rctx *rc, struct snap_node *sn, int is_root) {
+	struct ncnf_obj_s *obj;
+	bstr_t type = NULL, value = NULL;
+	bstr_t ref_type = NULL, ref_value = NULL;
+
+	switch(sn->obj_class) {
+	case NOBJ_ROOT:
+		if(is_root) break;
+		/* Fall through */
+	default:
+		errno = EINVAL;
+		return NULL;
+	case NOBJ_COMPLEX:
+	case NOBJ_ATTRIBUTE:
+	case NOBJ_REFERENCE:
+	case NOBJ_INSERTION:
+		if(is_root) {
+			errno = EINVAL;
+			return NULL;
+		}
+		break;
+	}
+
+	if(sn->obj_class == NOBJ_REFERENCE) {
+		if(_snap_str(rc, sn->ref_type, &ref_type)
+		|| _snap_str(rc, sn->ref_value, &ref_value)
+		|| !ref_type || !ref_value)
+			goto fail;
+	}
+
+	if(_snap_str(rc, sn->type, &type)
+	|| _snap_str(rc, sn->value, &value))
+		goto fail;
+
+	obj = _ncnf_obj_new(rc->mr, sn->obj_class, type, value,
+		sn->config_line);
+	if(obj == NULL)
+		goto fail;
+	bstr_free(type);
+	bstr_free(value);
+
+	switch(obj->obj_class) {
+	case NOBJ_ATTRIBUTE:
+		obj->m_attr_flags = sn->flags;
+		break;
+	case NOBJ_REFERENCE:
+		obj->m_ref_flags = sn->flags;
+		obj->m_ref_type = ref_type;
+		obj->m_ref_value = ref_value;
+		break;
+	case NOBJ_INSERTION:
+		obj->m_insert_flags = sn->flags;
+		break;
+	default:
+		break;
+	}
+
+	return obj;
+
+fail:
+	bstr_free(type);
+	bstr_free(value);
+	bstr_free(ref_type);
+	bstr_free(ref_value);
+	if(errno == 0) errno = EINVAL;
+	return NULL;
+}
+
+/*
+ * Put the children into the node's collections.
+ */
+static int
+_snap_link(struct snap_rctx *rc, struct ncnf_obj_s **objs,
+		struct snap_header *hdr, struct snap_node *nodes,
+		struct snap_entry *entries, uint32_t n) {
+	struct snap_node *sn = &nodes[n];
+	struct ncnf_obj_s *obj = objs[n];
+	int counts[MAX_COLLECTIONS] = { 0 };
+	uint32_t i;
+
+	if(sn->obj_class == NOBJ_REFERENCE) {
+		if(sn->target >= hdr->nodes || sn->target == n) {
+			errno = EINVAL;
+			return -1;
+		}
+		obj->m_direct_reference = objs[sn->target];
+	}
+
+	if(sn->count == 0)
+		return 0;
+
+	if(!_NOBJ_CONTAINER(obj)
+	|| sn->first > hdr->entries
+	|| sn->count > hdr->entries - sn->first) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	for(i = sn->first; i < sn->first + sn->count; i++) {
+		if(entries[i].collection >= COLLECTION_LAZY_NOTIF) {
+			errno = EINVAL;
+			return -1;
+		}
+		counts[entries[i].collection]++;
+	}
+
+	for(i = 0; i < MAX_COLLECTIONS; i++) {
+		if(counts[i] && _ncnf_coll_reserve(rc->mr,
+				&obj->m_collection[i], counts[i]))
+			return -1;
+	}
+
+	for(i = sn->first; i < sn->first + sn->count; i++) {
+		struct snap_entry *se = &entries[i];
+		struct ncnf_obj_s *child;
+		collection_t *coll = &obj->m_collection[se->collection];
+
+		/*
+		 * Children always follow the parent. Each node may be
+		 * adopted only once, which keeps the structure a tree.
+		 */
+		if(se->node <= n || se->node >= hdr->nodes
+		|| objs[se->node]->parent) {
+			errno = EINVAL;
+			return -1;
+		}
+		child = objs[se->node];
+
+		if(_ncnf_coll_insert(rc->mr, coll, child, MERGE_NOFLAGS))
+			return -1;
+		coll->entry[coll->entries - 1].ignore_in_search
+			= se->ignore_in_search;
+		child->parent = obj;
+		rc->adopted++;
+	}
+
+	return 0;
+}
+
+int
+_ncnf_snap_read(const char *filename, struct ncnf_obj_s **root, enum ncnf_mr_flags mr_flags) {
+	struct snap_rctx rc;
+	struct snap_header *hdr;
+	struct snap_node *nodes;
+	struct snap_entry *entries;
+	struct ncnf_obj_s **objs = NULL;
+	struct stat sb;
+	char *base;
+	size_t size;
+	uint32_t n;
+	int fd;
+
+	if(filename == NULL || root == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	fd = open(filename, O_RDONLY);
+	if(fd == -1)
+		return -1;
+
+	if(fstat(fd, &sb) == -1) {
+		close(fd);
+		return -1;
+	}
+
+	if((sb.st_mode & S_IFMT) != S_IFREG
+	|| sb.st_size < (off_t)sizeof(struct snap_header)) {
+		close(fd);
+		errno = EINVAL;
+		return -1;
+	}
+
+	/*
+	 * Private writable mapping: the string headers
+	 * are filled in place.
+	 */
+	size = sb.st_size;
+	base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(base == MAP_FAILED)
+		return -1;
+
+	hdr = (struct snap_header *)base;
+	if(memcmp(hdr->magic, SNAP_MAGIC, sizeof(hdr->magic))
+	|| hdr->version != SNAP_VERSION
+	|| hdr->endian != SNAP_ENDIAN
+	|| hdr->nodes == 0
+	|| hdr->entries != hdr->nodes - 1
+	|| hdr->nodes_off % sizeof(uint32_t)
+	|| hdr->entries_off % sizeof(uint32_t)
+	|| hdr->strings_off % SNAP_ALIGN
+	|| hdr->strings_size % SNAP_ALIGN
+	|| hdr->nodes_off > size
+	|| hdr->nodes > (size - hdr->nodes_off) / sizeof(struct snap_node)
+	|| hdr->entries_off > size
+	|| hdr->entries
+		> (size - hdr->entries_off) / sizeof(struct snap_entry)
+	|| hdr->strings_off > size
+	|| hdr->strings_size > size - hdr->strings_off
+	|| bstr_header_size() > SNAP_STR_HDR) {
+		munmap(base, size);
+		errno = EINVAL;
+		return -1;
+	}
+
+	nodes = (struct snap_node *)(base + hdr->nodes_off);
+	entries = (struct snap_entry *)(base + hdr->entries_off);
+
+	memset(&rc, 0, sizeof(rc));
+	rc.strings = base + hdr->strings_off;
+	rc.slots = hdr->strings_size / SNAP_ALIGN;
+
+	if(mr_flags != NMR_DISABLED) {
+		rc.mr = _ncnf_mr_new(mr_flags);
+		if(rc.mr == NULL) {
+			munmap(base, size);
+			return -1;
+		}
+		if(mr_flags & NMR_STRINGS) {
+			/* The image now belongs to the region */
+			rc.in_place = 1;
+			_ncnf_mr_attach_image(rc.mr, base, size);
+		}
+	}
+
+	objs = calloc(hdr->nodes, sizeof(*objs));
+	if(objs == NULL || _snap_scan_strings(&rc))
+		goto fail;
+
+	/*
+	 * Create the objects, then put them together.
+	 */
+	for(n = 0; n < hdr->nodes; n++) {
+		objs[n] = _snap_new_obj(&rc, &nodes[n], n == 0);
+		if(objs[n] == NULL)
+			goto fail;
+	}
+
+	for(n = 0; n < hdr->nodes; n++) {
+		if(_snap_link(&rc, objs, hdr, nodes, entries, n))
+			goto fail;
+	}
+
+	/* Every node but the root must have found its place */
+	if(rc.adopted != hdr->nodes - 1) {
+		errno = EINVAL;
+		goto fail;
+	}
+
+	*root = objs[0];
+	_ncnf_mr_set_owner(rc.mr, *root);
+
+	free(objs);
+	free(rc.valid);
+	if(!rc.in_place)
+		munmap(base, size);
+
+	return 0;
+
+fail:
+	if(objs) {
+		int save_errno = errno;
+		/*
+		 * Destroy the detached subtrees. Children follow their
+		 * parents, so going backwards never visits a destroyed one.
+		 */
+		for(n = hdr->nodes; n-- > 0;) {
+			if(objs[n] && objs[n]->parent == NULL)
+				_ncnf_obj_destroy(objs[n]);
+		}
+		free(objs);
+		errno = save_errno;
+	}
+	free(rc.valid);
+	_ncnf_mr_destroy(rc.mr);
+	if(!rc.in_place)
+		munmap(base, size);
+	if(errno == 0 || errno == EINVAL) {
+		_ncnf_debug_print(1, "%s: Invalid snapshot", filename);
+		errno = EINVAL;
+	}
+
+	return -1;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2001, 2002, 2003, 2004, 2005  Netli, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * $Id$
+ */
+/*
+ * Compiled configuration snapshots.
+ *
+ * A snapshot is a position-independent binary image of the fully
+ * resolved and validated configuration tree. It is mapped into memory
+ * and turned into the regular objects tree without any parsing,
+ * reference resolution or validation.
+ */
+#ifndef	__NCNF_SNAP_H__
+#define	__NCNF_SNAP_H__
+
+#include "ncnf_mr.h"
+
+/*
+ * Save the tree into the snapshot file.
+ * The file is replaced atomically.
+ * Returns 0 if all OK, -1 if error (errno is set).
+ */
+int _ncnf_snap_write(struct ncnf_obj_s *root, const char *filename);
+
+/*
+ * Map the snapshot file and create the objects tree out of it.
+ * With NMR_STRINGS, the strings are used right from the mapped image,
+ * which stays mapped until the region is destroyed.
+ * Returns 0 if all OK, -1 if error (errno is set).
+ */
+int _ncnf_snap_read(const char *filename, struct ncnf_obj_s **root,
+	enum ncnf_mr_flags mr_flags);
+
+#endif	/* __NCNF_SNAP_H__ */
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2001, 2002, 2003, 2004, 2005  Netli, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * $Id$
+ */
+/*
+ * Token intern pool.
+ */
+#include "headers.h"
+#include "ncnf_int.h"
+#include "ncnf_tpool.h"
+
+struct ncnf_token_pool {
+	genhash_t *tokens;	/* bstr_t -> the same bstr_t */
+	void *mr;		/* Memory region for the strings */
+	size_t max_bytes;	/* Trimming threshold, or 0 */
+	struct ncnf_token_pool_stats stats;
+};
+
+/* Memory held by the string */
+#define	TOKEN_BYTES(b)	((size_t)bstr_len(b) + 1 + bstr_header_size())
+
+struct ncnf_token_pool *
+_ncnf_tpool_new(void *mr, size_t max_bytes) {
+	struct ncnf_token_pool *tp;
+
+	tp = calloc(1, sizeof(*tp));
+	if(tp == NULL)
+		return NULL;
+
+	tp->tokens = genhash_new(cmpf_string, hashf_string,
+		NULL, (void (*)(void *))bstr_free);
+	if(tp->tokens == NULL) {
+		free(tp);
+		return NULL;
+	}
+
+	tp->mr = mr;
+	tp->max_bytes = max_bytes;
+
+	return tp;
+}
+
+bstr_t
+_ncnf_tpool_intern(struct ncnf_token_pool *tp, const char *str, int len) {
+	bstr_t b;
+
+	b = genhash_get(tp->tokens, (void *)str);
+	if(b) {
+		tp->stats.hits++;
+		return b;
+	}
+
+	b = _ncnf_mr_str(tp->mr, str, len);
+	if(b == NULL)
+		return NULL;
+
+	if(genhash_add(tp->tokens, b, b)) {
+		bstr_free(b);
+		return NULL;
+	}
+
+	tp->stats.misses++;
+	tp->stats.entries++;
+	tp->stats.bytes += TOKEN_BYTES(b);
+
+	return b;
+}
+
+int
+_ncnf_tpool_evict(struct ncnf_token_pool *tp) {
+	genhash_iter_t iter;
+	bstr_t *victims;
+	bstr_t b;
+	int count = 0;
+	int i;
+
+	if(tp->stats.entries == 0)
+		return 0;
+
+	/* The hash may not be modified while it is iterated */
+	victims = malloc(tp->stats.entries * sizeof(victims[0]));
+	if(victims == NULL)
+		return -1;
+
+	genhash_iter_init(&iter, tp->tokens, 0);
+	while(genhash_iter(&iter, &b, NULL)) {
+		if(bstr_refs(b) == 1)
+			victims[count++] = b;
+	}
+
+	for(i = 0; i < count; i++) {
+		tp->stats.bytes -= TOKEN_BYTES(victims[i]);
+		genhash_del(tp->tokens, victims[i]);
+	}
+
+	free(victims);
+
+	tp->stats.entries -= count;
+	tp->stats.evictions += count;
+
+	return count;
+}
+
+int
+_ncnf_tpool_trim(struct ncnf_token_pool *tp) {
+	if(tp->max_bytes == 0 || tp->stats.bytes <= tp->max_bytes)
+		return 0;
+	return _ncnf_tpool_evict(tp);
+}
+
+void
+_ncnf_tpool_stats(struct ncnf_token_pool *tp,
+		struct ncnf_token_pool_stats *stats) {
+	*stats = tp->stats;
+}
+
+void
+_ncnf_tpool_destroy(struct ncnf_token_pool *tp) {
+	if(tp) {
+		genhash_destroy(tp->tokens);
+		free(tp);
+	}
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2001, 2002, 2003, 2004, 2005  Netli, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * $Id$
+ */
+/*
+ * Token intern pool.
+ *
+ * The scanner interns identical tokens, so the tree refers to a single
+ * copy of each type name and value. A pool is either private to a single
+ * read, taking its strings from the memory region of the tree, or created
+ * by the application and shared by the consecutive reads, keeping its
+ * strings on the heap.
+ */
+#ifndef	__NCNF_TPOOL_H__
+#define	__NCNF_TPOOL_H__
+
+#include "ncnf_mr.h"
+
+/*
+ * Create a new pool.
+ * The strings are created with _ncnf_mr_str(mr, ...).
+ * When max_bytes is not zero, _ncnf_tpool_trim() evicts the unused
+ * strings once the pool has grown above that size.
+ */
+struct ncnf_token_pool *_ncnf_tpool_new(void *mr, size_t max_bytes);
+
+/*
+ * Find the token in the pool, or add its copy to the pool.
+ * The (str) must be terminated at (len): the pool is looked up
+ * before anything is copied, so a repeated token costs no allocation.
+ * The returned string is owned by the pool; bstr_ref() it to keep.
+ * Returns NULL if memory is exhausted.
+ */
+bstr_t _ncnf_tpool_intern(struct ncnf_token_pool *, const char *str, int len);
+
+/*
+ * Evict the strings referenced by nobody but the pool.
+ * _ncnf_tpool_trim() does that only if the pool is above its limit.
+ * Returns the number of evicted strings or -1 if memory is exhausted.
+ */
+int _ncnf_tpool_evict(struct ncnf_token_pool *);
+int _ncnf_tpool_trim(struct ncnf_token_pool *);
+
+/*
+ * Fill in the pool usage counters.
+ */
+void _ncnf_tpool_stats(struct ncnf_token_pool *,
+	struct ncnf_token_pool_stats *);
+
+/*
+ * Destroy the pool. The strings still referenced elsewhere survive.
+ */
+void _ncnf_tpool_destroy(struct ncnf_token_pool *);
+
+#endif	/* __NCNF_TPOOL_H__ */
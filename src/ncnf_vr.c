@@ -28,13 +28,25 @@
 #include "headers.h"
 #include "ncnf_int.h"
 #include "ncnf_vr.h"
+#include "ncnf_re.h"
 
 /*
  * Forward declarations
  */
-static int _ncnf_vr_validate(struct vr_config *vc, struct ncnf_obj_s *obj);
-static int _vr_check_entity(struct vr_config *vc, struct ncnf_obj_s *obj, struct vr_entity *e, int check_results);
-static int _vr_check_rule(struct vr_config *vc, struct ncnf_obj_s *obj, struct vr_rule *rule);
+static int _ncnf_vr_validate(struct vr_config *vc, struct ncnf_obj_s *obj, struct ncnf_obj_s *base);
+/*
+ * Entities being checked against the object, innermost first.
+ * The rule set is shared, so the recursion is tracked on the stack.
+ */
+struct vr_active {
+	struct vr_entity *entity;
+	struct vr_active *next;
+};
+
+static int _vr_check_entity(struct vr_config *vc, struct ncnf_obj_s *obj, struct vr_entity *e, int check_results, struct vr_active *active);
+static int _vr_sweep(struct vr_config *vc, struct ncnf_obj_s *obj, struct vr_entity *e, int lo, int hi, int *count, int check_results);
+static int _vr_check_rule(struct vr_config *vc, struct ncnf_obj_s *obj, struct vr_rule *rule, int *count, struct vr_active *active);
+static int _vr_check_found(struct vr_config *vc, struct ncnf_obj_s *obj, struct vr_rule *rule, struct ncnf_obj_s *found, int count, struct vr_active *active);
 
 static char *
 __vr_obj_class2string(enum vr_obj_class vr_obj_class) {
@@ -78,11 +90,17 @@ __vr_collection_by_obj_class(struct ncnf_obj_s *obj, enum vr_obj_class vr_obj_cl
 
 void
 ncnf_vr_destroy(struct vr_config *vc) {
-	if(vc) {
+	if(vc && __atomic_sub_fetch(&vc->refs, 1, __ATOMIC_ACQ_REL) == 0) {
 		if(vc->entities)
 			genhash_destroy(vc->entities);
 		if(vc->types)
 			genhash_destroy(vc->types);
+		if(vc->by_type) {
+			unsigned int i;
+			for(i = 0; i < vc->by_type_size; i++)
+				free(vc->by_type[i].named);
+			free(vc->by_type);
+		}
 		free(vc);
 	}
 }
@@ -90,13 +108,22 @@ ncnf_vr_destroy(struct vr_config *vc) {
 
 int
 ncnf_validate(struct ncnf_obj_s *obj, struct vr_config *vc) {
+	return ncnf_validate_since(obj, vc, NULL);
+}
+
+int
+ncnf_validate_since(struct ncnf_obj_s *obj, struct vr_config *vc,
+		struct ncnf_obj_s *baseline) {
 
 	if(obj == NULL || vc == NULL) {
 		errno = EINVAL;
 		return -1;
 	}
 
-	if(_ncnf_vr_validate(vc, obj)) {
+	if(baseline && baseline->obj_class != obj->obj_class)
+		baseline = NULL;
+
+	if(_ncnf_vr_validate(vc, obj, baseline)) {
 		return -1;
 	}
 
@@ -104,8 +131,13 @@ ncnf_validate(struct ncnf_obj_s *obj, struct vr_config *vc) {
 }
 
 
+/*
+ * The base is the object's counterpart within the configuration
+ * validated before, or NULL. Its unchanged subtrees are not checked.
+ */
 static int
-_ncnf_vr_validate(struct vr_config *vc, struct ncnf_obj_s *obj) {
+_ncnf_vr_validate(struct vr_config *vc, struct ncnf_obj_s *obj,
+		struct ncnf_obj_s *base) {
 	struct vr_entity *e;
 	int i;
 
@@ -116,17 +148,20 @@ _ncnf_vr_validate(struct vr_config *vc, struct ncnf_obj_s *obj) {
 	 */
 	if(obj->obj_class == NOBJ_ROOT) {
 
-		e = _vr_get_entity(vc, "ROOT", NULL, 0);
+		if(_ncnf_diff_unchanged(obj, base))
+			return 0;
+
+		e = vc->root;
 		if(e == NULL) {
 			/* Unknown entity */
 			return 0;
 		}
 	
-		if(_vr_check_entity(vc, obj, e, 1))
+		if(_vr_check_entity(vc, obj, e, 1, NULL))
 			return -1;
 	} else if(obj->obj_class == NOBJ_COMPLEX) {
 
-		e = _vr_get_entity(vc, obj->type, obj->value, 0);
+		e = _vr_find_entity(vc, obj->type_atom, obj->value);
 		if(e == NULL) {
 			/* Unknown entity */
 			return 0;
@@ -142,20 +177,26 @@ _ncnf_vr_validate(struct vr_config *vc, struct ncnf_obj_s *obj) {
 	for(i = 0; i < obj->m_collection[COLLECTION_OBJECTS].entries; i++) {
 		struct ncnf_obj_s *next_obj
 			= obj->m_collection[COLLECTION_OBJECTS].entry[i].object;
+		struct ncnf_obj_s *next_base;
 
-		e = _vr_get_entity(vc, next_obj->type, next_obj->value, 0);
+		e = _vr_find_entity(vc, next_obj->type_atom, next_obj->value);
 		if(e == NULL) {
 			/* Dont touch unknown entity */
 			continue;
 		}
 
-		if(_vr_check_entity(vc, next_obj, e, 1))
+		/* Trust the previous validation of the unchanged subtree */
+		next_base = _ncnf_diff_counterpart(base, next_obj);
+		if(_ncnf_diff_unchanged(next_obj, next_base))
+			continue;
+
+		if(_vr_check_entity(vc, next_obj, e, 1, NULL))
 			return -1;
 
 		/*
 		 * Recursively go down the tree.
 		 */
-		if(_ncnf_vr_validate(vc, next_obj))
+		if(_ncnf_vr_validate(vc, next_obj, next_base))
 			return -1;
 
 	}
@@ -166,77 +207,151 @@ _ncnf_vr_validate(struct vr_config *vc, struct ncnf_obj_s *obj) {
 }
 
 
+/*
+ * Check the entity's rules against the children of the object.
+ * The rules applicable to each child are found by its type in the
+ * dispatch table, so the children are visited once for all the rules.
+ * Checking the entity reference marks the other children, so each such
+ * rule is checked on its own, between the sweeps of the other rules.
+ */
 static int
-_vr_check_entity(struct vr_config *vc, struct ncnf_obj_s *obj, struct vr_entity *e, int check_results) {
-	collection_t *coll;
-	struct vr_rule *rule;
+_vr_check_entity(struct vr_config *vc, struct ncnf_obj_s *obj, struct vr_entity *e, int check_results, struct vr_active *active) {
+	struct vr_dispatch *d = e->dispatch;
+	struct vr_active self;
+	struct vr_active *a;
+	int *count;
+	int lo, hi;
+	int ret = 0;
 	int i;
 
-	assert(vc && obj && e);
+	assert(vc && obj && e && d);
+
+	for(a = active; a; a = a->next)
+		if(a->entity == e)
+			return 0;
+
+	if(d->rules == 0)
+		/* Allow everything by default */
+		return 0;
 
-	if(e->already_here)
+	if(obj->obj_class != NOBJ_ROOT && obj->obj_class != NOBJ_COMPLEX)
 		return 0;
-	else
-		e->already_here = 1;
 
-	for(rule = e->rules; rule; rule = rule->next) {
-		if(_vr_check_rule(vc, obj, rule))
-			break;
-	}
+	self.entity = e;
+	self.next = active;
 
-	e->already_here = 0;
+	count = alloca(d->rules * sizeof(count[0]));
+	memset(count, 0, d->rules * sizeof(count[0]));
 
-	if(rule)
-		return -1;
+	for(lo = 0; ret == 0 && lo <= d->rules; lo = hi + 1) {
+		int last;
 
-	if(check_results == 0)
-		return 0;
+		for(hi = lo; hi < d->rules; hi++)
+			if(d->rule[hi]->_entity_reference)
+				break;
 
-	if(e->rules == NULL)
-		/* Allow everything by default */
-		return 0;
+		/* Everything is checked by the last sweep */
+		last = check_results && hi == d->rules;
 
-	if(obj->obj_class != NOBJ_ROOT && obj->obj_class != NOBJ_COMPLEX)
-		return 0;
+		if(hi > lo || last)
+			ret = _vr_sweep(vc, obj, e, lo, hi, count, last);
 
-	/*
-	 * Checking if everything is marked as checked.
-	 */
+		if(ret == 0 && hi < d->rules)
+			ret = _vr_check_rule(vc, obj, d->rule[hi], &count[hi],
+				&self);
+	}
 
-	coll = &obj->m_collection[COLLECTION_OBJECTS];
-	for(i = 0; i < coll->entries; i++) {
-		struct ncnf_obj_s *o;
-		o = coll->entry[i].object;
-		if(o->mark == 0) {
-			_ncnf_debug_print(1, "Object `%s \"%s\"' at line %d used in `%s \"%s\"` at line %d is not mentioned in ruleset for entity `%s%s%s%s'",
-				o->type, o->value,
-				o->config_line,
-				obj->type,
-				obj->value,
-				obj->config_line,
-				e->type,
-				e->name?" \"":"",
-				e->name?e->name:"",
-				e->name?"\"":""
+	if(ret)
+		return -1;
+
+	for(i = 0; i < d->rules; i++) {
+		struct vr_rule *rule = d->rule[i];
+
+		if((rule->mandatory != 0) && (count[i] == 0)) {
+			_ncnf_debug_print(1,
+				"Mandatory %s %s missing in entity `%s \"%s\"' at line %d",
+				__vr_obj_class2string(rule->vr_obj_class),
+				rule->name,
+				obj->type?obj->type:"ROOT",
+				obj->value?obj->value:"<unnamed>",
+				obj->config_line
 			);
 			return -1;
 		}
 	}
 
-	coll = &obj->m_collection[COLLECTION_ATTRIBUTES];
-	for(i = 0; i < coll->entries; i++) {
-		struct ncnf_obj_s *o;
-		o = coll->entry[i].object;
-		if(o->mark == 0) {
-			_ncnf_debug_print(1, "Attribute `%s \"%s\"' at line %d is not mentioned in ruleset for entity `%s%s%s%s'",
-				o->type,
-				o->value,
-				o->config_line,
-				e->type,
-				e->name?" \"":"",
-				e->name?e->name:"",
-				e->name?"\"":""
-			);
+	return 0;
+}
+
+/*
+ * Check the rules [lo, hi) against every child of the object.
+ * With check_results, also check that every child is mentioned
+ * in the ruleset.
+ */
+static int
+_vr_sweep(struct vr_config *vc, struct ncnf_obj_s *obj, struct vr_entity *e, int lo, int hi, int *count, int check_results) {
+	struct vr_dispatch *d = e->dispatch;
+	int k;
+
+	for(k = 1; k >= 0; k--) {
+		collection_t *coll = &obj->m_collection[k
+			? COLLECTION_OBJECTS : COLLECTION_ATTRIBUTES];
+		int i;
+
+		for(i = 0; i < coll->entries; i++) {
+			struct ncnf_obj_s *o = coll->entry[i].object;
+			struct vr_dispatch_slot *slot;
+			unsigned int h;
+			int *index;
+
+			/* Rules for this type */
+			index = d->wildcard[k];
+			for(h = _VR_ATOM_HASH(o->type_atom);
+			    (slot = &d->slot[k][h & (d->slots[k] - 1)])->atom;
+			    h++) {
+				if(slot->atom == o->type_atom) {
+					index = slot->index;
+					break;
+				}
+			}
+
+			for(; *index != -1 && *index < hi; index++) {
+				if(*index < lo)
+					continue;
+				if(_vr_check_found(vc, obj, d->rule[*index],
+						o, ++count[*index], NULL))
+					return -1;
+			}
+
+			if(check_results == 0 || o->mark)
+				continue;
+
+			/*
+			 * Not marked as checked.
+			 */
+			if(k) {
+				_ncnf_debug_print(1, "Object `%s \"%s\"' at line %d used in `%s \"%s\"` at line %d is not mentioned in ruleset for entity `%s%s%s%s'",
+					o->type, o->value,
+					o->config_line,
+					obj->type,
+					obj->value,
+					obj->config_line,
+					e->type,
+					e->name?" \"":"",
+					e->name?e->name:"",
+					e->name?"\"":""
+				);
+			} else {
+				_ncnf_debug_print(1, "Attribute `%s \"%s\"' at line %d is not mentioned in ruleset for entity `%s%s%s%s'",
+					o->type,
+					o->value,
+					o->config_line,
+					e->type,
+					e->name?" \"":"",
+					e->name?e->name:"",
+					e->name?"\"":""
+				);
+			}
 			return -1;
 		}
 	}
@@ -244,11 +359,12 @@ _vr_check_entity(struct vr_config *vc, struct ncnf_obj_s *obj, struct vr_entity
 	return 0;
 }
 
+/*
+ * Check the single rule against the children of the object.
+ */
 static int
-_vr_check_rule(struct vr_config *vc, struct ncnf_obj_s *obj, struct vr_rule *rule) {
+_vr_check_rule(struct vr_config *vc, struct ncnf_obj_s *obj, struct vr_rule *rule, int *count, struct vr_active *active) {
 	collection_t *coll;
-	int count = 0;
-	int rule_name_star = 0;
 	int i;
 
 	assert(vc && obj && rule);
@@ -257,219 +373,226 @@ _vr_check_rule(struct vr_config *vc, struct ncnf_obj_s *obj, struct vr_rule *rul
 	if(coll == NULL)
 		return 0;
 
-	rule_name_star = strcmp(rule->name, "*")?0:1;
-
 	for(i = 0; i < coll->entries; i++) {
 		struct ncnf_obj_s *found = coll->entry[i].object;
-		struct vr_type *ty;
-		char *value;
 
-		if(!rule_name_star && strcmp(found->type, rule->name))
+		if(rule->name_atom && found->type_atom != rule->name_atom)
 			continue;
 
-		count++;
+		if(_vr_check_found(vc, obj, rule, found, ++(*count), active))
+			return -1;
+	}
+
+	return 0;
+}
 
-		if(rule->vr_obj_class == VR_CLASS_REFERENCE
-		|| rule->vr_obj_class == VR_CLASS_ATTACHMENT) {
-			if(found->obj_class != NOBJ_REFERENCE) {
+/*
+ * Check the child found by the rule, the count'th one of it.
+ */
+static int
+_vr_check_found(struct vr_config *vc, struct ncnf_obj_s *obj, struct vr_rule *rule, struct ncnf_obj_s *found, int count, struct vr_active *active) {
+	struct vr_type *ty;
+	char *value;
+
+	if(rule->vr_obj_class == VR_CLASS_REFERENCE
+	|| rule->vr_obj_class == VR_CLASS_ATTACHMENT) {
+		if(found->obj_class != NOBJ_REFERENCE) {
+			_ncnf_debug_print(1,
+				"Reference requested, "
+				"but object is not a reference "
+				"at line %d",
+				found->config_line
+			);
+			return -1;
+		}
+
+		if(rule->vr_obj_class == VR_CLASS_ATTACHMENT) {
+			if((found->m_ref_flags & 1) == 0) {
 				_ncnf_debug_print(1,
-					"Reference requested, "
-					"but object is not a reference "
+					"Attachment requested "
+					"but plain reference found "
 					"at line %d",
 					found->config_line
 				);
 				return -1;
 			}
-
-			if(rule->vr_obj_class == VR_CLASS_ATTACHMENT) {
-				if((found->m_ref_flags & 1) == 0) {
-					_ncnf_debug_print(1,
-						"Attachment requested "
-						"but plain reference found "
-						"at line %d",
-						found->config_line
-					);
-					return -1;
-				}
-			}
 		}
+	}
 
-		if(found->mark == 1) {
-			/* Already checked */
-			continue;
-		}
+	if(found->mark == 1) {
+		/* Already checked */
+		return 0;
+	}
 
-		if((rule->multiple == 0) && (count > 1)) {
-			_ncnf_debug_print(1, "Single %s %s required, multiple found at line %d",
-				__vr_obj_class2string(rule->vr_obj_class),
-				rule->name,
-				found->config_line
-			);
+	if((rule->multiple == 0) && (count > 1)) {
+		_ncnf_debug_print(1, "Single %s %s required, multiple found at line %d",
+			__vr_obj_class2string(rule->vr_obj_class),
+			rule->name,
+			found->config_line
+		);
+		return -1;
+	}
+
+	if(found->mark == 0)
+		found->mark = 1;
+
+	if(rule->type == NULL)
+		goto skip_type_checks;
+	ty = rule->type;
+
+	value = found->value;
+	if(value == NULL) value = "";
+
+	if(ty->range_defined) {
+		double val = atof(value);
+		if(val < ty->range_start
+		  || val > ty->range_end) {
+			_ncnf_debug_print(1, "Value \"%s\" at line %d does not fit in defined range (%.3f - %.3f)",
+				value,
+				found->config_line,
+				ty->range_start,
+				ty->range_end);
 			return -1;
 		}
+	}
 
-		if(found->mark == 0)
-			found->mark = 1;
-
-		if(rule->type == NULL)
-			goto skip_type_checks;
-		ty = rule->type;
-
-		value = found->value;
-		if(value == NULL) value = "";
-
-		if(ty->range_defined) {
-			double val = atof(value);
-			if(val < ty->range_start
-			  || val > ty->range_end) {
-				_ncnf_debug_print(1, "Value \"%s\" at line %d does not fit in defined range (%.3f - %.3f)",
-					value,
-					found->config_line,
-					ty->range_start,
-					ty->range_end);
-				return -1;
-			}
+	if(ty->regex) {
+		switch(_ncnf_re_match(ty->regex_compiled, value)) {
+		case -1:
+			_ncnf_debug_print(1, "Memory allocation failed");
+			errno = ENOMEM;
+			return -1;
+		case 0:
+			_ncnf_debug_print(1, "Value \"%s\" at line %d does not match regular expression \"%s\"",
+				value,
+				found->config_line,
+				ty->regex);
+			return -1;
 		}
-
-		if(ty->regex) {
-#ifdef	HAVE_LIBSTRFUNC
+		if(_ncnf_re_rewrites(ty->regex_compiled)) {
 			char *results;
-			results = sed_exec(ty->regex_compiled, value);
+			bstr_t b = NULL;
+
+			results = _ncnf_re_rewrite(ty->regex_compiled, value);
+			if(results && strcmp(value, results)) {
+				b = _ncnf_mr_str(found->mr, results, -1);
+				if(b == NULL) {
+					free(results);
+					results = NULL;
+				}
+			}
 			if(results == NULL) {
-				_ncnf_debug_print(1, "Value \"%s\" at line %d does not match regular expression \"%s\"",
-					value,
-					found->config_line,
-					ty->regex);
+				_ncnf_debug_print(1,
+				"Memory allocation failed");
+				errno = ENOMEM;
 				return -1;
 			}
-			if(ty->regex[0] == 's' || ty->regex[0] == 'y') {
-				found->mark = 2;
-				if(strcmp(value, results)) {
-					bstr_t b;
-					b = str2bstr(results, -1);
-					if(b == NULL) {
-						_ncnf_debug_print(1,
-						"Memory allocation failed");
-						return -1;
-					}
-					bstr_free(value);
-					found->value = b;
-				}
-			}
-#else	/* !HAVE_LIBSTRFUNC */
-			assert(!ty->regex);
-#endif	/* HAVE_LIBSTRFUNC */
+			free(results);
+
+			found->mark = 2;
+			if(b)
+				_ncnf_obj_set_value(found, b);
 		}
+	}
 
-		if(ty->ip_required) {
-			struct in_addr ip;
-			if(inet_aton(value, &ip) != 1) {
-				_ncnf_debug_print(1, "Value \"%s\" at line %d is not an IP address",
-					value,
-					found->config_line);
-				return -1;
-			}
+	if(ty->ip_required) {
+		struct in_addr ip;
+		if(inet_aton(value, &ip) != 1) {
+			_ncnf_debug_print(1, "Value \"%s\" at line %d is not an IP address",
+				value,
+				found->config_line);
+			return -1;
 		}
+	}
 
-		if(ty->ip_mask_required) {
+	if(ty->ip_mask_required) {
 #ifdef	HAVE_LIBSTRFUNC
-			unsigned int ip, mask;
-			if(strchr(value, ' ')
-				|| split_network(value, &ip, &mask)
-			) {
-				_ncnf_debug_print(1, "Value \"%s\" at line %d is not an IP address/Mask",
-					value,
-					found->config_line);
-				return -1;
-			}
+		unsigned int ip, mask;
+		if(strchr(value, ' ')
+			|| split_network(value, &ip, &mask)
+		) {
+			_ncnf_debug_print(1, "Value \"%s\" at line %d is not an IP address/Mask",
+				value,
+				found->config_line);
+			return -1;
+		}
 #else
-			assert(!ty->ip_mask_required);
+		assert(!ty->ip_mask_required);
 #endif	/* HAVE_LIBSTRFUNC */
-		}
+	}
 
-		if(ty->ip_masklen_required) {
+	if(ty->ip_masklen_required) {
 #ifdef	HAVE_LIBSTRFUNC
-			char *p;
-			unsigned int ip, mask;
-			if((p = strchr(value, ' '))
-				|| !(p = strchr(value, '/'))
-				|| strlen(p) > 3
-				|| split_network(value, &ip, &mask)
-			) {
-				_ncnf_debug_print(1, "Value \"%s\" at line %d is not an IP address/Masklen",
-					value,
-					found->config_line);
-				return -1;
-			}
+		char *p;
+		unsigned int ip, mask;
+		if((p = strchr(value, ' '))
+			|| !(p = strchr(value, '/'))
+			|| strlen(p) > 3
+			|| split_network(value, &ip, &mask)
+		) {
+			_ncnf_debug_print(1, "Value \"%s\" at line %d is not an IP address/Masklen",
+				value,
+				found->config_line);
+			return -1;
+		}
 #else
-			assert(!ty->ip_masklen_required);
+		assert(!ty->ip_masklen_required);
 #endif	/* HAVE_LIBSTRFUNC */
-		}
+	}
 
-		if(ty->ip_mask_required) {
-			char *p;
-			struct in_addr ip;
-
-			if( (p = strchr(value, ':')) == NULL
-				|| atoi(p+1) == 0
-				|| (*p = '\0' && 0) /* Mask ':' */
-				|| inet_aton(value, &ip) != 1
-			) {
-				if(p) *p = ':';	/* Unmask ':' */
-				_ncnf_debug_print(1, "Value \"%s\" at line %d is not an ip:port",
-					value,
-					found->config_line);
-				return -1;
-			}
+	if(ty->ip_mask_required) {
+		char *p;
+		struct in_addr ip;
+
+		if( (p = strchr(value, ':')) == NULL
+			|| atoi(p+1) == 0
+			|| (*p = '\0' && 0) /* Mask ':' */
+			|| inet_aton(value, &ip) != 1
+		) {
 			if(p) *p = ':';	/* Unmask ':' */
+			_ncnf_debug_print(1, "Value \"%s\" at line %d is not an ip:port",
+				value,
+				found->config_line);
+			return -1;
 		}
+		if(p) *p = ':';	/* Unmask ':' */
+	}
 
-	skip_type_checks:
+skip_type_checks:
 
-		if(rule->_entity_reference) {
-			char *e_type, *e_name;
-			struct vr_entity *e;
+	if(rule->_entity_reference) {
+		char *e_type, *e_name;
+		struct vr_entity *e;
 
+		if(strchr(found->value, ':') == NULL) {
+			/* No name, no need to split */
+			ncnf_atom_t atom = _ncnf_atom_find(found->value, 0);
+			e_type = found->value;
+			e = atom ? _vr_find_entity(vc, atom, NULL) : NULL;
+		} else {
 			e_type = alloca(strlen(found->value) + 1);
 			strcpy(e_type, found->value);
 			e_name = strchr(e_type, ':');
-			if(e_name)
-				*e_name++ = '\0';
-
-
-			e = _vr_get_entity(vc, e_type, e_name, 0);
-			if(e == NULL) {
-				_ncnf_debug_print(1,
-				"Reference to the unknown validation entity %s at line %d",
-					e_type,
-					found->config_line
-				);
-				return -1;
-			}
-
-			if(_vr_check_entity(vc, obj, e, 0)) {
-				return -1;
-			}
+			*e_name++ = '\0';
 
+			ncnf_atom_t atom = _ncnf_atom_find(e_type, 0);
+			e = atom ? _vr_find_entity(vc, atom, e_name) : NULL;
+		}
+		if(e == NULL) {
+			_ncnf_debug_print(1,
+			"Reference to the unknown validation entity %s at line %d",
+				e_type,
+				found->config_line
+			);
+			return -1;
 		}
 
+		if(_vr_check_entity(vc, obj, e, 0, active)) {
+			return -1;
+		}
 
 	}
 
-	if((rule->mandatory != 0) && (count == 0)) {
-		_ncnf_debug_print(1,
-			"Mandatory %s %s missing in entity `%s \"%s\"' at line %d",
-			__vr_obj_class2string(rule->vr_obj_class),
-			rule->name,
-			obj->type?obj->type:"ROOT",
-			obj->value?obj->value:"<unnamed>",
-			obj->config_line
-		);
-		return -1;
-	}
-
-
-
 	return 0;
 }
 
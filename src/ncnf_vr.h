@@ -87,9 +87,7 @@ struct vr_type {
 	int standalone;	/* Not in the hash */
 
 	char *regex;
-#ifdef	HAVE_LIBSTRFUNC
-	sed_t *regex_compiled;
-#endif	/* HAVE_LIBSTRFUNC */
+	struct ncnf_re *regex_compiled;	/* Shared, see ncnf_re.h */
 
 	int range_defined;
 	double range_start;
@@ -110,37 +108,108 @@ struct vr_rule {
 	enum vr_obj_class vr_obj_class;
 
 	char *name;	/* Destination object name */
+	ncnf_atom_t name_atom;	/* Its atom, or NULL for "*" */
 
 	int _entity_reference;
 
 	struct vr_type *type;
 
+	int index;	/* Position within the entity's ruleset */
 	struct vr_rule *next;
 };
 
+#define	_VR_ATOM_HASH(atom)	\
+	((unsigned int)((uintptr_t)(atom) >> 4) * 2654435761U)
+
+/*
+ * Compiled ruleset: the rules applicable to the child object
+ * are found by the child's type atom, so all the rules are checked
+ * in a single pass over the children.
+ */
+struct vr_dispatch {
+	struct vr_rule **rule;	/* Rules by their index */
+	int rules;
+	int references;		/* Number of entity reference rules */
+	struct vr_dispatch_slot {
+		ncnf_atom_t atom;	/* NULL for the free slot */
+		int *index;		/* Rules, ascending, -1 terminated */
+	} *slot[2];		/* Attributes and objects, open addressing */
+	unsigned int slots[2];	/* Power of two */
+	int *wildcard[2];	/* Rules for the types not in the table */
+};
+
 /*
  * Entity containing ruleset:
  */
 struct vr_entity {
 	char *type;
 	char *name;
-	int already_here;
 	struct vr_rule *rules;
+	struct vr_dispatch *dispatch;	/* See _vr_compile() */
 };
 
 /*
  * The whole configuration.
+ * Once compiled, it is only read by the validation, so it may be
+ * shared by several threads.
  */
 struct vr_config {
 	genhash_t *types;
 	genhash_t *entities;
+
+	/* Entities by their type atom, see _vr_find_entity() */
+	struct vr_entity_slot {
+		ncnf_atom_t atom;	/* NULL for the free slot */
+		struct vr_entity *unnamed;
+		struct vr_entity **named;	/* NULL-terminated, or NULL */
+	} *by_type;
+	unsigned int by_type_size;	/* Power of two */
+	struct vr_entity *root;		/* The "ROOT" entity */
+
+	int refs;	/* See ncnf_vr_get() */
+	unsigned int id;	/* Unique within the process, never 0 */
 };
 
 struct vr_config *ncnf_vr_read(const char *filename);
 int ncnf_validate(struct ncnf_obj_s *, struct vr_config *);
+/*
+ * Same as ncnf_validate(), but trust the subtrees which are the same as
+ * in the baseline configuration, validated before with the same rules
+ * (their objects are not marked). Only the objects added or changed
+ * since, and their parents, are checked. The fingerprints of the tree
+ * are computed as needed.
+ */
+int ncnf_validate_since(struct ncnf_obj_s *, struct vr_config *,
+	struct ncnf_obj_s *baseline);
+
+/*
+ * Get the rules from the process-wide cache, reading them if the file
+ * is not there yet or has changed since (judging by its inode, size,
+ * modification and change times).
+ * The returned rules are shared; the reference is released with
+ * ncnf_vr_destroy(), which destroys the rules along with the last one.
+ */
+struct vr_config *ncnf_vr_get(const char *filename);
 void ncnf_vr_destroy(struct vr_config *);
 
+/*
+ * Drop the cache references to the rules.
+ */
+void ncnf_vr_cache_flush(void);
+
 struct vr_entity *_vr_get_entity(struct vr_config *vc, char *name, char *type, int create);
+
+/*
+ * Build the dispatch tables once all the rules are read.
+ */
+int _vr_compile(struct vr_config *vc);
+
+/*
+ * Same as _vr_get_entity(vc, type, name, 0), for the compiled
+ * configuration and the interned type.
+ */
+struct vr_entity *_vr_find_entity(struct vr_config *vc,
+	ncnf_atom_t type_atom, char *name);
 struct vr_type *_vr_add_type(struct vr_config *vc, char *name,
 	char *type, char *value, int line);
 void _vr_destroy_type(void *vr);
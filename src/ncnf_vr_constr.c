@@ -28,9 +28,11 @@
 #include "headers.h"
 #include "ncnf_int.h"
 #include "ncnf_vr.h"
+#include "ncnf_re.h"
 
 static void _vr_entity_free(void *);
 static void _vr_rule_free(void *);
+static void _vr_dispatch_free(struct vr_dispatch *);
 
 static int _vr_entity_cmpf(const void *ap, const void *bp);
 static int _vr_entity_hashf(const void *ap);
@@ -82,6 +84,8 @@ _vr_entity_free(void *p) {
 		_vr_rule_free(rule);
 	}
 
+	_vr_dispatch_free(e->dispatch);
+
 	free(e);
 }
 
@@ -112,9 +116,7 @@ _vr_destroy_type(void *p) {
 			free(ty->regex);
 			ty->regex = NULL;
 		}
-#ifdef	HAVE_LIBSTRFUNC
-		sed_free(ty->regex_compiled);
-#endif	/* HAVE_LIBSTRFUNC */
+		_ncnf_re_free(ty->regex_compiled);
 		free(ty);
 	}
 }
@@ -207,13 +209,12 @@ _vr_new_type(struct vr_config *vc, char *name, char *type, char *value, int line
 			return ty;
 		}
 	} else if(strcmp(type, VR_STR_REGEX) == 0) {
-#ifdef	HAVE_LIBSTRFUNC
 		ty->regex = strdup(value);
 		if(ty->regex == NULL) {
 			_vr_destroy_type(ty);
 			return NULL;
 		}
-		ty->regex_compiled = sed_compile(value);
+		ty->regex_compiled = _ncnf_re_compile(value);
 		if(ty->regex_compiled == NULL) {
 			_ncnf_debug_print(1,
 			"Invalid regular expression \"%s\" at line %d",
@@ -222,11 +223,6 @@ _vr_new_type(struct vr_config *vc, char *name, char *type, char *value, int line
 			_vr_destroy_type(ty);
 			return NULL;
 		}
-#else	/* !HAVE_LIBSTRFUNC */
-		_ncnf_debug_print(1, "\"%s\" at line %d not supported: libstrfunc is not compiled in", type, line);
-		_vr_destroy_type(ty);
-		return NULL;
-#endif	/* HAVE_LIBSTRFUNC */
 	} else if(strcmp(type, VR_STR_RANGE) == 0) {
 		char *p = strchr(value, ':');
 		if(p == NULL) {
@@ -351,6 +347,12 @@ _vr_add_rule(int line, struct vr_config *vc, struct vr_entity *e,
 	if(r->name == NULL)
 		goto fail;
 
+	if(strcmp(r->name, "*")) {
+		r->name_atom = _ncnf_atom(r->name, -1);
+		if(r->name_atom == NULL)
+			goto fail;
+	}
+
 	if(strcmp(r->name, VR_STR_VALIDATOR_ENTITY) == 0)
 		r->_entity_reference = 1;
 
@@ -375,3 +377,210 @@ fail:
 
 	return -1;
 }
+
+/*
+ * Compiled rulesets.
+ */
+
+static void
+_vr_dispatch_free(struct vr_dispatch *d) {
+	unsigned int i;
+	int k;
+
+	if(d == NULL)
+		return;
+
+	for(k = 0; k < 2; k++) {
+		if(d->slot[k]) {
+			for(i = 0; i < d->slots[k]; i++)
+				free(d->slot[k][i].index);
+			free(d->slot[k]);
+		}
+		free(d->wildcard[k]);
+	}
+	free(d->rule);
+	free(d);
+}
+
+/*
+ * The rules of the given collection (0 for attributes, 1 for objects)
+ * applicable to the atom, wildcards included. NULL atom stands for
+ * the types not mentioned in the ruleset.
+ */
+static int *
+_vr_dispatch_list(struct vr_dispatch *d, int k, ncnf_atom_t atom) {
+	int *list;
+	int n = 0;
+	int i;
+
+	list = malloc((d->rules + 1) * sizeof(int));
+	if(list == NULL)
+		return NULL;
+
+	for(i = 0; i < d->rules; i++) {
+		struct vr_rule *r = d->rule[i];
+		if((r->vr_obj_class != VR_CLASS_ATTRIBUTE) != k)
+			continue;
+		if(r->name_atom == NULL || r->name_atom == atom)
+			list[n++] = i;
+	}
+	list[n] = -1;
+
+	return list;
+}
+
+static struct vr_dispatch *
+_vr_dispatch_new(struct vr_entity *e) {
+	struct vr_dispatch *d;
+	struct vr_rule *r;
+	int k;
+
+	d = calloc(1, sizeof(*d));
+	if(d == NULL)
+		return NULL;
+
+	for(r = e->rules; r; r = r->next)
+		d->rules++;
+
+	d->rule = malloc((d->rules + 1) * sizeof(d->rule[0]));
+	if(d->rule == NULL)
+		goto fail;
+
+	for(d->rules = 0, r = e->rules; r; r = r->next) {
+		r->index = d->rules;
+		d->rule[d->rules++] = r;
+		if(r->_entity_reference)
+			d->references++;
+	}
+
+	for(k = 0; k < 2; k++) {
+		unsigned int size;
+		int i;
+
+		d->wildcard[k] = _vr_dispatch_list(d, k, NULL);
+		if(d->wildcard[k] == NULL)
+			goto fail;
+
+		for(size = 4; size < 2 * (unsigned int)d->rules; size <<= 1);
+		d->slot[k] = calloc(size, sizeof(d->slot[k][0]));
+		if(d->slot[k] == NULL)
+			goto fail;
+		d->slots[k] = size;
+
+		for(i = 0; i < d->rules; i++) {
+			struct vr_dispatch_slot *slot;
+			unsigned int h;
+
+			r = d->rule[i];
+			if((r->vr_obj_class != VR_CLASS_ATTRIBUTE) != k
+			|| r->name_atom == NULL)
+				continue;
+
+			for(h = _VR_ATOM_HASH(r->name_atom);
+				(slot = &d->slot[k][h & (size - 1)])->atom
+				&& slot->atom != r->name_atom; h++);
+			if(slot->atom)
+				continue;	/* Several rules of a type */
+
+			slot->index = _vr_dispatch_list(d, k, r->name_atom);
+			if(slot->index == NULL)
+				goto fail;
+			slot->atom = r->name_atom;
+		}
+	}
+
+	return d;
+fail:
+	_vr_dispatch_free(d);
+	return NULL;
+}
+
+int
+_vr_compile(struct vr_config *vc) {
+	genhash_iter_t iter;
+	struct vr_entity *e;
+	unsigned int size;
+	int count;
+
+	if(vc->entities == NULL)
+		return 0;
+
+	count = genhash_count(vc->entities);
+	for(size = 4; size < 2 * (unsigned int)count; size <<= 1);
+	vc->by_type = calloc(size, sizeof(vc->by_type[0]));
+	if(vc->by_type == NULL)
+		return -1;
+	vc->by_type_size = size;
+
+	genhash_iter_init(&iter, vc->entities, 0);
+	while(genhash_iter(&iter, NULL, (void *)&e)) {
+		struct vr_entity_slot *slot;
+		ncnf_atom_t atom;
+		unsigned int h;
+
+		if(e->dispatch == NULL) {
+			e->dispatch = _vr_dispatch_new(e);
+			if(e->dispatch == NULL)
+				return -1;
+		}
+
+		atom = _ncnf_atom(e->type, -1);
+		if(atom == NULL)
+			return -1;
+
+		for(h = _VR_ATOM_HASH(atom);
+			(slot = &vc->by_type[h & (size - 1)])->atom
+			&& slot->atom != atom; h++);
+		slot->atom = atom;
+		if(e->name) {
+			struct vr_entity **named;
+			int n = 0;
+
+			while(slot->named && slot->named[n])
+				n++;
+			named = realloc(slot->named,
+				(n + 2) * sizeof(named[0]));
+			if(named == NULL)
+				return -1;
+			named[n] = e;
+			named[n + 1] = NULL;
+			slot->named = named;
+		} else {
+			slot->unnamed = e;
+		}
+	}
+
+	vc->root = _vr_get_entity(vc, "ROOT", NULL, 0);
+
+	return 0;
+}
+
+struct vr_entity *
+_vr_find_entity(struct vr_config *vc, ncnf_atom_t type_atom, char *name) {
+	struct vr_entity_slot *slot;
+	unsigned int h;
+
+	if(vc->by_type == NULL)
+		return NULL;
+
+	for(h = _VR_ATOM_HASH(type_atom);
+		(slot = &vc->by_type[h & (vc->by_type_size - 1)])->atom
+		!= type_atom; h++) {
+		if(slot->atom == NULL)
+			return NULL;	/* Unknown entity */
+	}
+
+	/*
+	 * Not using the entities hash: genhash_get() reorders it,
+	 * and the validation may run in several threads at once.
+	 */
+	if(slot->named && name) {
+		struct vr_entity **e;
+		for(e = slot->named; *e; e++) {
+			if(strcmp((*e)->name, name) == 0)
+				return *e;
+		}
+	}
+
+	return slot->unnamed;
+}
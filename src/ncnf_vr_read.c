@@ -29,36 +29,70 @@
 #include "ncnf_int.h"
 #include "ncnf_vr.h"
 
+#ifdef	HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif	/* HAVE_LIBPTHREAD */
+
 #define	BUFSIZE	4096
 
+static FILE *_vr_open(const char *filename, struct stat *sb);
+static struct vr_config *_vr_read(FILE *f, const char *filename);
+
 struct vr_config *
 ncnf_vr_read(const char *filename) {
-	struct stat sb;
 	struct vr_config *vc;
+	struct stat sb;
+	FILE *f;
+
+	f = _vr_open(filename, &sb);
+	if(f == NULL)
+		return NULL;
+
+	vc = _vr_read(f, filename);
+	fclose(f);
+
+	return vc;
+}
+
+static FILE *
+_vr_open(const char *filename, struct stat *sb) {
 	FILE *f;
-	char buf[VR_TOKENS_MAX][BUFSIZE];
-	char *p;
-	int line = 0;
-	struct vr_entity *default_entity = NULL;
 
 	if(filename == NULL) {
 		errno = EINVAL;
 		return NULL;
 	}
 
-	vc = (struct vr_config *)calloc(1, sizeof(struct vr_config));
-	if(vc == NULL)
-		return NULL;
-
 	f = fopen(filename, "r");
 	if(f == NULL)
-		goto fail;
+		return NULL;
 
-	if(fstat(fileno(f), &sb) != 0 || (sb.st_mode & S_IFMT) != S_IFREG) {
+	if(fstat(fileno(f), sb) != 0 || (sb->st_mode & S_IFMT) != S_IFREG) {
+		fclose(f);
 		errno = EIO;
-		goto fail;
+		return NULL;
 	}
 
+	return f;
+}
+
+static struct vr_config *
+_vr_read(FILE *f, const char *filename) {
+	static unsigned int last_id;
+	struct vr_config *vc;
+	char buf[VR_TOKENS_MAX][BUFSIZE];
+	char *p;
+	int line = 0;
+	struct vr_entity *default_entity = NULL;
+
+	vc = (struct vr_config *)calloc(1, sizeof(struct vr_config));
+	if(vc == NULL)
+		return NULL;
+	vc->refs = 1;
+	do {
+		vc->id = __atomic_add_fetch(&last_id, 1, __ATOMIC_RELAXED);
+	} while(vc->id == 0);
+
 	default_entity = _vr_get_entity(vc, "ROOT", NULL, 1);
 	if(default_entity == NULL) {
 		_ncnf_debug_print(1, "Entity allocation error");
@@ -165,12 +199,197 @@ ncnf_vr_read(const char *filename) {
 
 	}
 
-	fclose(f);
+	/* Index the rules for the validation */
+	if(_vr_compile(vc)) {
+		_ncnf_debug_print(1, "Memory allocation error");
+		goto fail;
+	}
 
 	return vc;
 fail:
-	if(f)
-		fclose(f);
 	ncnf_vr_destroy(vc);
 	return NULL;
 }
+
+/*
+ * The process-wide cache of the rules, see ncnf_vr_get().
+ */
+struct vr_cache_entry {
+	char *filename;
+	dev_t dev;
+	ino_t ino;
+	off_t size;
+	struct timespec mtime;
+	struct timespec ctime;
+	struct vr_config *vc;
+	struct vr_cache_entry *next;
+};
+
+static struct vr_cache_entry *vr_cache;
+#ifdef	HAVE_LIBPTHREAD
+static pthread_mutex_t vr_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif	/* HAVE_LIBPTHREAD */
+
+static void
+_vr_cache_lock(void) {
+#ifdef	HAVE_LIBPTHREAD
+	pthread_mutex_lock(&vr_cache_lock);
+#endif	/* HAVE_LIBPTHREAD */
+}
+
+static void
+_vr_cache_unlock(void) {
+#ifdef	HAVE_LIBPTHREAD
+	pthread_mutex_unlock(&vr_cache_lock);
+#endif	/* HAVE_LIBPTHREAD */
+}
+
+static int
+_vr_timespec_eq(const struct timespec *a, const struct timespec *b) {
+	return a->tv_sec == b->tv_sec && a->tv_nsec == b->tv_nsec;
+}
+
+/*
+ * The modification and change times, as precise as the system tells.
+ */
+static void
+_vr_stat_times(const struct stat *sb,
+		struct timespec *mtime, struct timespec *ctime) {
+#if	defined(HAVE_STRUCT_STAT_ST_MTIM)
+	*mtime = sb->st_mtim;
+	*ctime = sb->st_ctim;
+#elif	defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+	*mtime = sb->st_mtimespec;
+	*ctime = sb->st_ctimespec;
+#else
+	mtime->tv_sec = sb->st_mtime;
+	mtime->tv_nsec = 0;
+	ctime->tv_sec = sb->st_ctime;
+	ctime->tv_nsec = 0;
+#endif
+}
+
+static void
+_vr_cache_entry_free(struct vr_cache_entry *ce) {
+	ncnf_vr_destroy(ce->vc);
+	free(ce->filename);
+	free(ce);
+}
+
+/*
+ * Find the rules read from the file in its current state, with the
+ * reference acquired. The outdated entries of the file are unlinked
+ * and returned through stale. Must be called with the lock held.
+ */
+static struct vr_config *
+_vr_cache_find(const char *filename, struct stat *sb,
+		struct vr_cache_entry **stale) {
+	struct vr_cache_entry **cep;
+	struct vr_cache_entry *ce;
+	struct timespec mtime;
+	struct timespec ctime;
+
+	_vr_stat_times(sb, &mtime, &ctime);
+
+	for(cep = &vr_cache; (ce = *cep);) {
+		if(strcmp(ce->filename, filename)) {
+			cep = &ce->next;
+			continue;
+		}
+
+		if(ce->dev == sb->st_dev
+		&& ce->ino == sb->st_ino
+		&& ce->size == sb->st_size
+		&& _vr_timespec_eq(&ce->mtime, &mtime)
+		&& _vr_timespec_eq(&ce->ctime, &ctime)) {
+			__atomic_add_fetch(&ce->vc->refs, 1, __ATOMIC_RELAXED);
+			return ce->vc;
+		}
+
+		/* The file has changed since */
+		*cep = ce->next;
+		ce->next = *stale;
+		*stale = ce;
+	}
+
+	return NULL;
+}
+
+struct vr_config *
+ncnf_vr_get(const char *filename) {
+	struct vr_cache_entry *stale = NULL;
+	struct vr_cache_entry *ce;
+	struct vr_config *vc;
+	struct stat sb;
+	FILE *f;
+
+	f = _vr_open(filename, &sb);
+	if(f == NULL)
+		return NULL;
+
+	_vr_cache_lock();
+	vc = _vr_cache_find(filename, &sb, &stale);
+	_vr_cache_unlock();
+
+	if(vc == NULL) {
+		/* Parse outside the lock; the others may do the same */
+		vc = _vr_read(f, filename);
+		ce = vc ? calloc(1, sizeof(*ce)) : NULL;
+		if(ce) ce->filename = strdup(filename);
+		if(ce && ce->filename) {
+			struct vr_config *cached;
+
+			ce->dev = sb.st_dev;
+			ce->ino = sb.st_ino;
+			ce->size = sb.st_size;
+			_vr_stat_times(&sb, &ce->mtime, &ce->ctime);
+			ce->vc = vc;
+			vc->refs++;	/* The cache reference */
+
+			_vr_cache_lock();
+			cached = _vr_cache_find(filename, &sb, &stale);
+			if(cached == NULL) {
+				ce->next = vr_cache;
+				vr_cache = ce;
+				ce = NULL;
+			}
+			_vr_cache_unlock();
+
+			if(cached) {
+				/* Another thread was faster */
+				_vr_cache_entry_free(ce);
+				ncnf_vr_destroy(vc);
+				vc = cached;
+			}
+		} else if(ce) {
+			free(ce);
+		}
+		/* Without memory for the entry, just do not cache */
+	}
+
+	fclose(f);
+
+	/* Release the outdated rules outside the lock */
+	while((ce = stale)) {
+		stale = ce->next;
+		_vr_cache_entry_free(ce);
+	}
+
+	return vc;
+}
+
+void
+ncnf_vr_cache_flush() {
+	struct vr_cache_entry *ce;
+
+	_vr_cache_lock();
+	ce = vr_cache;
+	vr_cache = NULL;
+	_vr_cache_unlock();
+
+	while(ce) {
+		struct vr_cache_entry *next = ce->next;
+		_vr_cache_entry_free(ce);
+		ce = next;
+	}
+}
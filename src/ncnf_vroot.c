@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2001, 2002, 2003, 2004, 2005  Netli, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * $Id$
+ */
+/*
+ * Versioned configuration root.
+ */
+#include "headers.h"
+#include "ncnf_int.h"
+#include "ncnf_vroot.h"
+
+/*
+ * Reader slots are kept on separate cache lines,
+ * so the readers do not disturb each other.
+ */
+union vroot_slot {
+	struct {
+		unsigned long epoch;	/* Pinned at this epoch, or 0 */
+		int in_use;
+	} s;
+	char pad[64];
+};
+
+/* Replaced version */
+struct vroot_retired {
+	struct vroot_retired *next;
+	struct ncnf_obj_s *root;
+	unsigned long epoch;	/* Readers pinned at it never saw the root */
+};
+
+struct ncnf_vroot {
+	struct ncnf_obj_s *root;	/* Current version */
+	unsigned long epoch;		/* Current epoch, starts at 1 */
+	struct vroot_retired *retired;	/* Accessed by the publisher only */
+	int max_readers;
+	union vroot_slot *reader;
+};
+
+struct ncnf_vroot *
+_ncnf_vroot_new(int max_readers) {
+	struct ncnf_vroot *vr;
+
+	if(max_readers <= 0) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	vr = calloc(1, sizeof(*vr));
+	if(vr == NULL)
+		return NULL;
+
+	vr->reader = calloc(max_readers, sizeof(vr->reader[0]));
+	if(vr->reader == NULL) {
+		free(vr);
+		return NULL;
+	}
+
+	vr->epoch = 1;
+	vr->max_readers = max_readers;
+
+	return vr;
+}
+
+static int
+__ncnf_vroot_prepare(struct ncnf_obj_s *obj, void *key) {
+	enum collections_e c;
+
+	(void)key;
+
+	/* The chain lookups link the found objects through it */
+	if(_ncnf_obj_cold(obj) == NULL)
+		return -1;
+
+	if(!_NOBJ_CONTAINER(obj))
+		return 0;
+
+	for(c = 0; c < MAX_COLLECTIONS; c++) {
+		if(_ncnf_coll_prepare(obj->mr, &obj->m_collection[c]))
+			return -1;
+	}
+
+	return 0;
+}
+
+int
+_ncnf_vroot_prepare(struct ncnf_obj_s *root) {
+	/*
+	 * Fill in everything the readers could otherwise
+	 * compute and cache on demand.
+	 */
+	_ncnf_fingerprint(root);
+	if(_ncnf_walk_tree(root, __ncnf_vroot_prepare, NULL)) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	return 0;
+}
+
+int
+_ncnf_vroot_publish(struct ncnf_vroot *vr, struct ncnf_obj_s *root,
+		struct ncnf_changeset **changes) {
+	struct vroot_retired *rt = NULL;
+	struct ncnf_obj_s *old;
+
+	if(_ncnf_vroot_prepare(root))
+		return -1;
+
+	/* Neither tree is modified, the readers may go on */
+	old = vr->root;
+	if(changes && _ncnf_diff_compare(old, root, changes))
+		return -1;
+
+	if(old) {
+		rt = malloc(sizeof(*rt));
+		if(rt == NULL) {
+			if(changes) {
+				_ncnf_changeset_free(*changes);
+				*changes = NULL;
+			}
+			return -1;
+		}
+	}
+
+	/*
+	 * The readers which have seen the new epoch
+	 * will see the new root as well.
+	 */
+	__atomic_store_n(&vr->root, root, __ATOMIC_SEQ_CST);
+
+	if(rt) {
+		rt->root = old;
+		rt->epoch = __atomic_add_fetch(&vr->epoch, 1,
+			__ATOMIC_SEQ_CST);
+		rt->next = vr->retired;
+		vr->retired = rt;
+		_ncnf_vroot_reclaim(vr);
+	}
+
+	return 0;
+}
+
+int
+_ncnf_vroot_reader(struct ncnf_vroot *vr) {
+	int i;
+
+	for(i = 0; i < vr->max_readers; i++) {
+		int free_slot = 0;
+		if(__atomic_compare_exchange_n(&vr->reader[i].s.in_use,
+				&free_slot, 1, 0,
+				__ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+			return i;
+	}
+
+	errno = ENOSPC;
+	return -1;
+}
+
+void
+_ncnf_vroot_reader_done(struct ncnf_vroot *vr, int reader) {
+	union vroot_slot *slot = &vr->reader[reader];
+
+	__atomic_store_n(&slot->s.epoch, 0, __ATOMIC_RELEASE);
+	__atomic_store_n(&slot->s.in_use, 0, __ATOMIC_RELEASE);
+}
+
+struct ncnf_obj_s *
+_ncnf_vroot_pin(struct ncnf_vroot *vr, int reader) {
+	union vroot_slot *slot = &vr->reader[reader];
+	unsigned long epoch;
+
+	epoch = __atomic_load_n(&vr->epoch, __ATOMIC_ACQUIRE);
+
+	/*
+	 * The publisher either sees our epoch before it reclaims,
+	 * or has replaced the root before we load it.
+	 */
+	__atomic_store_n(&slot->s.epoch, epoch, __ATOMIC_SEQ_CST);
+
+	return __atomic_load_n(&vr->root, __ATOMIC_SEQ_CST);
+}
+
+void
+_ncnf_vroot_unpin(struct ncnf_vroot *vr, int reader) {
+	__atomic_store_n(&vr->reader[reader].s.epoch, 0, __ATOMIC_RELEASE);
+}
+
+int
+_ncnf_vroot_reclaim(struct ncnf_vroot *vr) {
+	struct vroot_retired **rtp;
+	struct vroot_retired *rt;
+	unsigned long oldest = (unsigned long)-1;
+	int held = 0;
+	int i;
+
+	if(vr->retired == NULL)
+		return 0;
+
+	/* The oldest epoch still pinned */
+	for(i = 0; i < vr->max_readers; i++) {
+		unsigned long epoch = __atomic_load_n(
+			&vr->reader[i].s.epoch, __ATOMIC_SEQ_CST);
+		if(epoch && epoch < oldest)
+			oldest = epoch;
+	}
+
+	for(rtp = &vr->retired; (rt = *rtp);) {
+		if(rt->epoch <= oldest) {
+			*rtp = rt->next;
+			ncnf_destroy(rt->root);
+			free(rt);
+		} else {
+			rtp = &rt->next;
+			held++;
+		}
+	}
+
+	return held;
+}
+
+void
+_ncnf_vroot_destroy(struct ncnf_vroot *vr) {
+	struct vroot_retired *rt;
+
+	if(vr == NULL)
+		return;
+
+	while((rt = vr->retired)) {
+		vr->retired = rt->next;
+		ncnf_destroy(rt->root);
+		free(rt);
+	}
+
+	if(vr->root)
+		ncnf_destroy(vr->root);
+
+	free(vr->reader);
+	free(vr);
+}
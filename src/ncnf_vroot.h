@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2001, 2002, 2003, 2004, 2005  Netli, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * $Id$
+ */
+/*
+ * Versioned configuration root.
+ *
+ * The application publishes a new tree by swapping the root pointer,
+ * and the reader threads pin the current version without any locking.
+ * Reclamation is epoch based: every reader has its own slot, holding
+ * the epoch the version was pinned at. The publisher advances the epoch
+ * at every publication, and destroys the replaced version once no slot
+ * holds an epoch older than the one it was replaced at.
+ */
+#ifndef	__NCNF_VROOT_H__
+#define	__NCNF_VROOT_H__
+
+struct ncnf_vroot *_ncnf_vroot_new(int max_readers);
+
+/*
+ * Make the tree ready to be read by several threads at once:
+ * compute everything the lookups would otherwise cache in the tree,
+ * and allocate the cold parts the chain lookups write to.
+ * Returns -1 if memory is exhausted.
+ */
+int _ncnf_vroot_prepare(struct ncnf_obj_s *root);
+
+/*
+ * Make the tree ready to be read by several threads at once,
+ * and replace the current version with it.
+ * If changes is not NULL, the differences are described there.
+ * Returns -1 if memory is exhausted, the tree is left with the caller.
+ */
+int _ncnf_vroot_publish(struct ncnf_vroot *, struct ncnf_obj_s *root,
+	struct ncnf_changeset **changes);
+
+/*
+ * Take and release the reader slot.
+ */
+int _ncnf_vroot_reader(struct ncnf_vroot *);
+void _ncnf_vroot_reader_done(struct ncnf_vroot *, int reader);
+
+/*
+ * Pin the current version, and release it.
+ */
+struct ncnf_obj_s *_ncnf_vroot_pin(struct ncnf_vroot *, int reader);
+void _ncnf_vroot_unpin(struct ncnf_vroot *, int reader);
+
+/*
+ * Destroy the replaced versions nobody holds anymore.
+ * Returns the number of versions still held.
+ */
+int _ncnf_vroot_reclaim(struct ncnf_vroot *);
+
+/*
+ * Destroy the current and all the replaced versions.
+ */
+void _ncnf_vroot_destroy(struct ncnf_vroot *);
+
+#endif	/* __NCNF_VROOT_H__ */
@@ -64,6 +64,8 @@ retry:
 
 	/* _ncnf_coll_get() flags */
 	cget_flags = (flags & _NGF_IGNORE_REFS) ? CG_IGNORE_REFERENCES : 0;
+	if(flags & _NGF_TYPE_ATOM)
+		cget_flags |= CG_TYPE_ATOM;
 
 	/*
 	 * Initialize iterator, if necessary.
@@ -111,7 +113,7 @@ retry:
 	}
 
 	/* Search in straight descendents */
-	found = _ncnf_coll_get(coll, cget_flags,
+	found = _ncnf_coll_get(obj->mr, coll, cget_flags,
 		opt_type, opt_name, iterator);
 	if(found)
 		return found;
@@ -203,8 +205,8 @@ void
 _ncnf_iter_rewind(struct ncnf_obj_s *iter) {
 	if(iter->obj_class == NOBJ_ITERATOR) {
 		iter->m_iterator_position = 0;
-	} else {
-		iter->chain_cur = NULL;
+	} else if(iter->cold) {
+		iter->cold->chain_cur = NULL;
 	}
 }
 
@@ -237,10 +239,17 @@ _ncnf_iter_next(struct ncnf_obj_s *iter) {
 		 * forward and the previous value is returned.
 		 */
 
-		if(iter->chain_cur != nothing_is_here) {
+		struct ncnf_obj_cold_s *cold = _ncnf_obj_cold(iter);
+
+		if(cold == NULL) {
+			errno = ENOMEM;
+			return NULL;
+		}
+
+		if(cold->chain_cur != nothing_is_here) {
 
-			if(iter->chain_cur) {
-				obj = iter->chain_cur;
+			if(cold->chain_cur) {
+				obj = cold->chain_cur;
 			} else {
 				/* Rewind to the start of the chain */
 				obj = iter;
@@ -249,10 +258,10 @@ _ncnf_iter_next(struct ncnf_obj_s *iter) {
 			/*
 			 * Shift the pointer.
 			 */
-			iter->chain_cur = obj->chain_next;
-			if(iter->chain_cur == NULL
-			  || iter->chain_cur == obj) {
-				iter->chain_cur = nothing_is_here;
+			cold->chain_cur = _NOBJ_COLD(obj, chain_next, NULL);
+			if(cold->chain_cur == NULL
+			  || cold->chain_cur == obj) {
+				cold->chain_cur = nothing_is_here;
 			}
 
 		} else {
@@ -39,6 +39,7 @@ enum _ncnf_get_flags {
   _NGF_NOFLAGS		= 0,
   _NGF_RECURSIVE	= 1,
   _NGF_IGNORE_REFS	= 2,
+  _NGF_TYPE_ATOM	= 4,	/* opt_type is an ncnf_atom_t */
 };
 
 struct ncnf_obj_s *_ncnf_get_obj(struct ncnf_obj_s *obj,